@@ -0,0 +1,109 @@
+/*
+MIT License
+Copyright (c) 2025 Vit Janecek (mailto:janecekvit@outlook.com)
+
+benchmark_false_sharing.cpp
+Purpose:	measures the false sharing of signals and resource owners stored next to each other in one array,
+			every thread works only with its own element, so the whole slowdown comes from the shared cache lines
+
+
+@author: Vit Janecek
+@mailto: <mailto:janecekvit@outlook.com>
+@version 1.00 16/10/2026
+*/
+
+#include "synchronization/concurrent.h"
+#include "synchronization/signal.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace janecekvit;
+using namespace janecekvit::synchronization;
+
+namespace
+{
+constexpr size_t iterations = 1'000'000;
+
+/// <summary>
+/// Runs the body with the index of its element on every thread and returns the elapsed time of the slowest thread.
+/// </summary>
+template <class _Body>
+std::chrono::milliseconds run_threads(size_t threads, _Body&& body)
+{
+	std::vector<std::thread> workers;
+	const auto start = std::chrono::steady_clock::now();
+	for (size_t index = 0; index < threads; index++)
+		workers.emplace_back(body, index);
+
+	for (auto& worker : workers)
+		worker.join();
+
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+}
+
+template <class _Signal>
+std::chrono::milliseconds benchmark_signals(size_t threads)
+{
+	// Array of signals, not a vector of pointers, so neighbouring elements share cache lines in the default layout
+	auto signals = std::make_unique<_Signal[]>(threads);
+	return run_threads(threads, [&signals](size_t index)
+		{
+			auto& signal = signals[index];
+			for (size_t i = 0; i < iterations; i++)
+			{
+				signal.signalize();
+				signal.wait();
+			}
+		});
+}
+
+template <class _Owner>
+std::chrono::milliseconds benchmark_owners(size_t threads)
+{
+	std::vector<_Owner> owners(threads);
+	return run_threads(threads, [&owners](size_t index)
+		{
+			auto& owner = owners[index];
+			for (size_t i = 0; i < iterations; i++)
+				owner.exclusive().get()++;
+		});
+}
+
+void report(std::string_view name, std::chrono::milliseconds separate, std::chrono::milliseconds aligned)
+{
+	std::cout << std::left << std::setw(40) << name
+			  << std::right << std::setw(10) << separate.count() << " ms"
+			  << std::setw(10) << aligned.count() << " ms"
+			  << std::setw(10) << std::fixed << std::setprecision(2)
+			  << static_cast<double>(separate.count()) / static_cast<double>(std::max<std::chrono::milliseconds::rep>(aligned.count(), 1)) << "x\n";
+}
+} // namespace
+
+int main()
+{
+	const size_t threads = std::clamp<size_t>(std::thread::hardware_concurrency(), 2, 16);
+	std::cout << "threads: " << threads << ", iterations per thread: " << iterations << ", cache line: " << cache_line_size << " B\n";
+	std::cout << std::left << std::setw(40) << "" << std::right << std::setw(13) << "default" << std::setw(13) << "aligned" << std::setw(11) << "speedup" << "\n";
+
+	report("signal<binary_semaphore>",
+		benchmark_signals<synchronization::signal<>>(threads),
+		benchmark_signals<cache_aligned_signal<>>(threads));
+
+	report("signal<atomic<uint64_t>>",
+		benchmark_signals<synchronization::signal<std::atomic<uint64_t>>>(threads),
+		benchmark_signals<cache_aligned_signal<std::atomic<uint64_t>>>(threads));
+
+	report("resource_owner<size_t>",
+		benchmark_owners<concurrent::resource_owner_release<size_t>>(threads),
+		benchmark_owners<concurrent::cache_aligned_resource_owner<size_t, lock_tracking_disabled>>(threads));
+
+	return 0;
+}
@@ -0,0 +1,131 @@
+/*
+MIT License
+Copyright (c) 2025 Vit Janecek (mailto:janecekvit@outlook.com)
+
+benchmark_owner_access.cpp
+Purpose:	measures the cost of one access through the release resource owner in all layouts against the bare std::shared_mutex,
+			the access should be only the lock, the call and the unlock,
+			the tracked row shows the overhead of the runtime lock tracking
+
+
+@author: Vit Janecek
+@mailto: <mailto:janecekvit@outlook.com>
+@version 1.00 16/10/2026
+*/
+
+#include "benchmark_sink.h"
+#include "synchronization/concurrent.h"
+
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <shared_mutex>
+
+using namespace janecekvit::synchronization;
+
+namespace
+{
+constexpr size_t iterations = 20'000'000;
+
+struct counter
+{
+	void add() noexcept
+	{
+		value++;
+	}
+
+	[[nodiscard]] size_t get() const noexcept
+	{
+		return value;
+	}
+
+	size_t value = 0;
+};
+
+/// <summary>
+/// Reference access, the shared mutex locked directly.
+/// </summary>
+struct bare_mutex
+{
+	void add()
+	{
+		std::unique_lock lock(mutex);
+		resource.add();
+	}
+
+	[[nodiscard]] size_t get() const
+	{
+		std::shared_lock lock(mutex);
+		return resource.get();
+	}
+
+	mutable std::shared_mutex mutex;
+	counter resource;
+};
+
+/// <summary>
+/// Accessors are not inlined, so their code can be compared with bare_mutex by the disassembler, e.g. objdump -d --no-show-raw-insn | c++filt.
+/// </summary>
+template <class _Owner>
+[[gnu::noinline]] void exclusive_access(_Owner& owner)
+{
+	if constexpr (std::is_same_v<_Owner, bare_mutex>)
+		owner.add();
+	else
+		owner.exclusive()->add();
+}
+
+template <class _Owner>
+[[gnu::noinline]] size_t concurrent_access(const _Owner& owner)
+{
+	if constexpr (std::is_same_v<_Owner, bare_mutex>)
+		return owner.get();
+	else
+		return owner.concurrent()->get();
+}
+
+/// <summary>
+/// Returns nanoseconds per one exclusive and one concurrent access.
+/// </summary>
+template <class _Owner>
+double benchmark()
+{
+	_Owner owner;
+	size_t sum = 0;
+
+	const auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < iterations; i++)
+	{
+		exclusive_access(owner);
+		sum += concurrent_access(owner);
+	}
+
+	const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	benchmarks::do_not_optimize(sum);
+	return elapsed / static_cast<double>(iterations);
+}
+} // namespace
+
+int main()
+{
+	using separate_owner = concurrent::resource_owner_release<counter>;
+	using cache_aligned_owner = concurrent::cache_aligned_resource_owner<counter, lock_tracking_disabled>;
+	using inline_owner = concurrent::inline_resource_owner<counter, lock_tracking_disabled>;
+	using tracked_owner = concurrent::resource_owner_runtime<counter>;
+
+	std::cout << "iterations: " << iterations << ", one exclusive and one concurrent access per iteration\n";
+	std::cout << std::setw(16) << "bare mutex" << std::setw(16) << "separate" << std::setw(16) << "cache aligned" << std::setw(16) << "inline" << std::setw(16) << "tracked" << " [ns/iteration]\n";
+	std::cout << std::fixed << std::setprecision(2)
+			  << std::setw(16) << benchmark<bare_mutex>()
+			  << std::setw(16) << benchmark<separate_owner>()
+			  << std::setw(16) << benchmark<cache_aligned_owner>()
+			  << std::setw(16) << benchmark<inline_owner>();
+
+	lock_tracking_runtime::enable_tracking();
+	std::cout << std::setw(16) << benchmark<tracked_owner>() << "\n";
+	lock_tracking_runtime::disable_tracking();
+
+	return 0;
+}
@@ -0,0 +1,89 @@
+/*
+MIT License
+Copyright (c) 2025 Vit Janecek (mailto:janecekvit@outlook.com)
+
+benchmark_read_mostly.cpp
+Purpose:	measures the read throughput of the resource owner locked by std::shared_mutex and by distributed_shared_mutex,
+			threads read one shared map and write to it only once in a while
+
+
+@author: Vit Janecek
+@mailto: <mailto:janecekvit@outlook.com>
+@version 1.00 16/10/2026
+*/
+
+#include "benchmark_sink.h"
+#include "synchronization/concurrent.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace janecekvit::synchronization;
+
+namespace
+{
+constexpr size_t iterations = 1'000'000;
+constexpr size_t write_period = 10'000;
+
+/// <summary>
+/// Returns the millions of operations per second performed by all threads together.
+/// </summary>
+template <class _Owner>
+double benchmark(size_t threads)
+{
+	_Owner owner;
+	for (int key = 0; key < 1024; key++)
+		owner.exclusive()->emplace(key, key);
+
+	std::vector<std::thread> workers;
+	const auto start = std::chrono::steady_clock::now();
+	for (size_t index = 0; index < threads; index++)
+	{
+		workers.emplace_back([&owner, index]()
+			{
+				size_t sum = 0;
+				for (size_t i = 0; i < iterations; i++)
+				{
+					const auto key = static_cast<int>((i + index) & 1023);
+					if (i % write_period == 0)
+						owner.exclusive()->at(key)++;
+					else
+						sum += static_cast<size_t>(owner.concurrent()->at(key));
+				}
+
+				benchmarks::do_not_optimize(sum);
+			});
+	}
+
+	for (auto& worker : workers)
+		worker.join();
+
+	const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return static_cast<double>(threads * iterations) / elapsed / 1e6;
+}
+} // namespace
+
+int main()
+{
+	using shared_mutex_owner = concurrent::resource_owner_release<std::unordered_map<int, int>>;
+	using distributed_owner = concurrent::read_mostly_resource_owner<std::unordered_map<int, int>, lock_tracking_disabled>;
+
+	const size_t max_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+	std::cout << "iterations per thread: " << iterations << ", one write per " << write_period << " reads\n";
+	std::cout << std::setw(8) << "threads" << std::setw(20) << "shared_mutex" << std::setw(20) << "distributed" << " [Mops/s]\n";
+
+	for (size_t threads = 1; threads <= max_threads; threads *= 2)
+	{
+		std::cout << std::setw(8) << threads
+				  << std::setw(20) << std::fixed << std::setprecision(2) << benchmark<shared_mutex_owner>(threads)
+				  << std::setw(20) << benchmark<distributed_owner>(threads) << "\n";
+	}
+
+	return 0;
+}
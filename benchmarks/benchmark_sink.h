@@ -0,0 +1,30 @@
+/*
+MIT License
+Copyright (c) 2025 Vit Janecek (mailto:janecekvit@outlook.com)
+
+benchmark_sink.h
+Purpose:	header file contains the sink of the benchmark results which keeps the measured work from being optimized out
+
+
+@author: Vit Janecek
+@mailto: <mailto:janecekvit@outlook.com>
+@version 1.00 16/10/2026
+*/
+
+#pragma once
+
+#include <type_traits>
+
+namespace benchmarks
+{
+/// <summary>
+/// Stores the value to a thread local volatile object, the compiler has to compute it, but the store costs no I/O or synchronization.
+/// </summary>
+template <class _Type>
+	requires std::is_trivially_copyable_v<_Type>
+void do_not_optimize(const _Type& value) noexcept
+{
+	[[maybe_unused]] static thread_local volatile _Type sink;
+	sink = value;
+}
+} // namespace benchmarks
@@ -29,6 +29,7 @@ Purpose:	header for compiler support
 */
 
 #include <memory>
+#include <version>
 
 // Check for std::jthread support
 #if defined(__cpp_lib_jthread) && __cpp_lib_jthread >= 201911L && defined(__has_include) && __has_include(<stop_token>)
@@ -42,3 +43,8 @@ Purpose:	header for compiler support
 #include <format>
 #define HAS_STD_FORMAT
 #endif
+
+// Check for thread affinity support (pthread_setaffinity_np is a GNU extension available on Linux)
+#if defined(__linux__) && defined(__has_include) && __has_include(<pthread.h>) && __has_include(<sched.h>)
+#define HAS_PTHREAD_AFFINITY
+#endif
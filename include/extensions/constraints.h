@@ -13,8 +13,10 @@ Purpose:	header file contains set of extended constraints to describe stl contai
 #pragma once
 #include <algorithm>
 #include <any>
+#include <atomic>
 #include <concepts>
 #include <condition_variable>
+#include <cstdint>
 #include <functional>
 #include <list>
 #include <memory>
@@ -356,6 +358,9 @@ concept semaphore_type = std::is_same_v<std::binary_semaphore, _Semaphore> || st
 template <class _Semaphore>
 concept binary_semaphore_type = std::is_same_v<std::binary_semaphore, _Semaphore>;
 
+template <class _Atomic>
+concept atomic_wait_type = std::is_same_v<std::atomic<uint64_t>, _Atomic>;
+
 template <typename _Type>
 concept pointer_type = is_any_pointer_v<_Type> ||
 					   requires(_Type t) {
@@ -368,7 +373,17 @@ template <typename _Type>
 concept smart_pointer_type = is_weak_ptr_v<_Type> || is_shared_ptr_v<_Type> || is_unique_ptr_v<_Type>;
 
 template <typename _Type>
-concept is_shared_mutex_type = std::is_same_v<std::shared_mutex, _Type> || std::is_same_v<std::shared_timed_mutex, _Type>;
+concept shared_lockable_type = requires(_Type& mutex) {
+	mutex.lock();
+	mutex.unlock();
+	{ mutex.try_lock() } -> std::convertible_to<bool>;
+	mutex.lock_shared();
+	mutex.unlock_shared();
+	{ mutex.try_lock_shared() } -> std::convertible_to<bool>;
+};
+
+template <typename _Type>
+concept is_shared_mutex_type = std::is_same_v<std::shared_mutex, _Type> || std::is_same_v<std::shared_timed_mutex, _Type> || shared_lockable_type<_Type>;
 
 template <typename _Type>
 concept is_mutex_type = std::is_same_v<std::mutex, _Type> || std::is_same_v<std::timed_mutex, _Type>;
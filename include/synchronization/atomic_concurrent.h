@@ -2,209 +2,201 @@
 MIT License
 Copyright (c) 2021 Vit Janecek (mailto:janecekvit@outlook.com)
 
-concurrent.h
-Purpose:	header file contains set of atomic thread-safe concurrent containers,
-			also methods that implemented over basic stl containers and
-			thread-safe methods for every possible concurrent object
+atomic_concurrent.h
+Purpose:	header file contains set of read-copy-update concurrent containers,
+			readers access immutable snapshots and never wait for writers,
+			writers modify a private copy which is published atomically
 
 
 @author: Vit Janecek
 @mailto: <mailto:janecekvit@outlook.com>
-@version 0.81 31/12/2021
-TODO: 1. std::aligned_storage (aligned_storage_t) for writer deep copy
-TODO: 2. Make atomic_concurrent based on two classes (exclusive writer, more writers with std::merge class)
+@version 1.00 16/10/2026
 */
 
 #pragma once
 #include "extensions/constraints.h"
+#include "synchronization/reclamation.h"
 
 #include <array>
-#include <cerrno>
+#include <atomic>
 #include <exception>
+#include <functional>
 #include <list>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <queue>
 #include <set>
-#include <shared_mutex>
 #include <source_location>
 #include <stack>
-#include <system_error>
+#include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
-#if defined(__experimental)
-
-namespace janecekvit::experimental::synchronization::atomic_concurrent
+namespace janecekvit::synchronization::atomic_concurrent
 {
 template <class _Type>
 class resource_owner;
 
 /// <summary>
 /// Class implements wrapper for exclusive use of input resource.
-/// Input resource is locked for exclusive use, can be modified by one accessors.
+/// The writer excludes other writers, readers keep reading the published snapshot.
+/// The snapshot is copied on the first access, so a writer which only replaces the value by set never copies it.
+/// The copy is published when the writer is destroyed, it is abandoned when the scope is left by an exception.
 /// </summary>
 template <class _Type>
-class resource_writer
+class [[nodiscard]] resource_writer
 {
-public:
-	constexpr resource_writer(resource_owner<_Type>* owner, std::source_location&& srcl) noexcept
-		: _owner(owner)
-		, _srcl(std::move(srcl))
-	{
-		const auto&& oldType = _owner->_get_value();
-		_resource = std::make_shared<_Type>(*oldType);
-
-		//_resource->push_exclusive_lock_details(std::move(srcl));
-	}
+	friend class resource_owner<_Type>;
 
+public:
 	constexpr resource_writer(const resource_writer& other) noexcept = delete;
 
 	constexpr resource_writer(resource_writer&& other) noexcept
 		: _resource(std::move(other._resource))
-		, _owner(other._owner)
-		, _srcl(other._srcl)
+		, _owner(std::exchange(other._owner, nullptr))
+		, _lock(std::move(other._lock))
+		, _uncaught(other._uncaught)
 	{
 	}
 
 	virtual ~resource_writer()
 	{
-		if (_resource && _owner)
-			_owner->_update_value(std::move(_resource));
-		/*if (_resource)
-			_resource->pop_exclusive_lock_details();*/
-	}
+		if (!_owner)
+			return;
 
-	constexpr resource_writer& operator=(const resource_writer& other) noexcept = delete;
+		if (_resource && std::uncaught_exceptions() <= _uncaught)
+			_owner->_publish(std::move(_resource));
 
-	constexpr resource_writer& operator=(resource_writer&& other) noexcept
-	{
-		_resource = std::move(other._resource);
-		_owner = std::move(other._owner);
-		_srcl = std::move(other._srcl);
-		return *this;
+		_owner->_writer_acquired.store(false, std::memory_order_release);
 	}
 
+	constexpr resource_writer& operator=(const resource_writer& other) noexcept = delete;
+	constexpr resource_writer& operator=(resource_writer&& other) noexcept = delete;
+
 	[[nodiscard]] constexpr operator _Type&() const
 	{
-		return *_resource;
+		return _value();
 	}
 
-	[[nodiscard]] constexpr const std::shared_ptr<_Type> operator->() const
+	[[nodiscard]] constexpr _Type* operator->() const
 	{
-		return _resource;
+		return &_value();
 	}
 
 	[[nodiscard]] constexpr _Type& get() const
 	{
-		return *_resource;
+		return _value();
 	}
 
 	template <class _FwdType>
 		requires std::is_constructible_v<_Type, _FwdType> || std::is_same_v<_Type, _FwdType>
 	constexpr void set(_FwdType&& object)
 	{
-		_resource = std::make_shared<_FwdType>(std::forward<_FwdType>(object));
+		_resource = std::make_unique<_Type>(std::forward<_FwdType>(object));
 	}
 
-	constexpr void swap(_Type& object) noexcept
+	constexpr void swap(_Type& object)
 	{
-		std::swap(*_resource, object);
+		std::swap(_value(), object);
 	}
 
 	[[nodiscard]] constexpr _Type move()
 	{
-		return std::move(*_resource);
+		return std::move(_value());
 	}
 
 	[[nodiscard]] constexpr _Type& operator()() const
 	{
-		return *_resource;
+		return _value();
 	}
 
 	template <class _Quantified = _Type, std::enable_if_t<constraints::is_container_v<_Quantified>, int> = 0>
 	[[nodiscard]] constexpr decltype(auto) begin() const
 	{
-		return _resource->begin();
+		return _value().begin();
 	}
 
 	template <class _Quantified = _Type, std::enable_if_t<constraints::is_container_v<_Quantified>, int> = 0>
 	[[nodiscard]] constexpr decltype(auto) end() const
 	{
-		return _resource->end();
+		return _value().end();
 	}
 
 	template <class _Quantified = _Type, std::enable_if_t<constraints::is_container_v<_Quantified>, int> = 0>
 	[[nodiscard]] constexpr decltype(auto) size() const
 	{
-		return _resource->size();
+		return _value().size();
 	}
 
 	template <class _Key>
 	[[nodiscard]] constexpr auto& operator[](const _Key& key)
 	{
-		return (*_resource)[key];
+		return _value()[key];
 	}
 
 	template <class _Key>
 	[[nodiscard]] constexpr const auto& operator[](const _Key& key) const
 	{
-		return (*_resource)[key];
+		return _value()[key];
+	}
+
+private:
+	resource_writer(resource_owner<_Type>* owner, std::unique_lock<std::mutex>&& lock) noexcept
+		: _owner(owner)
+		, _lock(std::move(lock))
+		, _uncaught(std::uncaught_exceptions())
+	{
+		_owner->_writer_acquired.store(true, std::memory_order_release);
+	}
+
+	[[nodiscard]] _Type& _value() const
+	{
+		// Snapshots are replaced only by writers, so the one read under the writer lock cannot be deleted meanwhile
+		if (!_resource)
+			_resource = std::make_unique<_Type>(*_owner->_get_value());
+
+		return *_resource;
 	}
 
 private:
-	std::shared_ptr<_Type> _resource;
+	mutable std::unique_ptr<_Type> _resource;
 	resource_owner<_Type>* _owner = nullptr;
-	std::source_location _srcl;
+	std::unique_lock<std::mutex> _lock;
+	int _uncaught = 0;
 };
 
 /// <summary>
 /// Class implements wrapper for concurrent use of input resource.
-/// Input resource is locked for concurrent use only. cannot be modified, but more accessors can read input resource.
+/// The reader holds the snapshot published when it was created, writers publishing meanwhile do not change it.
+/// The snapshot is protected by the epoch of the reader, which belongs to the thread that created the reader,
+///	so the reader must not be passed to another thread and should not be held for long, it delays deletion of all replaced snapshots.
 /// </summary>
 template <class _Type>
-class resource_reader
+class [[nodiscard]] resource_reader
 {
-public:
-	constexpr resource_reader(const resource_owner<_Type>* owner, std::source_location&& srcl) noexcept
-		: _resource(owner->_get_value())
-		, _owner(owner)
-		, _srcl(std::move(srcl))
-	{
-		//_resource->push_concurrent_lock_details(std::move(srcl));
-	}
+	friend class resource_owner<_Type>;
 
+public:
 	constexpr resource_reader(const resource_reader& other) noexcept = delete;
 
-	constexpr resource_reader(resource_reader&& other) noexcept
-		: _resource(std::move(other._resource))
-		, _owner(std::move(other._owner))
-		, _srcl(std::move(other._srcl))
-	{
-	}
+	constexpr resource_reader(resource_reader&& other) noexcept = default;
 
-	virtual ~resource_reader()
-	{
-		/*if (_resource)
-			_resource->pop_concurrent_lock_details(std::move(_srcl));*/
-	}
+	virtual ~resource_reader() = default;
 
 	constexpr resource_reader& operator=(const resource_reader& other) noexcept = delete;
 
-	constexpr resource_reader& operator=(resource_reader&& other) noexcept
-	{
-		_resource = std::move(other._resource);
-		_owner = std::move(other._owner);
-		_srcl = std::move(other._srcl);
-		return *this;
-	}
+	constexpr resource_reader& operator=(resource_reader&& other) noexcept = default;
 
 	[[nodiscard]] constexpr operator const _Type&() const
 	{
 		return *_resource;
 	}
 
-	[[nodiscard]] constexpr const std::shared_ptr<const _Type> operator->() const
+	[[nodiscard]] constexpr const _Type* operator->() const
 	{
 		return _resource;
 	}
@@ -244,34 +236,43 @@ public:
 	}
 
 private:
-	std::shared_ptr<const _Type> _resource;
-	const resource_owner<_Type>* _owner = nullptr;
-	std::source_location _srcl;
+	resource_reader(epoch_guard&& guard, const _Type* resource) noexcept
+		: _guard(std::move(guard))
+		, _resource(resource)
+	{
+	}
+
+private:
+	epoch_guard _guard;
+	const _Type* _resource = nullptr;
 };
 
 /// <summary>
-/// Class implements wrapper that gains thread-safe concurrent or exclusive access to the input resource.
-/// Each access method creates unique holder object that owns access to input resource for the scope.
-/// Wrapper owns input resource for whole lifetime and can be extended Only by holder objects.
+/// Read-copy-update owner of the resource, it suits values which are read very often and modified rarely, e.g. configurations or routing tables.
+/// Readers take the immutable snapshot published last, they never wait for writers and never see a half-done modification.
+/// Writers are serialized, each writer modifies its own copy of the snapshot and publishes it atomically.
+/// Readers only pin the epoch of the global epoch_domain, so they do not write any shared cache line and do not touch any reference count,
+///	the replaced snapshot is retired to the domain and deleted once no reader can hold it.
+/// Concurrent updates are batched: the first updater which acquires the writer lock applies all queued updates to one copy
+///	and publishes it once, so N concurrent updates cost one copy instead of N.
 /// </summary>
 /// <example>
 /// <code>
-///  concurrent::resource_owner<std::unordered_map<int, int>> oMap; //Can be concurrent::unordered_map<int, int> oMap;
+///  atomic_concurrent::unordered_map<std::string, route> routes;
 ///
-/// // exclusive access with lifetime of one operation
-/// oMap.exclusive()->emplace(5, 3);
-/// { // exclusive access with extended lifetime for more that only one
-///		auto oScope = oMap.exclusive();
-///		oScope->emplace(6, 4);
-///	} // exclusive access ends
+///  // Reader keeps its snapshot for the whole scope
+///  auto route = routes.reader()->at("default");
 ///
-/// // concurrent access with lifetime of one operation
-/// auto iResult = oMap.concurrent()->at(5);
+///  { // Writer publishes its copy at the end of the scope
+///     auto writer = routes.writer();
+///     writer->insert_or_assign("default", route);
+///  }
 ///
-/// { // concurrent access with extended lifetime for more that only one
-///		auto oScope = oMap.concurrent();
-///		auto iResultScope = oScope->at(6);
-///	} // concurrent access ends
+///  // Batched update, concurrent calls share one copy and one publication
+///  routes.update([](std::unordered_map<std::string, route>& value)
+///  {
+///     value.erase("obsolete");
+///  });
 /// </code>
 /// </example>
 template <class _Type>
@@ -285,80 +286,167 @@ public:
 
 	template <class _FwdType>
 		requires std::is_constructible_v<_Type, _FwdType> || std::is_same_v<_Type, _FwdType>
-	constexpr resource_owner(_FwdType&& object) noexcept
-		: _resource(std::make_shared<_FwdType>(std::forward<_FwdType>(object)))
+	constexpr resource_owner(_FwdType&& object)
+		: _resource(new const _Type(std::forward<_FwdType>(object)))
 	{
 	}
 
+	/// <summary>
+	/// Swaps the snapshots of both owners, they must not be used by other threads meanwhile.
+	/// </summary>
 	constexpr resource_owner<_Type>& operator=(resource_owner<_Type>&& other) noexcept
 	{
-		_resource = std::move(other._resource.load());
+		other._resource.store(_resource.exchange(other._resource.load()));
 		return *this;
 	}
 
+	/// <summary>
+	/// Deletes the current snapshot, replaced snapshots are deleted by the epoch domain.
+	/// </summary>
 	virtual ~resource_owner()
 	{
-		_stopSource.request_stop();
+		delete _resource.load(std::memory_order_acquire);
 	}
 
-	[[nodiscard]] constexpr resource_writer<_Type> writer(std::source_location srcl = std::source_location::current())
+	/// <summary>
+	/// Waits until other writers and batched updates finish.
+	/// </summary>
+	[[nodiscard]] resource_writer<_Type> writer([[maybe_unused]] std::source_location srcl = std::source_location::current())
 	{
-		std::unique_lock lock(_writerMutex);
-		_writerSignal.wait(lock, _stopSource.get_token(), [&]()
-			{
-				return !_writerAcquired || _stopSource.stop_requested();
-			});
-
-		if (_stopSource.stop_requested())
-			throw std::exception("Break all waiting threads due container destruction.");
-
-		_writerAcquired = true;
-		return resource_writer<_Type>(this, std::move(srcl));
+		return resource_writer<_Type>(this, std::unique_lock(_writer_mutex));
 	}
 
-	[[nodiscard]] constexpr std::optional<resource_writer<_Type>> try_to_acquire_writer(std::source_location srcl = std::source_location::current()) noexcept
+	[[nodiscard]] std::optional<resource_writer<_Type>> try_to_acquire_writer([[maybe_unused]] std::source_location srcl = std::source_location::current()) noexcept
 	{
-		if (_writerAcquired)
+		std::unique_lock lock(_writer_mutex, std::try_to_lock);
+		if (!lock)
 			return {};
 
-		std::unique_lock lock(_writerMutex);
-		if (_writerAcquired)
-			return {};
+		return resource_writer<_Type>(this, std::move(lock));
+	}
 
-		_writerAcquired = true;
-		return resource_writer<_Type>(this, std::move(srcl));
+	[[nodiscard]] resource_reader<_Type> reader([[maybe_unused]] std::source_location srcl = std::source_location::current()) const
+	{
+		// The epoch is pinned before the snapshot is loaded
+		auto guard = epoch_domain::global().pin();
+		return resource_reader<_Type>(std::move(guard), _get_value());
 	}
 
-	[[nodiscard]] constexpr resource_reader<_Type> reader(std::source_location srcl = std::source_location::current()) const noexcept
+	/// <summary>
+	/// Calls fn(_Type&) on the copy of the snapshot and publishes it, updates queued by other threads meanwhile are applied to the same copy.
+	/// It returns after the copy with the update has been published.
+	/// Batched updates are not atomic, unlike the writer: the exception thrown by fn is rethrown to its caller,
+	///	but the copy is shared with the other updates of the batch, so it is still published with the changes fn made before the exception.
+	/// fn which may throw has to leave the value unchanged itself. The exception thrown by the copy of the snapshot is rethrown
+	///	to every updater of the batch and nothing is published.
+	/// </summary>
+	template <class _Fn>
+		requires std::is_invocable_v<_Fn&, _Type&>
+	void update(_Fn&& fn)
 	{
-		return resource_reader<_Type>(this, std::move(srcl));
+		update_request request;
+		request.context = std::addressof(fn);
+		request.apply = [](void* context, _Type& value)
+		{
+			std::invoke(*static_cast<std::remove_reference_t<_Fn>*>(context), value);
+		};
+
+		request.next = _pending.load(std::memory_order_relaxed);
+		while (!_pending.compare_exchange_weak(request.next, &request, std::memory_order_release, std::memory_order_relaxed))
+			;
+
+		{
+			std::unique_lock lock(_writer_mutex);
+
+			// The previous holder of the lock may have applied the request already
+			if (!request.done)
+				_combine();
+		}
+
+		if (request.error)
+			std::rethrow_exception(request.error);
 	}
 
-	constexpr bool is_writer_free() const
+	[[nodiscard]] bool is_writer_free() const noexcept
 	{
-		return !_writerAcquired;
+		return !_writer_acquired.load(std::memory_order_acquire);
 	}
 
 private:
-	constexpr decltype(auto) _get_value() const
+	/// <summary>
+	/// Update queued in the lock-free stack, it lives on the stack of the waiting updater.
+	/// Done and error are written and read under the writer lock.
+	/// </summary>
+	struct update_request
 	{
-		return _resource.load();
+		void* context = nullptr;
+		void (*apply)(void*, _Type&) = nullptr;
+		update_request* next = nullptr;
+		std::exception_ptr error;
+		bool done = false;
+	};
+
+	[[nodiscard]] const _Type* _get_value() const noexcept
+	{
+		return _resource.load(std::memory_order_acquire);
 	}
 
-	constexpr void _update_value(std::shared_ptr<_Type>&& value)
+	void _publish(std::unique_ptr<_Type>&& value)
 	{
-		_resource.store(std::move(value));
-		_writerAcquired = false;
-		_writerSignal.notify_one();
+		epoch_domain::global().retire(_resource.exchange(value.release(), std::memory_order_acq_rel));
 	}
 
-private:
-	mutable std::atomic<std::shared_ptr<_Type>> _resource = std::make_shared<_Type>();
-	std::atomic<bool> _writerAcquired;
+	// Called under the writer lock
+	void _combine()
+	{
+		auto* batch = _pending.exchange(nullptr, std::memory_order_acquire);
+		if (!batch)
+			return;
+
+		// The stack is reversed, so the updates are applied in the order of their arrival
+		update_request* ordered = nullptr;
+		while (batch)
+			ordered = std::exchange(batch, std::exchange(batch->next, ordered));
 
-	std::mutex _writerMutex;
-	std::stop_source _stopSource;
-	std::condition_variable_any _writerSignal;
+		std::unique_ptr<_Type> copy;
+		try
+		{
+			copy = std::make_unique<_Type>(*_get_value());
+		}
+		catch (...)
+		{
+			// The requests are already taken from the stack, so all of them fail instead of being lost
+			for (auto* request = ordered; request; request = request->next)
+				request->error = std::current_exception();
+		}
+
+		if (copy)
+		{
+			for (auto* request = ordered; request; request = request->next)
+			{
+				try
+				{
+					request->apply(request->context, *copy);
+				}
+				catch (...)
+				{
+					request->error = std::current_exception();
+				}
+			}
+
+			_publish(std::move(copy));
+		}
+
+		// The request is destroyed by its owner as soon as it is done, the next pointer is read before
+		while (ordered)
+			std::exchange(ordered, ordered->next)->done = true;
+	}
+
+private:
+	std::atomic<const _Type*> _resource = new const _Type();
+	std::atomic<update_request*> _pending = nullptr;
+	std::atomic<bool> _writer_acquired = false;
+	std::mutex _writer_mutex;
 };
 
 /// Pre-defined conversions ///
@@ -405,5 +493,10 @@ using unordered_multimap = resource_owner<std::unordered_multimap<_Args...>>;
 template <class _Arg>
 using functor = resource_owner<std::function<_Arg>>;
 
-} // namespace janecekvit::experimental::synchronization::atomic_concurrent
-#endif
+} // namespace janecekvit::synchronization::atomic_concurrent
+
+/// The container was experimental before, the old namespace is kept for existing code
+namespace janecekvit::experimental::synchronization
+{
+namespace atomic_concurrent = janecekvit::synchronization::atomic_concurrent;
+} // namespace janecekvit::experimental::synchronization
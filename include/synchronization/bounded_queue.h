@@ -0,0 +1,358 @@
+/*
+MIT License
+Copyright (c) 2025 Vit Janecek (mailto:janecekvit@outlook.com)
+
+bounded_queue.h
+Purpose:	header file contains lock-free bounded multi-producer/multi-consumer queue
+
+
+@author: Vit Janecek
+@mailto: <mailto:janecekvit@outlook.com>
+@version 1.00 16/10/2026
+*/
+
+#pragma once
+#include "extensions/constraints.h"
+#include "synchronization/cache_line.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace janecekvit::synchronization::concurrent
+{
+/// <summary>
+/// Lock-free bounded multi-producer/multi-consumer queue based on the ring buffer of sequenced cells (D. Vyukov).
+/// Every cell carries a sequence number which tells producers and consumers whether the cell is free or filled for the current lap,
+///	so one successful CAS on the enqueue/dequeue position is the only synchronization of try operations.
+/// Blocking operations park on the sequence number of the contended cell via std::atomic::wait, no mutex is ever taken.
+/// Capacity is rounded up to the power of two, at least two cells are allocated so that free and filled sequences cannot alias.
+/// </summary>
+/// <example>
+/// <code>
+///  concurrent::bounded_queue<int> queue(1024);
+///
+///  queue.push(5);				// blocks while the queue is full
+///  auto value = queue.pop();	// blocks while the queue is empty
+///
+///  if (queue.try_push(6))		// never blocks
+///		auto result = queue.try_pop();
+/// </code>
+/// </example>
+template <class _Type>
+class bounded_queue
+{
+	// A claimed cell is released only by its commit, a throwing move would leave it claimed and block the queue forever
+	static_assert(std::is_nothrow_move_constructible_v<_Type>, "bounded_queue requires nothrow move constructible type!");
+	static_assert(std::is_nothrow_destructible_v<_Type>, "bounded_queue requires nothrow destructible type!");
+
+	template <class _It>
+	static constexpr bool _nothrow_output = noexcept(*std::declval<_It&>()++ = std::declval<_Type>());
+
+	struct claim
+	{
+		size_t position = 0;
+		size_t count = 0;
+		size_t sequence = 0;
+	};
+
+	struct cell
+	{
+		std::atomic<size_t> sequence;
+		alignas(_Type) std::byte storage[sizeof(_Type)];
+
+		_Type* value() noexcept
+		{
+			return std::launder(reinterpret_cast<_Type*>(storage));
+		}
+	};
+
+public:
+	using value_type = _Type;
+
+public:
+	explicit bounded_queue(size_t capacity)
+		: _capacity(std::bit_ceil(std::max<size_t>(capacity, 2)))
+		, _mask(_capacity - 1)
+		, _cells(std::make_unique<cell[]>(_capacity))
+	{
+		if (capacity == 0)
+			throw std::invalid_argument("bounded_queue capacity must be greater than zero!");
+
+		for (size_t i = 0; i < _capacity; i++)
+			_cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	bounded_queue(const bounded_queue&) = delete;
+	bounded_queue& operator=(const bounded_queue&) = delete;
+
+	virtual ~bounded_queue()
+	{
+		while (try_pop())
+		{
+		}
+	}
+
+	[[nodiscard]] bool try_push(const _Type& value)
+		requires std::is_copy_constructible_v<_Type>
+	{
+		return try_push(_Type(value));
+	}
+
+	[[nodiscard]] bool try_push(_Type&& value) noexcept
+	{
+		const auto slot = _claim(_enqueue_position, 1, 0);
+		if (slot.count == 0)
+			return false;
+
+		_commit_push(slot.position, std::move(value));
+		return true;
+	}
+
+	template <class... _Args>
+		requires std::is_constructible_v<_Type, _Args...>
+	[[nodiscard]] bool try_emplace(_Args&&... args)
+	{
+		return try_push(_Type(std::forward<_Args>(args)...));
+	}
+
+	[[nodiscard]] std::optional<_Type> try_pop() noexcept
+	{
+		const auto slot = _claim(_dequeue_position, 1, 1);
+		if (slot.count == 0)
+			return std::nullopt;
+
+		return _commit_pop(slot.position);
+	}
+
+	[[nodiscard]] bool try_pop(_Type& value) noexcept(std::is_nothrow_move_assignable_v<_Type>)
+	{
+		auto result = try_pop();
+		if (!result)
+			return false;
+
+		value = std::move(*result);
+		return true;
+	}
+
+	void push(const _Type& value)
+		requires std::is_copy_constructible_v<_Type>
+	{
+		push(_Type(value));
+	}
+
+	void push(_Type&& value) noexcept
+	{
+		for (;;)
+		{
+			const auto slot = _claim(_enqueue_position, 1, 0);
+			if (slot.count > 0)
+				return _commit_push(slot.position, std::move(value));
+
+			_cell(slot.position).sequence.wait(slot.sequence, std::memory_order_acquire);
+		}
+	}
+
+	template <class... _Args>
+		requires std::is_constructible_v<_Type, _Args...>
+	void emplace(_Args&&... args)
+	{
+		push(_Type(std::forward<_Args>(args)...));
+	}
+
+	[[nodiscard]] _Type pop() noexcept
+	{
+		for (;;)
+		{
+			const auto slot = _claim(_dequeue_position, 1, 1);
+			if (slot.count > 0)
+				return _commit_pop(slot.position);
+
+			_cell(slot.position).sequence.wait(slot.sequence, std::memory_order_acquire);
+		}
+	}
+
+	/// <summary>
+	/// Moves the longest possible prefix of [first, last) into the queue by one position claim.
+	/// </summary>
+	/// <returns>Number of elements moved into the queue.</returns>
+	template <std::forward_iterator _It>
+		requires std::is_same_v<std::iter_value_t<_It>, _Type>
+	[[nodiscard]] size_t try_push_batch(_It first, _It last) noexcept
+	{
+		const auto requested = static_cast<size_t>(std::distance(first, last));
+		if (requested == 0)
+			return 0;
+
+		const auto slot = _claim(_enqueue_position, requested, 0);
+		for (size_t i = 0; i < slot.count; i++, ++first)
+			_commit_push(slot.position + i, std::move(*first));
+
+		return slot.count;
+	}
+
+	/// <summary>
+	/// Pops up to max_count elements by one position claim.
+	/// When writing to the output iterator throws, the remaining elements of the claim are destroyed so the cells are released.
+	/// </summary>
+	/// <returns>Number of elements written to the output iterator.</returns>
+	template <std::output_iterator<_Type> _It>
+	[[nodiscard]] size_t try_pop_batch(_It output, size_t max_count) noexcept(_nothrow_output<_It>)
+	{
+		if (max_count == 0)
+			return 0;
+
+		const auto slot = _claim(_dequeue_position, max_count, 1);
+		size_t popped = 0;
+		try
+		{
+			for (; popped < slot.count; popped++)
+				*output++ = _commit_pop(slot.position + popped);
+		}
+		catch (...)
+		{
+			while (++popped < slot.count)
+				_commit_pop(slot.position + popped);
+
+			throw;
+		}
+
+		return slot.count;
+	}
+
+	/// <summary>
+	/// Pushes all elements of [first, last), blocks while the queue is full.
+	/// </summary>
+	template <std::forward_iterator _It>
+		requires std::is_same_v<std::iter_value_t<_It>, _Type>
+	void push_batch(_It first, _It last) noexcept
+	{
+		while (first != last)
+		{
+			const auto pushed = try_push_batch(first, last);
+			if (pushed == 0)
+			{
+				push(std::move(*first++));
+				continue;
+			}
+
+			std::advance(first, pushed);
+		}
+	}
+
+	/// <summary>
+	/// Pops at least one and up to max_count elements, blocks while the queue is empty.
+	/// </summary>
+	/// <returns>Number of elements written to the output iterator.</returns>
+	template <std::output_iterator<_Type> _It>
+	[[nodiscard]] size_t pop_batch(_It output, size_t max_count) noexcept(_nothrow_output<_It>)
+	{
+		if (max_count == 0)
+			return 0;
+
+		const auto popped = try_pop_batch(output, max_count);
+		if (popped > 0)
+			return popped;
+
+		*output++ = pop();
+		return 1 + try_pop_batch(output, max_count - 1);
+	}
+
+	/// <summary>
+	/// Approximate number of elements, exact only when no other thread modifies the queue.
+	/// </summary>
+	[[nodiscard]] size_t size() const noexcept
+	{
+		const auto dequeue = _dequeue_position.load(std::memory_order_acquire);
+		const auto enqueue = _enqueue_position.load(std::memory_order_acquire);
+		return enqueue > dequeue ? enqueue - dequeue : 0;
+	}
+
+	[[nodiscard]] bool empty() const noexcept
+	{
+		return size() == 0;
+	}
+
+	[[nodiscard]] size_t capacity() const noexcept
+	{
+		return _capacity;
+	}
+
+private:
+	cell& _cell(size_t position) const noexcept
+	{
+		return _cells[position & _mask];
+	}
+
+	/// <summary>
+	/// Claims up to max_count consecutive cells whose sequence equals position + offset
+	/// (offset 0 for producers - the cell is free, offset 1 for consumers - the cell is filled).
+	/// When no cell can be claimed, the result carries the observed sequence of the blocking cell so the caller can wait on it.
+	/// </summary>
+	claim _claim(std::atomic<size_t>& cursor, size_t max_count, size_t offset) noexcept
+	{
+		auto position = cursor.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			size_t count = 0;
+			size_t sequence = 0;
+			for (; count < max_count; count++)
+			{
+				sequence = _cell(position + count).sequence.load(std::memory_order_acquire);
+				if (sequence != position + count + offset)
+					break;
+			}
+
+			if (count == 0)
+			{
+				// Another thread has already claimed this position, retry with the current one
+				if (static_cast<std::ptrdiff_t>(sequence - (position + offset)) > 0)
+				{
+					position = cursor.load(std::memory_order_relaxed);
+					continue;
+				}
+
+				return { position, 0, sequence };
+			}
+
+			if (cursor.compare_exchange_weak(position, position + count, std::memory_order_relaxed))
+				return { position, count, 0 };
+		}
+	}
+
+	void _commit_push(size_t position, _Type&& value) noexcept
+	{
+		auto& target = _cell(position);
+		std::construct_at(reinterpret_cast<_Type*>(target.storage), std::move(value));
+		target.sequence.store(position + 1, std::memory_order_release);
+		target.sequence.notify_all();
+	}
+
+	_Type _commit_pop(size_t position) noexcept
+	{
+		auto& source = _cell(position);
+		_Type value(std::move(*source.value()));
+		std::destroy_at(source.value());
+		source.sequence.store(position + _capacity, std::memory_order_release);
+		source.sequence.notify_all();
+		return value;
+	}
+
+private:
+	const size_t _capacity;
+	const size_t _mask;
+	const std::unique_ptr<cell[]> _cells;
+
+	alignas(cache_line_size) std::atomic<size_t> _enqueue_position = 0;
+	alignas(cache_line_size) std::atomic<size_t> _dequeue_position = 0;
+};
+
+} // namespace janecekvit::synchronization::concurrent
@@ -0,0 +1,45 @@
+/*
+MIT License
+Copyright (c) 2025 Vit Janecek (mailto:janecekvit@outlook.com)
+
+cache_line.h
+Purpose:	header file contains size of the cache line used to separate data written by different threads
+
+
+@author: Vit Janecek
+@mailto: <mailto:janecekvit@outlook.com>
+@version 1.00 16/10/2026
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+namespace janecekvit::synchronization
+{
+/// <summary>
+/// Minimal distance of two objects written by different threads which avoids false sharing.
+/// GCC warns that std::hardware_destructive_interference_size depends on -mtune, the value is read only here,
+///	so all padded layouts of the framework use the same constant.
+/// </summary>
+#if defined(__cpp_lib_hardware_interference_size)
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winterference-size"
+#endif
+inline constexpr size_t cache_line_size = std::hardware_destructive_interference_size;
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#else
+inline constexpr size_t cache_line_size = 64;
+#endif
+
+/// <summary>
+/// Alignment of the member in the padded layout, the natural alignment in the compact layout.
+/// </summary>
+template <class _Type, bool _CacheAligned>
+inline constexpr size_t cache_alignment = _CacheAligned ? cache_line_size : alignof(_Type);
+
+} // namespace janecekvit::synchronization
@@ -15,6 +15,8 @@ Purpose:	header file contains set of thread-safe concurrent containers,
 
 #pragma once
 #include "extensions/constraints.h"
+#include "synchronization/cache_line.h"
+#include "synchronization/distributed_shared_mutex.h"
 #include "synchronization/lock_owner.h"
 #include "synchronization/signal.h"
 
@@ -39,31 +41,69 @@ Purpose:	header file contains set of thread-safe concurrent containers,
 ///  and thread-safe methods for every possible concurrent object
 namespace janecekvit::synchronization::concurrent
 {
-template <class _Type, lock_tracking_policy _Policy = lock_tracking_disabled>
+/// <summary>
+/// Memory layout of the resource owner.
+/// separate: the mutex and the resource are allocated separately on the heap.
+/// cache_aligned: the mutex and the resource share one allocation, each of them starts on its own cache line,
+///	so the lock word written by every acquisition does not false-share with the resource or with the neighbouring owners.
+/// inline_storage: the mutex and the resource are members of the owner itself, there is no allocation and no indirection,
+///	the owner can be neither copied nor moved and get_mutex returns the pointer which does not own the mutex.
+/// </summary>
+enum class owner_layout
+{
+	separate,
+	cache_aligned,
+	inline_storage
+};
+
+template <class _Type, lock_tracking_policy _Policy = lock_tracking_disabled, owner_layout _Layout = owner_layout::separate, constraints::is_shared_mutex_type _MutexType = std::shared_mutex>
 class resource_owner_base;
 
+namespace details
+{
+/// <summary>
+/// Mutex of the inline layout, it is the first base of the owner, so it outlives the lock owner, whose destructor may still lock it.
+/// </summary>
+template <class _MutexType, bool _Inline>
+struct inline_mutex
+{
+};
+
+template <class _MutexType>
+struct inline_mutex<_MutexType, true>
+{
+	_MutexType _inline_mutex;
+};
+} // namespace details
+
 /// <summary>
 /// Class implements wrapper for exclusive use of input resource.
 /// Input resource is locked for exclusive use, can be modified by one accessors.
 /// </summary>
-template <class _Type, lock_tracking_policy _Policy>
-class [[nodiscard]] exclusive_resource_holder : public exclusive_lock_holder<std::shared_mutex, _Policy>
+template <class _Type, lock_tracking_policy _Policy, owner_layout _Layout = owner_layout::separate, constraints::is_shared_mutex_type _MutexType = std::shared_mutex>
+class [[nodiscard]] exclusive_resource_holder : public exclusive_lock_holder<_MutexType, _Policy>
 {
-	using base_type = exclusive_lock_holder<std::shared_mutex, _Policy>;
+	using base_type = exclusive_lock_holder<_MutexType, _Policy>;
 
 public:
-	constexpr exclusive_resource_holder(resource_owner_base<_Type, _Policy>& owner) noexcept
+	constexpr exclusive_resource_holder(resource_owner_base<_Type, _Policy, _Layout, _MutexType>& owner) noexcept
 		: base_type(owner)
 		, _owner(&owner)
 	{
 	}
 
-	constexpr exclusive_resource_holder(resource_owner_base<_Type, _Policy>& owner, std::source_location&& srcl) noexcept
+	constexpr exclusive_resource_holder(resource_owner_base<_Type, _Policy, _Layout, _MutexType>& owner, std::source_location&& srcl) noexcept
 		: base_type(owner, std::move(srcl), typeid(_Type))
 		, _owner(&owner)
 	{
 	}
 
+	constexpr exclusive_resource_holder(resource_owner_base<_Type, _Policy, _Layout, _MutexType>& owner, std::defer_lock_t) noexcept
+		: base_type(owner, std::defer_lock, typeid(_Type))
+		, _owner(&owner)
+	{
+	}
+
 	virtual ~exclusive_resource_holder() = default;
 
 	constexpr exclusive_resource_holder(const exclusive_resource_holder& other) noexcept = delete;
@@ -86,19 +126,19 @@ public:
 	[[nodiscard]] constexpr operator _Type&() const
 	{
 		this->_check_ownership();
-		return *_owner->_get_resource();
+		return _owner->_get_resource_ref();
 	}
 
-	[[nodiscard]] constexpr const std::shared_ptr<_Type> operator->() const
+	[[nodiscard]] constexpr _Type* operator->() const
 	{
 		this->_check_ownership();
-		return _owner->_get_resource();
+		return std::addressof(_owner->_get_resource_ref());
 	}
 
 	[[nodiscard]] constexpr _Type& get() const
 	{
 		this->_check_ownership();
-		return *_owner->_get_resource();
+		return _owner->_get_resource_ref();
 	}
 
 	template <class _FwdType>
@@ -124,70 +164,76 @@ public:
 	[[nodiscard]] constexpr _Type& operator()() const
 	{
 		this->_check_ownership();
-		return *_owner->_get_resource();
+		return _owner->_get_resource_ref();
 	}
 
 	template <class _Quantified = _Type, std::enable_if_t<constraints::is_container_v<_Quantified>, int> = 0>
 	[[nodiscard]] constexpr decltype(auto) begin() const
 	{
 		this->_check_ownership();
-		return _owner->_get_resource()->begin();
+		return _owner->_get_resource_ref().begin();
 	}
 
 	template <class _Quantified = _Type, std::enable_if_t<constraints::is_container_v<_Quantified>, int> = 0>
 	[[nodiscard]] constexpr decltype(auto) end() const
 	{
 		this->_check_ownership();
-		return _owner->_get_resource()->end();
+		return _owner->_get_resource_ref().end();
 	}
 
 	template <class _Quantified = _Type, std::enable_if_t<constraints::is_container_v<_Quantified>, int> = 0>
 	[[nodiscard]] constexpr decltype(auto) size() const
 	{
 		this->_check_ownership();
-		return _owner->_get_resource()->size();
+		return _owner->_get_resource_ref().size();
 	}
 
 	template <class _Key>
 	[[nodiscard]] constexpr auto& operator[](const _Key& key)
 	{
 		this->_check_ownership();
-		return (*_owner->_get_resource())[key];
+		return _owner->_get_resource_ref()[key];
 	}
 
 	template <class _Key>
 	[[nodiscard]] constexpr const auto& operator[](const _Key& key) const
 	{
 		this->_check_ownership();
-		return (*_owner->_get_resource())[key];
+		return _owner->_get_resource_ref()[key];
 	}
 
 private:
-	resource_owner_base<_Type, _Policy>* _owner;
+	resource_owner_base<_Type, _Policy, _Layout, _MutexType>* _owner;
 };
 
 /// <summary>
 /// Class implements wrapper for concurrent use of input resource.
 /// Input resource is locked for concurrent use only. cannot be modified, but more accessors can read input resource.
 /// </summary>
-template <class _Type, lock_tracking_policy _Policy>
-class [[nodiscard]] concurrent_resource_holder : public concurrent_lock_holder<std::shared_mutex, _Policy>
+template <class _Type, lock_tracking_policy _Policy, owner_layout _Layout = owner_layout::separate, constraints::is_shared_mutex_type _MutexType = std::shared_mutex>
+class [[nodiscard]] concurrent_resource_holder : public concurrent_lock_holder<_MutexType, _Policy>
 {
-	using base_type = concurrent_lock_holder<std::shared_mutex, _Policy>;
+	using base_type = concurrent_lock_holder<_MutexType, _Policy>;
 
 public:
-	constexpr concurrent_resource_holder(resource_owner_base<_Type, _Policy>& owner) noexcept
+	constexpr concurrent_resource_holder(resource_owner_base<_Type, _Policy, _Layout, _MutexType>& owner) noexcept
 		: base_type(owner)
 		, _owner(&owner)
 	{
 	}
 
-	constexpr concurrent_resource_holder(resource_owner_base<_Type, _Policy>& owner, std::source_location&& srcl) noexcept
+	constexpr concurrent_resource_holder(resource_owner_base<_Type, _Policy, _Layout, _MutexType>& owner, std::source_location&& srcl) noexcept
 		: base_type(owner, std::move(srcl), typeid(_Type))
 		, _owner(&owner)
 	{
 	}
 
+	constexpr concurrent_resource_holder(resource_owner_base<_Type, _Policy, _Layout, _MutexType>& owner, std::defer_lock_t) noexcept
+		: base_type(owner, std::defer_lock, typeid(_Type))
+		, _owner(&owner)
+	{
+	}
+
 	~concurrent_resource_holder() = default;
 
 	constexpr concurrent_resource_holder(const concurrent_resource_holder& other) noexcept = delete;
@@ -210,57 +256,57 @@ public:
 	[[nodiscard]] constexpr operator const _Type&() const
 	{
 		this->_check_ownership();
-		return *_owner->_get_resource();
+		return _owner->_get_resource_ref();
 	}
 
-	[[nodiscard]] constexpr const std::shared_ptr<const _Type> operator->() const
+	[[nodiscard]] constexpr const _Type* operator->() const
 	{
 		this->_check_ownership();
-		return _owner->_get_resource();
+		return std::addressof(_owner->_get_resource_ref());
 	}
 
 	[[nodiscard]] constexpr const _Type& get() const
 	{
 		this->_check_ownership();
-		return *_owner->_get_resource();
+		return _owner->_get_resource_ref();
 	}
 
 	[[nodiscard]] constexpr const _Type& operator()() const
 	{
 		this->_check_ownership();
-		return *_owner->_get_resource();
+		return _owner->_get_resource_ref();
 	}
 
 	template <class _Quantified = _Type, std::enable_if_t<constraints::is_container_v<_Quantified>, int> = 0>
 	[[nodiscard]] constexpr decltype(auto) begin() const
 	{
 		this->_check_ownership();
-		return _owner->_get_resource()->begin();
+		return _owner->_get_resource_ref().begin();
 	}
 
 	template <class _Quantified = _Type, std::enable_if_t<constraints::is_container_v<_Quantified>, int> = 0>
 	[[nodiscard]] constexpr decltype(auto) end() const
 	{
 		this->_check_ownership();
-		return _owner->_get_resource()->end();
+		return _owner->_get_resource_ref().end();
 	}
 
 	template <class _Quantified = _Type, std::enable_if_t<constraints::is_container_v<_Quantified>, int> = 0>
 	[[nodiscard]] constexpr decltype(auto) size() const
 	{
 		this->_check_ownership();
-		return _owner->_get_resource()->size();
+		return _owner->_get_resource_ref().size();
 	}
 
 	template <class _Key>
 	[[nodiscard]] constexpr const auto& operator[](const _Key& key) const
 	{
 		this->_check_ownership();
-		return (*_owner->_get_resource())[key];
+		return _owner->_get_resource_ref()[key];
 	}
 
 private:
-	resource_owner_base<_Type, _Policy>* _owner;
+	resource_owner_base<_Type, _Policy, _Layout, _MutexType>* _owner;
 };
 
 /// <summary>
@@ -289,40 +335,93 @@ private:
 /// </code>
 /// </example>
 
-template <class _Type, lock_tracking_policy _Policy>
-class [[nodiscard]] resource_owner_base : public lock_owner_base<std::shared_mutex, _Policy>
+template <class _Type, lock_tracking_policy _Policy, owner_layout _Layout, constraints::is_shared_mutex_type _MutexType>
+class [[nodiscard]] resource_owner_base : private details::inline_mutex<_MutexType, _Layout == owner_layout::inline_storage>,
+											 public lock_owner_base<_MutexType, _Policy>
 {
-	friend exclusive_resource_holder<_Type, _Policy>;
-	friend concurrent_resource_holder<_Type, _Policy>;
+	friend exclusive_resource_holder<_Type, _Policy, _Layout, _MutexType>;
+	friend concurrent_resource_holder<_Type, _Policy, _Layout, _MutexType>;
+
+	using base_type = lock_owner_base<_MutexType, _Policy>;
+
+	/// <summary>
+	/// Single allocation of the cache-aligned layout, the mutex and the resource start on separate cache lines.
+	/// </summary>
+	struct aligned_block
+	{
+		template <class... _Args>
+		explicit aligned_block(_Args&&... args)
+			: resource(std::forward<_Args>(args)...)
+		{
+		}
+
+		alignas(cache_line_size) _MutexType mutex;
+		alignas(cache_line_size) _Type resource;
+	};
 
-	using base_type = lock_owner_base<std::shared_mutex, _Policy>;
+	using storage_type = std::conditional_t<_Layout == owner_layout::inline_storage, _Type, std::shared_ptr<_Type>>;
 
 public:
-	using exclusive_holder_type = exclusive_resource_holder<_Type, _Policy>;
-	using concurrent_holder_type = concurrent_resource_holder<_Type, _Policy>;
+	using exclusive_holder_type = exclusive_resource_holder<_Type, _Policy, _Layout, _MutexType>;
+	using concurrent_holder_type = concurrent_resource_holder<_Type, _Policy, _Layout, _MutexType>;
+	using mutex_type = _MutexType;
+	static constexpr owner_layout layout = _Layout;
 
 public:
-	constexpr resource_owner_base() = default;
+	resource_owner_base()
+		requires(_Layout == owner_layout::separate)
+		: _resource(std::make_shared<_Type>())
+	{
+	}
+
+	resource_owner_base()
+		requires(_Layout == owner_layout::cache_aligned)
+		: resource_owner_base(std::make_shared<aligned_block>())
+	{
+	}
+
 	constexpr ~resource_owner_base() = default;
 
 	constexpr resource_owner_base(_Type&& object) noexcept
+		requires(_Layout == owner_layout::separate)
 		: base_type()
 		, _resource(std::make_shared<_Type>(std::forward<_Type>(object)))
 	{
 	}
 
+	resource_owner_base(_Type&& object)
+		requires(_Layout == owner_layout::cache_aligned)
+		: resource_owner_base(std::make_shared<aligned_block>(std::forward<_Type>(object)))
+	{
+	}
+
+	// The lock owner gets the pointer to the inline mutex which does not own it
+	resource_owner_base()
+		requires(_Layout == owner_layout::inline_storage)
+		: base_type(std::shared_ptr<_MutexType>(std::shared_ptr<void>(), &this->_inline_mutex))
+		, _resource()
+	{
+	}
+
+	resource_owner_base(_Type&& object)
+		requires(_Layout == owner_layout::inline_storage)
+		: base_type(std::shared_ptr<_MutexType>(std::shared_ptr<void>(), &this->_inline_mutex))
+		, _resource(std::forward<_Type>(object))
+	{
+	}
+
 	// For compile-time disabled tracking
 	[[nodiscard]] constexpr auto exclusive() noexcept
 		requires(_Policy::is_compile_time && !_Policy::should_track())
 	{
-		return exclusive_resource_holder<_Type, _Policy>(*this);
+		return exclusive_holder_type(*this);
 	}
 
 	// For compile-time enabled tracking
 	[[nodiscard]] constexpr auto exclusive(std::source_location srcl = std::source_location::current()) noexcept
 		requires(_Policy::is_compile_time && _Policy::should_track())
 	{
-		return exclusive_resource_holder<_Type, _Policy>(*this, std::move(srcl));
+		return exclusive_holder_type(*this, std::move(srcl));
 	}
 
 	// For runtime tracking
@@ -331,23 +430,23 @@ public:
 	{
 		if (_Policy::should_track())
 		{
-			return exclusive_resource_holder<_Type, _Policy>(*this, std::move(srcl));
+			return exclusive_holder_type(*this, std::move(srcl));
 		}
-		return exclusive_resource_holder<_Type, _Policy>(*this);
+		return exclusive_holder_type(*this);
 	}
 
 	// For compile-time disabled tracking
 	[[nodiscard]] constexpr auto concurrent() const noexcept
 		requires(_Policy::is_compile_time && !_Policy::should_track())
 	{
-		return concurrent_resource_holder<_Type, _Policy>(const_cast<resource_owner_base<_Type, _Policy>&>(*this));
+		return concurrent_holder_type(const_cast<resource_owner_base<_Type, _Policy, _Layout, _MutexType>&>(*this));
 	}
 
 	// For compile-time enabled tracking
 	[[nodiscard]] constexpr auto concurrent(std::source_location srcl = std::source_location::current()) const noexcept
 		requires(_Policy::is_compile_time && _Policy::should_track())
 	{
-		return concurrent_resource_holder<_Type, _Policy>(const_cast<resource_owner_base<_Type, _Policy>&>(*this), std::move(srcl));
+		return concurrent_holder_type(const_cast<resource_owner_base<_Type, _Policy, _Layout, _MutexType>&>(*this), std::move(srcl));
 	}
 
 	// For runtime tracking
@@ -356,38 +455,58 @@ public:
 	{
 		if (_Policy::should_track())
 		{
-			return concurrent_resource_holder<_Type, _Policy>(const_cast<resource_owner_base<_Type, _Policy>&>(*this), std::move(srcl));
+			return concurrent_holder_type(const_cast<resource_owner_base<_Type, _Policy, _Layout, _MutexType>&>(*this), std::move(srcl));
 		}
-		return concurrent_resource_holder<_Type, _Policy>(const_cast<resource_owner_base<_Type, _Policy>&>(*this));
+		return concurrent_holder_type(const_cast<resource_owner_base<_Type, _Policy, _Layout, _MutexType>&>(*this));
+	}
+
+	// Intents for lock_all, they hide the intents of the lock owner, so lock_all returns the resource holders
+	[[nodiscard]] constexpr auto exclusive_intent(std::source_location srcl = std::source_location::current()) noexcept
+	{
+		return lock_intent<exclusive_holder_type, resource_owner_base<_Type, _Policy, _Layout, _MutexType>>(*this, std::move(srcl));
+	}
+
+	[[nodiscard]] constexpr auto concurrent_intent(std::source_location srcl = std::source_location::current()) const noexcept
+	{
+		return lock_intent<concurrent_holder_type, resource_owner_base<_Type, _Policy, _Layout, _MutexType>>(const_cast<resource_owner_base<_Type, _Policy, _Layout, _MutexType>&>(*this), std::move(srcl));
 	}
 
 private:
-	constexpr void _set_resource(_Type&& object)
+	explicit resource_owner_base(const std::shared_ptr<aligned_block>& block) noexcept
+		: base_type(std::shared_ptr<_MutexType>(block, &block->mutex))
+		, _resource(block, &block->resource)
 	{
-		_resource = std::make_shared<_Type>(std::forward<_Type>(object));
 	}
 
-	constexpr void _swap_resource(_Type& object) noexcept
+	constexpr void _set_resource(_Type&& object)
 	{
-		std::swap(object, *_resource);
+		// Only the separate layout allocates the resource alone, the others replace it in place
+		if constexpr (_Layout == owner_layout::separate)
+			_resource = std::make_shared<_Type>(std::forward<_Type>(object));
+		else
+			_get_resource_ref() = std::forward<_Type>(object);
 	}
 
-	[[nodiscard]] constexpr _Type _move_resource() noexcept
+	constexpr void _swap_resource(_Type& object) noexcept
 	{
-		return std::move(*_resource);
+		std::swap(object, _get_resource_ref());
 	}
 
-	[[nodiscard]] constexpr const std::shared_ptr<_Type> _get_resource() noexcept
+	[[nodiscard]] constexpr _Type _move_resource() noexcept
 	{
-		return _resource;
+		return std::move(_get_resource_ref());
 	}
 
-	[[nodiscard]] constexpr const std::shared_ptr<const _Type> _get_resource() const noexcept
+	// Holders access the resource through the reference, copying the shared pointer would write its reference count on every access
+	[[nodiscard]] constexpr _Type& _get_resource_ref() noexcept
 	{
-		return _resource;
+		if constexpr (_Layout == owner_layout::inline_storage)
+			return _resource;
+		else
+			return *_resource;
 	}
 
-	std::shared_ptr<_Type> _resource = std::make_shared<_Type>();
+	storage_type _resource;
 };
 
 /// <summary>
@@ -405,12 +524,30 @@ using resource_owner_debug = resource_owner_base<_Type, lock_tracking_enabled>;
 template <class _Type>
 using resource_owner_runtime = resource_owner_base<_Type, lock_tracking_runtime>;
 
+/// <summary>
+/// Contention profiling alias
+/// </summary>
+template <class _Type>
+using resource_owner_profiled = resource_owner_base<_Type, lock_tracking_profiled>;
+
+/// <summary>
+/// Lock order validation alias
+/// </summary>
+template <class _Type>
+using resource_owner_ordered = resource_owner_base<_Type, lock_tracking_ordered>;
+
 /// <summary>
 /// Build configuration alias
 /// </summary>
 #if defined(SYNCHRONIZATION_RUNTIME_TRACKING)
 template <class _Type>
 using resource_owner = resource_owner_runtime<_Type>;
+#elif defined(SYNCHRONIZATION_CONTENTION_PROFILING)
+template <class _Type>
+using resource_owner = resource_owner_profiled<_Type>;
+#elif defined(SYNCHRONIZATION_LOCK_ORDER_CHECKING)
+template <class _Type>
+using resource_owner = resource_owner_ordered<_Type>;
 #elif defined(NDEBUG) || defined(SYNCHRONIZATION_NO_TRACKING)
 template <class _Type>
 using resource_owner = resource_owner_release<_Type>;
@@ -419,6 +556,27 @@ template <class _Type>
 using resource_owner = resource_owner_debug<_Type>;
 #endif // _DEBUG
 
+/// <summary>
+/// Resource owner in the cache-aligned layout with the tracking policy of the build configuration,
+///	use it for arrays of owners accessed by different threads.
+/// </summary>
+template <class _Type, lock_tracking_policy _Policy = typename resource_owner<_Type>::policy_type>
+using cache_aligned_resource_owner = resource_owner_base<_Type, _Policy, owner_layout::cache_aligned>;
+
+/// <summary>
+/// Resource owner in the inline layout with the tracking policy of the build configuration,
+///	holders reach the resource without any indirection, use it for owners which are never moved.
+/// </summary>
+template <class _Type, lock_tracking_policy _Policy = typename resource_owner<_Type>::policy_type>
+using inline_resource_owner = resource_owner_base<_Type, _Policy, owner_layout::inline_storage>;
+
+/// <summary>
+/// Resource owner locked by distributed_shared_mutex with the tracking policy of the build configuration,
+///	concurrent access does not write a shared reader count, so readers scale with cores, but exclusive access is slower.
+/// </summary>
+template <class _Type, lock_tracking_policy _Policy = typename resource_owner<_Type>::policy_type>
+using read_mostly_resource_owner = resource_owner_base<_Type, _Policy, owner_layout::separate, distributed_shared_mutex>;
+
 /// Pre-defined conversions ///
 template <class... _Args>
 using list = resource_owner<std::list<_Args...>>;
@@ -462,6 +620,12 @@ using unordered_multiset = resource_owner<std::unordered_multiset<_Args...>>;
 template <class... _Args>
 using unordered_multimap = resource_owner<std::unordered_multimap<_Args...>>;
 
+template <class... _Args>
+using read_mostly_map = read_mostly_resource_owner<std::map<_Args...>>;
+
+template <class... _Args>
+using read_mostly_unordered_map = read_mostly_resource_owner<std::unordered_map<_Args...>>;
+
 template <class _Arg>
 using functor = resource_owner<std::function<_Arg>>;
 
@@ -0,0 +1,188 @@
+/*
+MIT License
+Copyright (c) 2025 Vit Janecek (mailto:janecekvit@outlook.com)
+
+distributed_shared_mutex.h
+Purpose:	header file contains reader-writer mutex with distributed reader counts,
+			readers on different cores do not write the same cache line, so read-mostly workloads scale with cores
+
+
+@author: Vit Janecek
+@mailto: <mailto:janecekvit@outlook.com>
+@version 1.00 16/10/2026
+*/
+
+#pragma once
+
+#include "synchronization/cache_line.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace janecekvit::synchronization
+{
+/// <summary>
+/// Big-reader lock, it satisfies the SharedMutex requirements, so it may be used with std::shared_lock, lock_owner_base and resource_owner_base.
+/// Every reader increments the counter of its own slot, each slot lives on a separate cache line,
+///	so concurrent readers running on different cores do not bounce one shared reader count.
+/// Slots are assigned to threads round-robin on their first shared lock and stay the same for the thread lifetime,
+///	unlock_shared must decrement the slot incremented by lock_shared even when the thread migrates to another core.
+/// The writer announces itself first, the new readers back off, and then it waits until all slots drain,
+///	so writers are not starved by the stream of readers, but every exclusive lock costs a pass over all slots.
+/// Use it for read-mostly resources, the default std::shared_mutex is cheaper when writes are frequent.
+/// </summary>
+/// <example>
+/// <code>
+///  synchronization::distributed_shared_mutex mutex;
+///  {
+///     std::shared_lock lock(mutex); // touches only the slot of the calling thread
+///  }
+///  {
+///     std::unique_lock lock(mutex); // waits until readers of all slots leave
+///  }
+/// </code>
+/// </example>
+class distributed_shared_mutex
+{
+public:
+	/// <summary>
+	/// One slot per hardware thread rounded up to the power of two.
+	/// </summary>
+	distributed_shared_mutex()
+		: distributed_shared_mutex(std::max<size_t>(std::thread::hardware_concurrency(), 1))
+	{
+	}
+
+	/// <exception cref="std::invalid_argument">When the slot count is zero.</exception>
+	explicit distributed_shared_mutex(size_t slots)
+		: _mask(_slot_mask(slots))
+		, _slots(std::make_unique<slot[]>(_mask + 1))
+	{
+	}
+
+	distributed_shared_mutex(const distributed_shared_mutex&) = delete;
+	distributed_shared_mutex& operator=(const distributed_shared_mutex&) = delete;
+
+	void lock()
+	{
+		_writer_mutex.lock();
+		_writer.store(true, std::memory_order_seq_cst);
+
+		for (size_t i = 0; i <= _mask; i++)
+		{
+			// The last reader leaving the slot notifies the waiting writer
+			auto& readers = _slots[i].readers;
+			for (auto count = readers.load(std::memory_order_seq_cst); count != 0; count = readers.load(std::memory_order_seq_cst))
+				readers.wait(count, std::memory_order_seq_cst);
+		}
+	}
+
+	[[nodiscard]] bool try_lock()
+	{
+		if (!_writer_mutex.try_lock())
+			return false;
+
+		_writer.store(true, std::memory_order_seq_cst);
+		for (size_t i = 0; i <= _mask; i++)
+		{
+			if (_slots[i].readers.load(std::memory_order_seq_cst) != 0)
+			{
+				unlock();
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void unlock()
+	{
+		_writer.store(false, std::memory_order_seq_cst);
+		_writer.notify_all();
+		_writer_mutex.unlock();
+	}
+
+	void lock_shared()
+	{
+		auto& readers = _thread_slot().readers;
+		for (;;)
+		{
+			// Both the reader and the writer publish themselves before they look at the other side,
+			//	the sequential consistency guarantees that at least one of them sees the other
+			readers.fetch_add(1, std::memory_order_seq_cst);
+			if (!_writer.load(std::memory_order_seq_cst))
+				return;
+
+			_leave(readers);
+			_writer.wait(true, std::memory_order_seq_cst);
+		}
+	}
+
+	[[nodiscard]] bool try_lock_shared()
+	{
+		auto& readers = _thread_slot().readers;
+		readers.fetch_add(1, std::memory_order_seq_cst);
+		if (!_writer.load(std::memory_order_seq_cst))
+			return true;
+
+		_leave(readers);
+		return false;
+	}
+
+	void unlock_shared()
+	{
+		_leave(_thread_slot().readers);
+	}
+
+	[[nodiscard]] size_t slot_count() const noexcept
+	{
+		return _mask + 1;
+	}
+
+private:
+	struct alignas(cache_line_size) slot
+	{
+		std::atomic<uint32_t> readers = 0;
+	};
+
+	[[nodiscard]] static size_t _slot_mask(size_t slots)
+	{
+		if (slots == 0)
+			throw std::invalid_argument("distributed_shared_mutex requires at least one slot!");
+
+		return std::bit_ceil(slots) - 1;
+	}
+
+	[[nodiscard]] static size_t _thread_index() noexcept
+	{
+		static std::atomic<size_t> next_index = 0;
+		thread_local const size_t index = next_index.fetch_add(1, std::memory_order_relaxed);
+		return index;
+	}
+
+	[[nodiscard]] slot& _thread_slot() const noexcept
+	{
+		return _slots[_thread_index() & _mask];
+	}
+
+	void _leave(std::atomic<uint32_t>& readers) noexcept
+	{
+		if (readers.fetch_sub(1, std::memory_order_seq_cst) == 1 && _writer.load(std::memory_order_seq_cst))
+			readers.notify_all();
+	}
+
+private:
+	const size_t _mask;
+	const std::unique_ptr<slot[]> _slots;
+	alignas(cache_line_size) std::atomic<bool> _writer = false;
+	std::mutex _writer_mutex;
+};
+
+} // namespace janecekvit::synchronization
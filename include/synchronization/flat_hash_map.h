@@ -0,0 +1,660 @@
+/*
+MIT License
+Copyright (c) 2025 Vit Janecek (mailto:janecekvit@outlook.com)
+
+flat_hash_map.h
+Purpose:	header file contains open-addressing concurrent hash map with lock-free optimistic reads,
+			slots are stored inline in groups with control bytes, so the lookup usually touches one cache line
+
+
+@author: Vit Janecek
+@mailto: <mailto:janecekvit@outlook.com>
+@version 1.00 16/10/2026
+*/
+
+#pragma once
+#include "synchronization/cache_line.h"
+#include "synchronization/distributed_shared_mutex.h"
+#include "synchronization/reclamation.h"
+#include "synchronization/wait_policy.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <shared_mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace janecekvit::synchronization::concurrent
+{
+namespace details
+{
+/// <summary>
+/// Matching of eight control bytes packed in one word at once (SIMD within a register).
+/// Control byte is empty (0x80), deleted (0xFE) or full, the full byte holds seven bits of the hash.
+/// Every matching byte sets its most significant bit in the returned mask.
+/// </summary>
+struct control_word
+{
+	static constexpr uint8_t empty = 0x80;
+	static constexpr uint8_t deleted = 0xFE;
+	static constexpr uint64_t lsbs = 0x0101010101010101ull;
+	static constexpr uint64_t msbs = 0x8080808080808080ull;
+	static constexpr uint64_t all_empty = lsbs * empty;
+
+	// It may report a false positive next to the real match, the key is always compared afterwards
+	[[nodiscard]] static constexpr uint64_t match(uint64_t control, uint8_t hash) noexcept
+	{
+		const auto x = control ^ (lsbs * hash);
+		return (x - lsbs) & ~x & msbs;
+	}
+
+	[[nodiscard]] static constexpr uint64_t match_empty(uint64_t control) noexcept
+	{
+		return control & ~(control << 6) & msbs;
+	}
+
+	[[nodiscard]] static constexpr uint64_t match_empty_or_deleted(uint64_t control) noexcept
+	{
+		return control & ~(control << 7) & msbs;
+	}
+
+	[[nodiscard]] static constexpr uint64_t match_full(uint64_t control) noexcept
+	{
+		return ~control & msbs;
+	}
+
+	[[nodiscard]] static constexpr size_t first(uint64_t mask) noexcept
+	{
+		return static_cast<size_t>(std::countr_zero(mask)) / 8;
+	}
+
+	[[nodiscard]] static constexpr uint8_t get(uint64_t control, size_t index) noexcept
+	{
+		return static_cast<uint8_t>(control >> (index * 8));
+	}
+
+	[[nodiscard]] static constexpr uint64_t set(uint64_t control, size_t index, uint8_t value) noexcept
+	{
+		const auto shift = index * 8;
+		return (control & ~(uint64_t(0xFF) << shift)) | (uint64_t(value) << shift);
+	}
+};
+} // namespace details
+
+/// <summary>
+/// Flat hash map in the style of Swiss tables, slots are grouped by eight with one control word per group.
+/// Lookups are lock-free: the reader copies the matching slots and validates the group version (seqlock),
+///	it retries only when a writer modified the same group meanwhile.
+/// Writers of the keys with the same home group are serialized by the key lock of that group,
+///	the slot itself is written under the seqlock of its group, so readers of other groups are never disturbed.
+/// Key and value must be trivially copyable, the reader copies them while a writer may be overwriting them,
+///	they are read and written by relaxed atomic words, so the torn copy is detected by the version and never used.
+/// The table grows when seven eighths of the slots are used, the grow waits for the running writers (distributed_shared_mutex),
+///	readers pin the global epoch_domain instead, so the replaced table is retired and deleted once no reader can be reading it.
+/// </summary>
+/// <example>
+/// <code>
+///  concurrent::flat_hash_map<uint64_t, session_info> sessions;
+///
+///  sessions.insert(id, session_info{});
+///  auto info = sessions.find(id); // std::optional<session_info>, no lock taken
+///  sessions.visit(id, [](session_info& value)
+///  {
+///     value.hits++; // readers of the group retry until the update is done
+///  });
+/// </code>
+/// </example>
+template <class _Key, class _Value, class _Hash = std::hash<_Key>, class _KeyEqual = std::equal_to<_Key>>
+	requires std::is_trivially_copyable_v<_Key> && std::is_trivially_copyable_v<_Value>
+class flat_hash_map
+{
+public:
+	using key_type = _Key;
+	using mapped_type = _Value;
+	using hasher = _Hash;
+	using key_equal = _KeyEqual;
+
+	static constexpr size_t group_size = 8;
+
+public:
+	/// <summary>
+	/// The capacity is rounded up to the power of two groups.
+	/// </summary>
+	explicit flat_hash_map(size_t capacity = 64, const _Hash& hash = _Hash(), const _KeyEqual& equal = _KeyEqual())
+		: _hash(hash)
+		, _equal(equal)
+		, _current(std::make_unique<table>(std::bit_ceil(std::max<size_t>((capacity + group_size - 1) / group_size, 1))))
+		, _table(_current.get())
+	{
+	}
+
+	flat_hash_map(const flat_hash_map&) = delete;
+	flat_hash_map& operator=(const flat_hash_map&) = delete;
+
+	/// <summary>
+	/// Copy of the value, std::nullopt when the key is not present. It does not take any lock.
+	/// </summary>
+	[[nodiscard]] std::optional<_Value> find(const _Key& key) const
+	{
+		auto guard = epoch_domain::global().pin();
+		if (auto item = _find(*_table.load(std::memory_order_acquire), key, _hash_of(key)))
+			return item->value;
+
+		return std::nullopt;
+	}
+
+	[[nodiscard]] bool contains(const _Key& key) const
+	{
+		auto guard = epoch_domain::global().pin();
+		return _find(*_table.load(std::memory_order_acquire), key, _hash_of(key)).has_value();
+	}
+
+	/// <summary>
+	/// Inserts the value when the key is not present.
+	/// </summary>
+	/// <returns>True when the value was inserted.</returns>
+	bool insert(const _Key& key, const _Value& value)
+	{
+		return _insert<false>(key, value);
+	}
+
+	/// <returns>True when the value was inserted, false when the existing value was assigned.</returns>
+	bool insert_or_assign(const _Key& key, const _Value& value)
+	{
+		return _insert<true>(key, value);
+	}
+
+	/// <returns>Number of erased values, zero or one.</returns>
+	size_t erase(const _Key& key)
+	{
+		const auto hash = _hash_of(key);
+		std::shared_lock resize(_resize_mutex);
+		auto& current = *_table.load(std::memory_order_acquire);
+		key_lock guard(current.groups[_home(current, hash)]);
+
+		auto position = _locate(current, key, hash);
+		if (!position)
+			return 0;
+
+		auto& target = current.groups[position->group];
+		group_lock lock(target);
+		auto control = target.control.load(std::memory_order_relaxed);
+
+		// The group with an empty slot never was full, so no probe sequence continues behind it and the slot may become empty again
+		const bool reuse = details::control_word::match_empty(control) != 0;
+		target.control.store(details::control_word::set(control, position->index, reuse ? details::control_word::empty : details::control_word::deleted), std::memory_order_relaxed);
+		if (reuse)
+			current.occupied.fetch_sub(1, std::memory_order_relaxed);
+
+		_size.fetch_sub(1, std::memory_order_relaxed);
+		return 1;
+	}
+
+	/// <summary>
+	/// Calls fn(value&) under the seqlock of the key group, readers of the group retry until fn returns, so keep it short.
+	/// </summary>
+	/// <returns>False when the key is not present and fn was not called.</returns>
+	template <class _Fn>
+	bool visit(const _Key& key, _Fn&& fn)
+	{
+		const auto hash = _hash_of(key);
+		std::shared_lock resize(_resize_mutex);
+		auto& current = *_table.load(std::memory_order_acquire);
+		key_lock guard(current.groups[_home(current, hash)]);
+
+		auto position = _locate(current, key, hash);
+		if (!position)
+			return false;
+
+		auto& target = current.groups[position->group];
+		group_lock lock(target);
+		auto item = _load(target.slots[position->index]);
+		std::invoke(std::forward<_Fn>(fn), item.value);
+		_store(target.slots[position->index], item);
+		return true;
+	}
+
+	/// <summary>
+	/// Calls fn(const value&) with the copy of the value, it does not take any lock.
+	/// </summary>
+	/// <returns>False when the key is not present and fn was not called.</returns>
+	template <class _Fn>
+	bool visit(const _Key& key, _Fn&& fn) const
+	{
+		std::optional<entry> item;
+		{
+			auto guard = epoch_domain::global().pin();
+			item = _find(*_table.load(std::memory_order_acquire), key, _hash_of(key));
+		}
+
+		if (!item)
+			return false;
+
+		std::invoke(std::forward<_Fn>(fn), std::as_const(item->value));
+		return true;
+	}
+
+	/// <summary>
+	/// Calls fn(const key&, const value&) for copies of all values, every group is copied consistently, but the whole map is not a snapshot.
+	/// </summary>
+	template <class _Fn>
+	void visit_all(_Fn&& fn) const
+	{
+		auto guard = epoch_domain::global().pin();
+		const auto& current = *_table.load(std::memory_order_acquire);
+		for (size_t g = 0; g < current.group_count(); g++)
+		{
+			auto& source = current.groups[g];
+			std::array<std::array<uint64_t, entry_words>, group_size> copies;
+			uint64_t full = 0;
+			for (;;)
+			{
+				const auto version = _read_begin(source);
+				full = details::control_word::match_full(source.control.load(std::memory_order_relaxed));
+				for (auto mask = full; mask != 0; mask &= mask - 1)
+				{
+					const auto index = details::control_word::first(mask);
+					for (size_t w = 0; w < entry_words; w++)
+						copies[index][w] = source.slots[index][w].load(std::memory_order_relaxed);
+				}
+
+				if (_read_end(source, version))
+					break;
+			}
+
+			for (auto mask = full; mask != 0; mask &= mask - 1)
+			{
+				const auto item = _decode(copies[details::control_word::first(mask)]);
+				std::invoke(fn, std::as_const(item.key), std::as_const(item.value));
+			}
+		}
+	}
+
+	void clear()
+	{
+		std::unique_lock resize(_resize_mutex);
+		_publish(std::make_unique<table>(_current->group_count()));
+		_size.store(0, std::memory_order_relaxed);
+	}
+
+	/// <summary>
+	/// Number of values, it is exact only when no other thread modifies the map.
+	/// </summary>
+	[[nodiscard]] size_t size() const noexcept
+	{
+		return _size.load(std::memory_order_relaxed);
+	}
+
+	[[nodiscard]] bool empty() const noexcept
+	{
+		return size() == 0;
+	}
+
+	[[nodiscard]] size_t capacity() const
+	{
+		auto guard = epoch_domain::global().pin();
+		return _table.load(std::memory_order_acquire)->group_count() * group_size;
+	}
+
+private:
+	struct entry
+	{
+		_Key key;
+		_Value value;
+	};
+
+	static constexpr size_t entry_words = (sizeof(entry) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+	using slot = std::array<std::atomic<uint64_t>, entry_words>;
+
+	/// <summary>
+	/// Odd version means the writer is modifying the group, the version is also the writer lock of the group.
+	/// The key lock serializes writers of the keys whose probe sequence starts in this group.
+	/// </summary>
+	struct alignas(cache_line_size) group
+	{
+		std::atomic<uint64_t> version = 0;
+		std::atomic<uint64_t> control = details::control_word::all_empty;
+		std::atomic_flag key_locked;
+		std::array<slot, group_size> slots{};
+	};
+
+	struct table
+	{
+		explicit table(size_t count)
+			: mask(count - 1)
+			, groups(std::make_unique<group[]>(count))
+		{
+		}
+
+		[[nodiscard]] size_t group_count() const noexcept
+		{
+			return mask + 1;
+		}
+
+		[[nodiscard]] size_t max_load() const noexcept
+		{
+			return group_count() * group_size * 7 / 8;
+		}
+
+		const size_t mask;
+		const std::unique_ptr<group[]> groups;
+
+		// Full and deleted slots, the table grows before they would fill it
+		alignas(cache_line_size) std::atomic<size_t> occupied = 0;
+	};
+
+	struct slot_location
+	{
+		size_t group;
+		size_t index;
+	};
+
+	class group_lock
+	{
+	public:
+		explicit group_lock(group& target) noexcept
+			: _group(target)
+		{
+			auto version = _group.version.load(std::memory_order_relaxed);
+			for (;;)
+			{
+				if ((version & 1) == 0 && _group.version.compare_exchange_weak(version, version + 1, std::memory_order_acquire, std::memory_order_relaxed))
+					break;
+
+				synchronization::details::cpu_relax();
+				version = _group.version.load(std::memory_order_relaxed);
+			}
+
+			// Slot stores must not become visible before the odd version
+			std::atomic_thread_fence(std::memory_order_release);
+		}
+
+		~group_lock()
+		{
+			_group.version.fetch_add(1, std::memory_order_release);
+		}
+
+		group_lock(const group_lock&) = delete;
+		group_lock& operator=(const group_lock&) = delete;
+
+	private:
+		group& _group;
+	};
+
+	class key_lock
+	{
+	public:
+		explicit key_lock(group& home) noexcept
+			: _home(home)
+		{
+			while (_home.key_locked.test_and_set(std::memory_order_acquire))
+				_home.key_locked.wait(true, std::memory_order_relaxed);
+		}
+
+		~key_lock()
+		{
+			_home.key_locked.clear(std::memory_order_release);
+			_home.key_locked.notify_one();
+		}
+
+		key_lock(const key_lock&) = delete;
+		key_lock& operator=(const key_lock&) = delete;
+
+	private:
+		group& _home;
+	};
+
+	template <bool _Assign>
+	bool _insert(const _Key& key, const _Value& value)
+	{
+		const auto hash = _hash_of(key);
+		for (;;)
+		{
+			table* full = nullptr;
+			{
+				std::shared_lock resize(_resize_mutex);
+				auto& current = *_table.load(std::memory_order_acquire);
+				key_lock guard(current.groups[_home(current, hash)]);
+
+				if (auto existing = _locate(current, key, hash))
+				{
+					if constexpr (_Assign)
+					{
+						auto& target = current.groups[existing->group];
+						group_lock lock(target);
+						_store(target.slots[existing->index], entry{ key, value });
+					}
+
+					return false;
+				}
+
+				if (current.occupied.fetch_add(1, std::memory_order_relaxed) < current.max_load())
+				{
+					_place<true>(current, hash, entry{ key, value });
+					_size.fetch_add(1, std::memory_order_relaxed);
+					return true;
+				}
+
+				current.occupied.fetch_sub(1, std::memory_order_relaxed);
+				full = &current;
+			}
+
+			_grow(full);
+		}
+	}
+
+	/// <summary>
+	/// Stores the entry to the first empty or deleted slot of the probe sequence, concurrent places lock the groups one at a time.
+	/// </summary>
+	template <bool _Concurrent>
+	void _place(table& current, uint64_t hash, const entry& item)
+	{
+		for (size_t g = _home(current, hash), step = 0;; g = (g + ++step) & current.mask)
+		{
+			auto& target = current.groups[g];
+			std::optional<group_lock> lock;
+			if constexpr (_Concurrent)
+				lock.emplace(target);
+
+			const auto control = target.control.load(std::memory_order_relaxed);
+			const auto free = details::control_word::match_empty_or_deleted(control);
+			if (free == 0)
+				continue;
+
+			const auto index = details::control_word::first(free);
+			if (details::control_word::get(control, index) == details::control_word::deleted)
+				current.occupied.fetch_sub(1, std::memory_order_relaxed);
+
+			_store(target.slots[index], item);
+			target.control.store(details::control_word::set(control, index, _control_of(hash)), std::memory_order_relaxed);
+			return;
+		}
+	}
+
+	/// <summary>
+	/// Location of the key, the caller holds the key lock, so the location cannot change until it is released.
+	/// </summary>
+	[[nodiscard]] std::optional<slot_location> _locate(const table& current, const _Key& key, uint64_t hash) const
+	{
+		std::optional<slot_location> result;
+		_probe(current, key, hash, [&result](size_t g, size_t index, const entry&)
+			{
+				result = slot_location{ g, index };
+			});
+
+		return result;
+	}
+
+	[[nodiscard]] std::optional<entry> _find(const table& current, const _Key& key, uint64_t hash) const
+	{
+		std::optional<entry> result;
+		_probe(current, key, hash, [&result](size_t, size_t, const entry& item)
+			{
+				result = item;
+			});
+
+		return result;
+	}
+
+	/// <summary>
+	/// Walks the probe sequence with optimistic reads and calls found(group, index, entry) for the slot of the key.
+	/// The sequence ends in the group with an empty slot, the key would have been stored there or sooner.
+	/// </summary>
+	template <class _Found>
+	void _probe(const table& current, const _Key& key, uint64_t hash, _Found&& found) const
+	{
+		const auto control_hash = _control_of(hash);
+		for (size_t g = _home(current, hash), step = 0; step < current.group_count(); g = (g + ++step) & current.mask)
+		{
+			const auto& source = current.groups[g];
+			bool has_empty = false;
+			for (bool retry = true; retry;)
+			{
+				const auto version = _read_begin(source);
+				const auto control = source.control.load(std::memory_order_relaxed);
+				has_empty = details::control_word::match_empty(control) != 0;
+				retry = false;
+
+				for (auto mask = details::control_word::match(control, control_hash); mask != 0; mask &= mask - 1)
+				{
+					// False positives of the word match may point to an empty slot, whose stale key must not be compared
+					const auto index = details::control_word::first(mask);
+					if (details::control_word::get(control, index) != control_hash)
+						continue;
+
+					const auto item = _load(source.slots[index]);
+					if (!_read_end(source, version))
+					{
+						retry = true;
+						break;
+					}
+
+					if (_equal(item.key, key))
+					{
+						found(g, index, item);
+						return;
+					}
+				}
+
+				if (!retry && !_read_end(source, version))
+					retry = true;
+			}
+
+			if (has_empty)
+				return;
+		}
+	}
+
+	[[nodiscard]] static uint64_t _read_begin(const group& source) noexcept
+	{
+		for (;;)
+		{
+			const auto version = source.version.load(std::memory_order_acquire);
+			if ((version & 1) == 0)
+				return version;
+
+			synchronization::details::cpu_relax();
+		}
+	}
+
+	[[nodiscard]] static bool _read_end(const group& source, uint64_t version) noexcept
+	{
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return source.version.load(std::memory_order_relaxed) == version;
+	}
+
+	void _grow(const table* full)
+	{
+		std::unique_lock resize(_resize_mutex);
+		if (_table.load(std::memory_order_relaxed) != full)
+			return;
+
+		// Deleted slots count to the load too, the table with few values is only rehashed to drop them
+		const auto size = _size.load(std::memory_order_relaxed);
+		const auto groups = size * 2 >= full->max_load() ? full->group_count() * 2 : full->group_count();
+
+		auto next = std::make_unique<table>(groups);
+		for (size_t g = 0; g < full->group_count(); g++)
+		{
+			const auto& source = full->groups[g];
+			for (auto mask = details::control_word::match_full(source.control.load(std::memory_order_relaxed)); mask != 0; mask &= mask - 1)
+			{
+				const auto item = _load(source.slots[details::control_word::first(mask)]);
+				_place<false>(*next, _hash_of(item.key), item);
+			}
+		}
+
+		next->occupied.store(size, std::memory_order_relaxed);
+		_publish(std::move(next));
+	}
+
+	void _publish(std::unique_ptr<table> next)
+	{
+		_table.store(next.get(), std::memory_order_release);
+		epoch_domain::global().retire(_current.release());
+		_current = std::move(next);
+	}
+
+	[[nodiscard]] uint64_t _hash_of(const _Key& key) const
+	{
+		// Fibonacci hashing and folding of the high half spread also the identity hashes of integers
+		auto hash = static_cast<uint64_t>(_hash(key)) * 0x9E3779B97F4A7C15ull;
+		return hash ^ (hash >> 32);
+	}
+
+	[[nodiscard]] static size_t _home(const table& current, uint64_t hash) noexcept
+	{
+		return static_cast<size_t>(hash >> 7) & current.mask;
+	}
+
+	[[nodiscard]] static uint8_t _control_of(uint64_t hash) noexcept
+	{
+		return static_cast<uint8_t>(hash & 0x7F);
+	}
+
+	static void _store(slot& target, const entry& item) noexcept
+	{
+		std::array<uint64_t, entry_words> words{};
+		std::memcpy(words.data(), &item, sizeof(entry));
+		for (size_t w = 0; w < entry_words; w++)
+			target[w].store(words[w], std::memory_order_relaxed);
+	}
+
+	[[nodiscard]] static entry _load(const slot& source) noexcept
+	{
+		std::array<uint64_t, entry_words> words;
+		for (size_t w = 0; w < entry_words; w++)
+			words[w] = source[w].load(std::memory_order_relaxed);
+
+		return _decode(words);
+	}
+
+	[[nodiscard]] static entry _decode(const std::array<uint64_t, entry_words>& words) noexcept
+	{
+		// The copy creates the trivially copyable entry implicitly, it does not have to be default constructible
+		alignas(entry) std::byte storage[sizeof(entry)];
+		std::memcpy(storage, words.data(), sizeof(entry));
+		return *std::launder(reinterpret_cast<entry*>(storage));
+	}
+
+private:
+	[[no_unique_address]] const _Hash _hash;
+	[[no_unique_address]] const _KeyEqual _equal;
+	distributed_shared_mutex _resize_mutex;
+	std::unique_ptr<table> _current;
+	std::atomic<table*> _table;
+	alignas(cache_line_size) std::atomic<size_t> _size = 0;
+};
+
+} // namespace janecekvit::synchronization::concurrent
@@ -0,0 +1,404 @@
+/*
+MIT License
+Copyright (c) 2025 Vit Janecek (mailto:janecekvit@outlook.com)
+
+lock_order.h
+Purpose:	header file contains the lock order validator,
+			it records in which order threads acquire lock owners and reports cycles which may end in a deadlock
+
+
+@author: Vit Janecek
+@mailto: <mailto:janecekvit@outlook.com>
+@version 1.00 16/10/2026
+*/
+
+#pragma once
+
+#include "synchronization/lock_record.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <source_location>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace janecekvit::synchronization
+{
+/// <summary>
+/// One edge of the lock order, the thread acquired AcquiredOwner at AcquiredAt while it held HeldOwner acquired at HeldAt.
+/// </summary>
+struct lock_order_edge
+{
+	const void* HeldOwner = nullptr;
+	const void* AcquiredOwner = nullptr;
+	std::source_location HeldAt;
+	std::source_location AcquiredAt;
+	std::thread::id ThreadId;
+};
+
+/// <summary>
+/// Cycle in the lock order, the first edge has just been taken and closes the cycle of the edges recorded before.
+/// Threads which take the edges of the cycle at the same time deadlock.
+/// </summary>
+struct lock_order_violation
+{
+	std::vector<lock_order_edge> Cycle;
+};
+
+using lock_order_callback = std::function<void(const lock_order_violation& violation)>;
+
+namespace details
+{
+/// <summary>
+/// Global graph of the lock order between lock owners, lockdep-style.
+/// The thread keeps the stack of owners it holds, before it blocks on the next owner every held owner gets the edge to it.
+/// Edges seen before are found in the lock-free cache without any write, only the first occurrence of the edge takes the mutex,
+///	stores the edge to the graph and searches the path back, which would close the cycle.
+/// The cache probes a bounded group of slots and the newest edge replaces an older one when the group is full,
+///	so the lookup stays cheap once the cache is full and an evicted edge only costs one pass through the slow path.
+/// Owners get unique identifiers, so the edges of the destroyed owners never match the new ones,
+///	the graph keeps the edges in both directions, so forgetting the owner costs its own edges only.
+/// </summary>
+class lock_order_graph
+{
+public:
+	[[nodiscard]] static uint32_t register_owner(const void* owner)
+	{
+		auto& graph = _instance();
+		std::unique_lock lock(graph._mutex);
+		const auto id = ++graph._last_id;
+		graph._owners.emplace(id, owner);
+		return id;
+	}
+
+	static void forget_owner(uint32_t id)
+	{
+		auto& graph = _instance();
+		std::unique_lock lock(graph._mutex);
+		graph._owners.erase(id);
+
+		// Removed cache entries only send the lookups to the slow path
+		if (auto targets = graph._edges.find(id); targets != graph._edges.end())
+		{
+			for (const auto& [to, info] : targets->second)
+			{
+				graph._uncache_edge(_key(id, to));
+				graph._sources[to].erase(id);
+			}
+
+			graph._edges.erase(targets);
+		}
+
+		if (auto sources = graph._sources.find(id); sources != graph._sources.end())
+		{
+			for (const auto from : sources->second)
+			{
+				graph._uncache_edge(_key(from, id));
+				graph._edges[from].erase(id);
+			}
+
+			graph._sources.erase(sources);
+		}
+	}
+
+	/// <summary>
+	/// Validates the order before the thread blocks on the owner.
+	/// </summary>
+	static void check(uint32_t id, const std::source_location& location)
+	{
+		const auto& stack = _held();
+		for (size_t i = 0; i < stack.size; i++)
+		{
+			const auto& held = stack.entries[i];
+			if (held.id != id && !_instance()._cached(_key(held.id, id)))
+				_instance()._add_edge(held, id, call_site_table::intern(location));
+		}
+	}
+
+	static void acquired(uint32_t id, const std::source_location* location) noexcept
+	{
+		auto& stack = _held();
+		if (stack.size < stack.entries.size())
+			stack.entries[stack.size] = held_owner{ id, location };
+
+		stack.size++;
+	}
+
+	static void released(uint32_t id) noexcept
+	{
+		auto& stack = _held();
+		const auto recorded = std::min(stack.size, stack.entries.size());
+		for (size_t i = recorded; i > 0; i--)
+		{
+			if (stack.entries[i - 1].id != id)
+				continue;
+
+			std::copy(stack.entries.begin() + i, stack.entries.begin() + recorded, stack.entries.begin() + i - 1);
+			break;
+		}
+
+		if (stack.size > 0)
+			stack.size--;
+	}
+
+	static void set_callback(lock_order_callback&& callback)
+	{
+		std::unique_lock lock(_instance()._mutex);
+		_instance()._callback = std::move(callback);
+	}
+
+	[[nodiscard]] static std::vector<lock_order_violation> violations()
+	{
+		std::unique_lock lock(_instance()._mutex);
+		return _instance()._violations;
+	}
+
+	static void clear_violations()
+	{
+		std::unique_lock lock(_instance()._mutex);
+		_instance()._violations.clear();
+	}
+
+private:
+	static constexpr size_t cache_size = 4096;
+	static constexpr size_t cache_probe = 16;
+	static constexpr size_t held_capacity = 32;
+
+	struct held_owner
+	{
+		uint32_t id = 0;
+		const std::source_location* location = nullptr;
+	};
+
+	// Owners held by the thread, the deeper ones are counted but not validated
+	struct held_stack
+	{
+		std::array<held_owner, held_capacity> entries;
+		size_t size = 0;
+	};
+
+	struct edge
+	{
+		const std::source_location* held_at;
+		const std::source_location* acquired_at;
+		thread_table::key_type thread;
+	};
+
+	[[nodiscard]] static lock_order_graph& _instance() noexcept
+	{
+		static lock_order_graph graph;
+		return graph;
+	}
+
+	[[nodiscard]] static held_stack& _held() noexcept
+	{
+		thread_local held_stack stack;
+		return stack;
+	}
+
+	[[nodiscard]] static uint64_t _key(uint32_t from, uint32_t to) noexcept
+	{
+		return (static_cast<uint64_t>(from) << 32) | to;
+	}
+
+	[[nodiscard]] static size_t _slot(uint64_t key) noexcept
+	{
+		return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 52) % cache_size;
+	}
+
+	[[nodiscard]] bool _cached(uint64_t key) const noexcept
+	{
+		for (size_t i = 0, slot = _slot(key); i < cache_probe; i++, slot = (slot + 1) % cache_size)
+		{
+			const auto current = _cache[slot].load(std::memory_order_acquire);
+			if (current == key)
+				return true;
+
+			if (current == 0)
+				return false;
+		}
+
+		return false;
+	}
+
+	// Called under the mutex, the edge evicted from the full group only sends its lookups to the slow path
+	void _cache_edge(uint64_t key) noexcept
+	{
+		for (size_t i = 0, slot = _slot(key); i < cache_probe; i++, slot = (slot + 1) % cache_size)
+		{
+			const auto current = _cache[slot].load(std::memory_order_relaxed);
+			if (current == key)
+				return;
+
+			if (current == 0)
+			{
+				_cache[slot].store(key, std::memory_order_release);
+				return;
+			}
+		}
+
+		_cache[_slot(key)].store(key, std::memory_order_release);
+	}
+
+	// Called under the mutex
+	void _uncache_edge(uint64_t key) noexcept
+	{
+		for (size_t i = 0, slot = _slot(key); i < cache_probe; i++, slot = (slot + 1) % cache_size)
+		{
+			if (_cache[slot].load(std::memory_order_relaxed) == key)
+				_cache[slot].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	void _add_edge(const held_owner& held, uint32_t id, const std::source_location* location)
+	{
+		std::unique_lock lock(_mutex);
+		auto [it, inserted] = _edges[held.id].try_emplace(id, edge{ held.location, location, thread_table::key() });
+		_cache_edge(_key(held.id, id));
+		if (!inserted)
+			return;
+
+		_sources[id].insert(held.id);
+
+		auto path = _find_path(id, held.id);
+		if (path.empty())
+			return;
+
+		lock_order_violation violation;
+		violation.Cycle.push_back(_to_edge(held.id, id, it->second));
+		for (size_t i = 0; i + 1 < path.size(); i++)
+			violation.Cycle.push_back(_to_edge(path[i], path[i + 1], _edges[path[i]].at(path[i + 1])));
+
+		_violations.push_back(violation);
+		if (_callback)
+			_callback(violation);
+	}
+
+	// Breadth-first search of the owners from the first to the last one, returns the owners on the path
+	[[nodiscard]] std::vector<uint32_t> _find_path(uint32_t first, uint32_t last) const
+	{
+		std::unordered_map<uint32_t, uint32_t> parents{ { first, first } };
+		std::vector<uint32_t> queue{ first };
+		for (size_t i = 0; i < queue.size(); i++)
+		{
+			const auto current = queue[i];
+			if (current == last)
+			{
+				std::vector<uint32_t> path{ last };
+				while (path.back() != first)
+					path.push_back(parents.at(path.back()));
+
+				std::reverse(path.begin(), path.end());
+				return path;
+			}
+
+			const auto targets = _edges.find(current);
+			if (targets == _edges.end())
+				continue;
+
+			for (const auto& [next, info] : targets->second)
+			{
+				if (parents.try_emplace(next, current).second)
+					queue.push_back(next);
+			}
+		}
+
+		return {};
+	}
+
+	[[nodiscard]] lock_order_edge _to_edge(uint32_t from, uint32_t to, const edge& info) const
+	{
+		const auto owner = [this](uint32_t id)
+		{
+			const auto it = _owners.find(id);
+			return it != _owners.end() ? it->second : nullptr;
+		};
+
+		return lock_order_edge{
+			owner(from),
+			owner(to),
+			info.held_at ? *info.held_at : std::source_location(),
+			info.acquired_at ? *info.acquired_at : std::source_location(),
+			thread_table::id(info.thread)
+		};
+	}
+
+private:
+	std::array<std::atomic<uint64_t>, cache_size> _cache = {};
+
+	std::mutex _mutex;
+	uint32_t _last_id = 0;
+	std::unordered_map<uint32_t, const void*> _owners;
+	std::unordered_map<uint32_t, std::unordered_map<uint32_t, edge>> _edges;
+	std::unordered_map<uint32_t, std::unordered_set<uint32_t>> _sources;
+	std::vector<lock_order_violation> _violations;
+	lock_order_callback _callback;
+};
+
+/// <summary>
+/// Identity of one owner in the lock order graph, its edges are removed together with the owner.
+/// </summary>
+class lock_order_node
+{
+public:
+	explicit lock_order_node(const void* owner)
+		: _id(lock_order_graph::register_owner(owner))
+	{
+	}
+
+	lock_order_node(const lock_order_node&) = delete;
+	lock_order_node& operator=(const lock_order_node&) = delete;
+
+	~lock_order_node()
+	{
+		lock_order_graph::forget_owner(_id);
+	}
+
+	[[nodiscard]] uint32_t id() const noexcept
+	{
+		return _id;
+	}
+
+private:
+	const uint32_t _id;
+};
+} // namespace details
+
+/// <summary>
+/// Reports of the lock order validator of the owners with the lock_tracking_ordered policy.
+/// Every new cycle is stored and passed to the callback, the callback runs under the mutex of the validator, so it must not lock ordered owners.
+/// Holders are expected to be released by the thread which acquired them.
+/// </summary>
+class lock_order_checker
+{
+public:
+	static void set_violation_callback(lock_order_callback&& callback)
+	{
+		details::lock_order_graph::set_callback(std::move(callback));
+	}
+
+	static void clear_violation_callback()
+	{
+		details::lock_order_graph::set_callback(nullptr);
+	}
+
+	[[nodiscard]] static std::vector<lock_order_violation> get_violations()
+	{
+		return details::lock_order_graph::violations();
+	}
+
+	static void clear_violations()
+	{
+		details::lock_order_graph::clear_violations();
+	}
+};
+
+} // namespace janecekvit::synchronization
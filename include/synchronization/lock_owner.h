@@ -16,13 +16,20 @@ Purpose:	header file contains set of thread-safe concurrent containers,
 #pragma once
 #include "compatibility/compiler_support.h"
 #include "extensions/constraints.h"
+#include "synchronization/cache_line.h"
+#include "synchronization/lock_order.h"
+#include "synchronization/lock_profile.h"
+#include "synchronization/lock_record.h"
 #include "synchronization/signal.h"
+#include "synchronization/wait_policy.h"
 
+#include <array>
 #include <atomic>
 #include <cerrno>
 #include <chrono>
 #include <concepts>
 #include <csignal>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -32,6 +39,7 @@ Purpose:	header file contains set of thread-safe concurrent containers,
 #include <stop_token>
 #include <system_error>
 #include <thread>
+#include <tuple>
 #include <type_traits>
 #include <typeindex>
 #include <unordered_map>
@@ -58,19 +66,19 @@ concept lock_tracking_policy = requires {
 };
 
 /// <summary>
-/// Information about a lock acquisition event.
-/// Captures mutex type, resource type, source location, thread ID and timestamp.
-///
+/// Concept for lock tracking policies which also profile the contention of the owners
 /// </summary>
-class lock_information
-{
-public:
-	std::type_index MutexType = typeid(void);
-	std::source_location Location;
-	std::thread::id ThreadId = std::this_thread::get_id();
-	std::chrono::system_clock::time_point AcquiredAt = std::chrono::system_clock::now();
+template <typename Policy>
+concept lock_profiling_policy = lock_tracking_policy<Policy> && requires {
+	requires Policy::profile_contention;
+};
 
-	std::optional<std::type_index> ResourceType;
+/// <summary>
+/// Concept for lock tracking policies which also validate the order in which threads acquire the owners
+/// </summary>
+template <typename Policy>
+concept lock_order_policy = lock_tracking_policy<Policy> && requires {
+	requires Policy::check_lock_order;
 };
 
 /// <summary>
@@ -106,7 +114,7 @@ public:
 	}
 
 private:
-	static void _log_event(const lock_information& lock_info, const void* mutex_ptr) noexcept
+	static void _log_event(const details::lock_record& record, const void* mutex_ptr) noexcept
 	{
 		if (!_has_logging_callback().load(std::memory_order_acquire))
 			return;
@@ -116,7 +124,7 @@ private:
 			std::shared_lock lock(_logging_callback_mutex());
 			if (_logging_callback())
 			{
-				_logging_callback()(lock_info, mutex_ptr);
+				_logging_callback()(record.to_information(), mutex_ptr);
 			}
 		}
 		catch (...)
@@ -170,6 +178,36 @@ struct lock_tracking_enabled : lock_logging_support
 	}
 };
 
+/// <summary>
+/// Compile-time policy: tracking enabled together with the contention profiler,
+///	holders measure how long they waited for the lock and how long they held it, see lock_contention_profiler
+/// </summary>
+struct lock_tracking_profiled : lock_logging_support
+{
+	static constexpr bool is_compile_time = true;
+	static constexpr bool profile_contention = true;
+
+	static constexpr bool should_track() noexcept
+	{
+		return true;
+	}
+};
+
+/// <summary>
+/// Compile-time policy: tracking enabled together with the lock order validator,
+///	cycles in the order of acquired owners are reported by lock_order_checker before the thread blocks
+/// </summary>
+struct lock_tracking_ordered : lock_logging_support
+{
+	static constexpr bool is_compile_time = true;
+	static constexpr bool check_lock_order = true;
+
+	static constexpr bool should_track() noexcept
+	{
+		return true;
+	}
+};
+
 /// <summary>
 /// Runtime policy: enables/disables tracking at runtime via atomic flag
 /// </summary>
@@ -200,6 +238,109 @@ private:
 	}
 };
 
+namespace details
+{
+/// <summary>
+/// Fixed array of tracking records of concurrent holders, so tracked readers do not serialize on one mutex.
+/// The holder claims a free slot by one compare-and-swap, it starts at the slot of its thread and keeps the index until it unlocks.
+/// The record is written before the slot is published and it is copied by the readers of the details under the spin flag of the slot,
+///	so the holder waits only when the details are being read at the same moment.
+/// </summary>
+class lock_tracking_slots
+{
+public:
+	static constexpr uint32_t slot_count = 32;
+	static constexpr uint32_t no_slot = slot_count;
+
+	/// <summary>
+	/// Returns index of the claimed slot, or no_slot when all slots are taken.
+	/// </summary>
+	[[nodiscard]] uint32_t push(void* holder, const lock_record& record) noexcept
+	{
+		const auto start = thread_table::index();
+		for (uint32_t i = 0; i < slot_count; i++)
+		{
+			const auto index = (start + i) % slot_count;
+			auto& target = _slots[index];
+			void* expected = nullptr;
+			if (target.holder.load(std::memory_order_relaxed) != nullptr || !target.holder.compare_exchange_strong(expected, _reserved(), std::memory_order_acquire, std::memory_order_relaxed))
+				continue;
+
+			_lock(target);
+			target.record = record;
+			_unlock(target);
+
+			target.holder.store(holder, std::memory_order_release);
+			return index;
+		}
+
+		return no_slot;
+	}
+
+	void pop(uint32_t index) noexcept
+	{
+		_slots[index].holder.store(nullptr, std::memory_order_release);
+	}
+
+	void move(uint32_t index, void* holder) noexcept
+	{
+		_slots[index].holder.store(holder, std::memory_order_release);
+	}
+
+	template <class _Map>
+	void collect(_Map& details) const
+	{
+		for (auto& source : _slots)
+		{
+			if (!_published(source.holder.load(std::memory_order_acquire)))
+				continue;
+
+			_lock(source);
+			auto* holder = source.holder.load(std::memory_order_relaxed);
+			const auto record = source.record;
+			_unlock(source);
+
+			if (_published(holder))
+				details.insert_or_assign(holder, record.to_information());
+		}
+	}
+
+private:
+	struct alignas(cache_line_size) slot
+	{
+		std::atomic<void*> holder = nullptr;
+		mutable std::atomic<bool> busy = false;
+		lock_record record;
+	};
+
+	// Marks the slot claimed by the holder which is still writing its record
+	[[nodiscard]] static void* _reserved() noexcept
+	{
+		static char reserved;
+		return &reserved;
+	}
+
+	[[nodiscard]] static bool _published(void* holder) noexcept
+	{
+		return holder != nullptr && holder != _reserved();
+	}
+
+	static void _lock(const slot& target) noexcept
+	{
+		while (target.busy.exchange(true, std::memory_order_acquire))
+			details::cpu_relax();
+	}
+
+	static void _unlock(const slot& target) noexcept
+	{
+		target.busy.store(false, std::memory_order_release);
+	}
+
+private:
+	std::array<slot, slot_count> _slots;
+};
+} // namespace details
+
 /// <summary>
 /// Forward declaration of lock owner base
 /// </summary>
@@ -233,8 +374,8 @@ public:
 	constexpr void unlock()
 	{
 		_check_ownership();
-		_lock.unlock();
 
+		// Details are removed under the lock, like in the destructor, so the next holder never races with them
 		if constexpr (_needs_runtime_tracking())
 		{
 			if (_tracking_enabled)
@@ -243,20 +384,23 @@ public:
 				_tracking_enabled = false;
 			}
 		}
+
+		_lock.unlock();
 	}
 
 	constexpr void lock(std::source_location srcl = std::source_location::current())
 	{
 		_check_deadlock();
+		_before_lock(srcl);
 		_lock.lock();
 
 		if constexpr (_needs_runtime_tracking())
 		{
 			if (_should_track())
 			{
-				const auto& lock_info = _push_lock_details(typeid(_Type), std::move(srcl));
+				const auto& record = _push_lock_details(typeid(_Type), std::move(srcl));
 				_tracking_enabled = true;
-				_log_lock_event(lock_info);
+				_acquired(record);
 			}
 		}
 	}
@@ -264,15 +408,16 @@ public:
 	constexpr bool try_lock(std::source_location srcl = std::source_location::current())
 	{
 		_check_deadlock();
+		_start_wait();
 		bool locked = _lock.try_lock();
 
 		if constexpr (_needs_runtime_tracking())
 		{
 			if (locked && _should_track())
 			{
-				const auto& lock_info = _push_lock_details(typeid(_Type), std::move(srcl));
+				const auto& record = _push_lock_details(typeid(_Type), std::move(srcl));
 				_tracking_enabled = true;
-				_log_lock_event(lock_info);
+				_acquired(record);
 			}
 		}
 
@@ -341,10 +486,87 @@ protected:
 			throw std::system_error(EPERM, std::system_category().default_error_condition(EPERM).category(), "lock_holder does not own the resource!");
 	}
 
-	void _log_lock_event(const lock_information& lock_info) const
+	// Profiled and ordered holders lock in the constructor body, so the wait can be measured and the order validated before the thread blocks
+	static constexpr bool _locks_deferred = lock_profiling_policy<_Policy> || lock_order_policy<_Policy>;
+
+	static _LockType _acquire(lock_owner_base<_Type, _Policy>& owner)
 	{
+		if constexpr (_locks_deferred)
+			return _LockType(owner._get_mutex(), std::defer_lock);
+		else
+			return _LockType(owner._get_mutex());
+	}
+
+	void _lock_deferred(const std::source_location& srcl)
+	{
+		if constexpr (_locks_deferred)
+		{
+			_before_lock(srcl);
+			_lock.lock();
+		}
+	}
+
+	void _before_lock([[maybe_unused]] const std::source_location& srcl)
+	{
+		if constexpr (lock_order_policy<_Policy>)
+			details::lock_order_graph::check(_owner->_lock_order.id(), srcl);
+
+		_start_wait();
+	}
+
+	void _start_wait() noexcept
+	{
+		if constexpr (lock_profiling_policy<_Policy>)
+			_timer.wait_started = details::lock_clock::now();
+	}
+
+	// Logs the tracked acquisition, the profiled holder records its wait and starts to measure the hold
+	void _acquired(const details::lock_record& record)
+	{
+		if constexpr (lock_profiling_policy<_Policy>)
+		{
+			_timer.site = &_owner->_contention.site(record);
+			_timer.acquired_at = record.acquired_at;
+			_wait_histogram(*_timer.site).add(record.acquired_at - std::min(_timer.wait_started, record.acquired_at));
+		}
+
+		if constexpr (lock_order_policy<_Policy>)
+			details::lock_order_graph::acquired(_owner->_lock_order.id(), record.location);
+
 		if constexpr (_needs_runtime_tracking())
-			_Policy::_log_event(lock_info, _owner->get_mutex().get());
+			_Policy::_log_event(record, &_owner->_get_mutex());
+	}
+
+	void _released() noexcept
+	{
+		if constexpr (lock_order_policy<_Policy>)
+			details::lock_order_graph::released(_owner->_lock_order.id());
+
+		if constexpr (lock_profiling_policy<_Policy>)
+		{
+			if (_timer.site)
+			{
+				const auto released_at = details::lock_clock::now();
+				_hold_histogram(*_timer.site).add(released_at - std::min(_timer.acquired_at, released_at));
+				_timer.site = nullptr;
+			}
+		}
+	}
+
+	[[nodiscard]] static details::contention_histogram& _wait_histogram(details::contention_site& site) noexcept
+	{
+		if constexpr (std::is_same_v<_LockType, std::unique_lock<_Type>>)
+			return site.exclusive_wait;
+		else
+			return site.concurrent_wait;
+	}
+
+	[[nodiscard]] static details::contention_histogram& _hold_histogram(details::contention_site& site) noexcept
+	{
+		if constexpr (std::is_same_v<_LockType, std::unique_lock<_Type>>)
+			return site.exclusive_hold;
+		else
+			return site.concurrent_hold;
 	}
 
 	static constexpr bool _should_track() noexcept
@@ -361,7 +583,7 @@ protected:
 		return !_Policy::is_compile_time || _Policy::should_track();
 	}
 
-	const lock_information& _push_lock_details(std::type_index&& index, std::source_location&& srcl)
+	details::lock_record _push_lock_details(std::type_index&& index, std::source_location&& srcl)
 	{
 		if constexpr (std::is_same_v<_LockType, std::unique_lock<_Type>>)
 		{
@@ -378,20 +600,22 @@ protected:
 			if constexpr (_needs_runtime_tracking())
 			{
 				if (_resourceType.has_value())
-					return _owner->_push_concurrent_lock_details(this, std::move(index), std::move(srcl), _resourceType.value());
+					return _owner->_push_concurrent_lock_details(this, _tracking_slot, std::move(index), std::move(srcl), _resourceType.value());
 				else
-					return _owner->_push_concurrent_lock_details(this, std::move(index), std::move(srcl));
+					return _owner->_push_concurrent_lock_details(this, _tracking_slot, std::move(index), std::move(srcl));
 			}
 		}
 	}
 
 	void _pop_lock_details()
 	{
+		_released();
+
 		if constexpr (std::is_same_v<_LockType, std::unique_lock<_Type>>)
 			_owner->_pop_exclusive_lock_details();
 
 		else if constexpr (std::is_same_v<_LockType, std::shared_lock<_Type>>)
-			_owner->_pop_concurrent_lock_details(this);
+			_owner->_pop_concurrent_lock_details(this, _tracking_slot);
 	}
 
 	lock_owner_base<_Type, _Policy>* _owner = nullptr;
@@ -399,6 +623,11 @@ protected:
 	mutable _LockType _lock;
 
 	std::conditional_t<!_Policy::is_compile_time || (_Policy::is_compile_time && _Policy::should_track()), std::optional<std::type_index>, std::monostate> _resourceType;
+
+	// Tracking slot of the concurrent holder in the owner, no_slot when its record is kept in the overflow map
+	uint32_t _tracking_slot = details::lock_tracking_slots::no_slot;
+
+	std::conditional_t<lock_profiling_policy<_Policy>, details::contention_timer, std::monostate> _timer;
 };
 
 /// <summary>
@@ -417,32 +646,47 @@ private:
 
 public:
 	constexpr exclusive_lock_holder(lock_owner_base<_Type, _Policy>& owner) noexcept
-		: Base(owner, false, std::unique_lock<_Type>(*owner.get_mutex()))
+		: Base(owner, false, std::unique_lock<_Type>(owner._get_mutex()))
 	{
 	}
 
+	// Holder without the lock, lock_all locks it afterwards
+	constexpr exclusive_lock_holder(lock_owner_base<_Type, _Policy>& owner, std::defer_lock_t) noexcept
+		: Base(owner, false, std::unique_lock<_Type>(owner._get_mutex(), std::defer_lock))
+	{
+	}
+
+	constexpr exclusive_lock_holder(lock_owner_base<_Type, _Policy>& owner, std::defer_lock_t, [[maybe_unused]] std::type_index&& resourceType) noexcept
+		: Base(owner, false, std::unique_lock<_Type>(owner._get_mutex(), std::defer_lock))
+	{
+		if constexpr (Base::_needs_runtime_tracking())
+			this->_resourceType = std::move(resourceType);
+	}
+
 	constexpr exclusive_lock_holder(lock_owner_base<_Type, _Policy>& owner, std::source_location&& srcl) noexcept
-		: Base(owner, Base::_should_track(), std::unique_lock<_Type>(*owner.get_mutex()))
+		: Base(owner, Base::_should_track(), Base::_acquire(owner))
 	{
+		this->_lock_deferred(srcl);
 		if constexpr (Base::_needs_runtime_tracking())
 		{
 			if (_tracking_enabled)
 			{
-				const auto& lock_info = this->_push_lock_details(typeid(_Type), std::move(srcl));
-				Base::_log_lock_event(lock_info);
+				const auto& record = this->_push_lock_details(typeid(_Type), std::move(srcl));
+				Base::_acquired(record);
 			}
 		}
 	}
 
 	constexpr exclusive_lock_holder(lock_owner_base<_Type, _Policy>& owner, std::source_location&& srcl, std::type_index&& resourceType) noexcept
-		: Base(owner, Base::_should_track(), std::unique_lock<_Type>(*owner.get_mutex()), std::move(resourceType))
+		: Base(owner, Base::_should_track(), Base::_acquire(owner), std::move(resourceType))
 	{
+		this->_lock_deferred(srcl);
 		if constexpr (Base::_needs_runtime_tracking())
 		{
 			if (_tracking_enabled)
 			{
-				const auto& lock_info = this->_push_lock_details(typeid(_Type), std::move(srcl));
-				Base::_log_lock_event(lock_info);
+				const auto& record = this->_push_lock_details(typeid(_Type), std::move(srcl));
+				Base::_acquired(record);
 			}
 		}
 	}
@@ -461,6 +705,8 @@ public:
 	constexpr exclusive_lock_holder(exclusive_lock_holder&& other) noexcept
 		: Base(*other._owner, other._tracking_enabled, std::move(other._lock))
 	{
+		this->_timer = other._timer;
+		this->_resourceType = other._resourceType;
 		other._tracking_enabled = false;
 	}
 
@@ -471,6 +717,8 @@ public:
 		_owner = std::move(other._owner);
 		_lock = std::move(other._lock);
 		_tracking_enabled = other._tracking_enabled;
+		this->_timer = other._timer;
+		this->_resourceType = other._resourceType;
 		other._tracking_enabled = false;
 		return *this;
 	}
@@ -492,32 +740,47 @@ private:
 
 public:
 	constexpr concurrent_lock_holder(lock_owner_base<_Type, _Policy>& owner) noexcept
-		: Base(owner, false, std::shared_lock<_Type>(*owner.get_mutex()))
+		: Base(owner, false, std::shared_lock<_Type>(owner._get_mutex()))
 	{
 	}
 
+	// Holder without the lock, lock_all locks it afterwards
+	constexpr concurrent_lock_holder(lock_owner_base<_Type, _Policy>& owner, std::defer_lock_t) noexcept
+		: Base(owner, false, std::shared_lock<_Type>(owner._get_mutex(), std::defer_lock))
+	{
+	}
+
+	constexpr concurrent_lock_holder(lock_owner_base<_Type, _Policy>& owner, std::defer_lock_t, [[maybe_unused]] std::type_index&& resourceType) noexcept
+		: Base(owner, false, std::shared_lock<_Type>(owner._get_mutex(), std::defer_lock))
+	{
+		if constexpr (Base::_needs_runtime_tracking())
+			this->_resourceType = std::move(resourceType);
+	}
+
 	constexpr concurrent_lock_holder(lock_owner_base<_Type, _Policy>& owner, std::source_location&& srcl) noexcept
-		: Base(owner, Base::_should_track(), std::shared_lock<_Type>(*owner.get_mutex()))
+		: Base(owner, Base::_should_track(), Base::_acquire(owner))
 	{
+		this->_lock_deferred(srcl);
 		if constexpr (Base::_needs_runtime_tracking())
 		{
 			if (_tracking_enabled)
 			{
-				const auto& lock_info = this->_push_lock_details(typeid(_Type), std::move(srcl));
-				Base::_log_lock_event(lock_info);
+				const auto& record = this->_push_lock_details(typeid(_Type), std::move(srcl));
+				Base::_acquired(record);
 			}
 		}
 	}
 
 	constexpr concurrent_lock_holder(lock_owner_base<_Type, _Policy>& owner, std::source_location&& srcl, std::type_index&& resourceType) noexcept
-		: Base(owner, Base::_should_track(), std::shared_lock<_Type>(*owner.get_mutex()), std::move(resourceType))
+		: Base(owner, Base::_should_track(), Base::_acquire(owner), std::move(resourceType))
 	{
+		this->_lock_deferred(srcl);
 		if constexpr (Base::_needs_runtime_tracking())
 		{
 			if (_tracking_enabled)
 			{
-				const auto& lock_info = this->_push_lock_details(typeid(_Type), std::move(srcl));
-				Base::_log_lock_event(lock_info);
+				const auto& record = this->_push_lock_details(typeid(_Type), std::move(srcl));
+				Base::_acquired(record);
 			}
 		}
 	}
@@ -538,8 +801,11 @@ public:
 	{
 		if constexpr (Base::_needs_runtime_tracking())
 		{
+			this->_tracking_slot = other._tracking_slot;
+			this->_timer = other._timer;
+			this->_resourceType = other._resourceType;
 			if (_tracking_enabled && _lock.owns_lock())
-				_owner->_move_concurrent_lock_details(&other, this);
+				_owner->_move_concurrent_lock_details(&other, this, this->_tracking_slot);
 		}
 
 		other._tracking_enabled = false;
@@ -555,8 +821,11 @@ public:
 
 		if constexpr (Base::_needs_runtime_tracking())
 		{
+			this->_tracking_slot = other._tracking_slot;
+			this->_timer = other._timer;
+			this->_resourceType = other._resourceType;
 			if (_tracking_enabled && _lock.owns_lock())
-				_owner->_move_concurrent_lock_details(&other, this);
+				_owner->_move_concurrent_lock_details(&other, this, this->_tracking_slot);
 		}
 
 		other._tracking_enabled = false;
@@ -569,9 +838,12 @@ public:
 /// This class is intended to be used by lock holder types to record and query lock acquisition locations and related information.
 /// If _MutexType is a shared mutex type (constraints::is_shared_mutex_type), the class maintains per-holder concurrent lock details,
 ///	otherwise those concurrent-detail APIs are not available.
+/// Concurrent details are kept in the lock-free slots allocated with the first tracked holder, the mutex protected map is used only when all slots are taken.
 /// </summary>
 /// <typeparam name="_MutexType">The mutex type associated with the owner. Must satisfy the is_supported_mutex constraint.</typeparam>
-template <is_supported_mutex _MutexType>
+/// <typeparam name="_Profiled">The owner keeps the contention profile of its call sites, see lock_tracking_profiled.</typeparam>
+/// <typeparam name="_Ordered">The owner is a node of the lock order graph, see lock_tracking_ordered.</typeparam>
+template <is_supported_mutex _MutexType, bool _Profiled = false, bool _Ordered = false>
 class [[nodiscard]] owner_lock_details
 {
 	template <class, lock_tracking_policy, class>
@@ -589,29 +861,65 @@ public:
 	using mutex_lock_details = typename std::shared_ptr<std::mutex>;
 
 public:
-	virtual ~owner_lock_details() = default;
+	owner_lock_details()
+		: _contention(_make_contention())
+		, _lock_order(_make_lock_order())
+	{
+	}
 
-	[[nodiscard]] exclusive_lock_details get_exclusive_lock_details() const noexcept
+	// Details describe the holders of this owner, so the copy starts without them
+	owner_lock_details(const owner_lock_details&)
+		: owner_lock_details()
 	{
-		return _exclusive_lock_details;
 	}
 
-	[[nodiscard]] concurrent_lock_details get_concurrent_lock_details() const noexcept
+	owner_lock_details& operator=(const owner_lock_details&) noexcept
+	{
+		return *this;
+	}
+
+	virtual ~owner_lock_details()
+	{
+		delete _tracking_slots.load(std::memory_order_acquire);
+	}
+
+	[[nodiscard]] exclusive_lock_details get_exclusive_lock_details() const
+	{
+		if (!_exclusive_lock_details.has_value())
+			return std::nullopt;
+
+		return _exclusive_lock_details->to_information();
+	}
+
+	[[nodiscard]] concurrent_lock_details get_concurrent_lock_details() const
 		requires(constraints::is_shared_mutex_type<_MutexType>)
 	{
-		return _concurrent_lock_details;
+		concurrent_lock_details details;
+		{
+			std::unique_lock lck(*_mutex_lock_details);
+			for (const auto& [holder, record] : _concurrent_lock_details)
+				details.emplace(holder, record.to_information());
+		}
+
+		if (const auto* slots = _tracking_slots.load(std::memory_order_acquire))
+			slots->collect(details);
+
+		return details;
+	}
+
+	/// <summary>
+	/// Returns wait and hold time histograms of the call sites of this owner, lock_contention_profiler returns profiles of all owners.
+	/// </summary>
+	[[nodiscard]] lock_owner_profile get_contention_profile() const
+		requires(_Profiled)
+	{
+		return _contention.snapshot();
 	}
 
 private:
-	const lock_information& _push_exclusive_lock_details(std::type_index&& mutexType, std::source_location&& srcl, std::optional<std::type_index> resourceType = {})
-	{
-		_exclusive_lock_details = lock_information{
-			std::move(mutexType),
-			std::move(srcl),
-			std::this_thread::get_id(),
-			std::chrono::system_clock::now(),
-			std::move(resourceType),
-		};
+	const details::lock_record& _push_exclusive_lock_details(std::type_index&& mutexType, std::source_location&& srcl, std::optional<std::type_index> resourceType = {})
+	{
+		_exclusive_lock_details = details::lock_record::make(mutexType, srcl, resourceType);
 		return *_exclusive_lock_details;
 	}
 
@@ -620,32 +928,42 @@ private:
 		_exclusive_lock_details.reset();
 	}
 
-	const lock_information& _push_concurrent_lock_details(void* wrapper, std::type_index&& mutexType, std::source_location&& srcl, std::optional<std::type_index> resourceType = {}) const
+	details::lock_record _push_concurrent_lock_details(void* wrapper, uint32_t& slot, std::type_index&& mutexType, std::source_location&& srcl, std::optional<std::type_index> resourceType = {}) const
 		requires(constraints::is_shared_mutex_type<_MutexType>)
 	{
-		std::unique_lock lck(*_mutex_lock_details);
-		auto [it, inserted] = _concurrent_lock_details.emplace(
-			wrapper,
-			lock_information{
-				std::move(mutexType),
-				std::move(srcl),
-				std::this_thread::get_id(),
-				std::chrono::system_clock::now(),
-				std::move(resourceType) });
+		const auto record = details::lock_record::make(mutexType, srcl, resourceType);
+		slot = _get_tracking_slots().push(wrapper, record);
+		if (slot == details::lock_tracking_slots::no_slot)
+		{
+			std::unique_lock lck(*_mutex_lock_details);
+			_concurrent_lock_details.insert_or_assign(wrapper, record);
+		}
 
-		return it->second;
+		return record;
 	}
 
-	void _pop_concurrent_lock_details(void* wrapper) const noexcept
+	void _pop_concurrent_lock_details(void* wrapper, uint32_t slot) const noexcept
 		requires(constraints::is_shared_mutex_type<_MutexType>)
 	{
+		if (slot != details::lock_tracking_slots::no_slot)
+		{
+			_tracking_slots.load(std::memory_order_acquire)->pop(slot);
+			return;
+		}
+
 		std::unique_lock lck(*_mutex_lock_details);
 		_concurrent_lock_details.erase(wrapper);
 	}
 
-	void _move_concurrent_lock_details(void* old, void* newone) const
+	void _move_concurrent_lock_details(void* old, void* newone, uint32_t slot) const
 		requires(constraints::is_shared_mutex_type<_MutexType>)
 	{
+		if (slot != details::lock_tracking_slots::no_slot)
+		{
+			_tracking_slots.load(std::memory_order_acquire)->move(slot, newone);
+			return;
+		}
+
 		std::unique_lock lck(*_mutex_lock_details);
 		auto&& node = _concurrent_lock_details.extract(old);
 		if (node.empty())
@@ -654,16 +972,85 @@ private:
 		_concurrent_lock_details.emplace(newone, std::move(node.mapped()));
 	}
 
+	[[nodiscard]] auto _make_contention()
+	{
+		if constexpr (_Profiled)
+			return details::contention_table(this);
+		else
+			return std::monostate();
+	}
+
+	[[nodiscard]] auto _make_lock_order()
+	{
+		if constexpr (_Ordered)
+			return details::lock_order_node(this);
+		else
+			return std::monostate();
+	}
+
+	// Slots are allocated by the first tracked holder, owners that are never locked concurrently do not pay for them
+	[[nodiscard]] details::lock_tracking_slots& _get_tracking_slots() const
+	{
+		auto* slots = _tracking_slots.load(std::memory_order_acquire);
+		if (slots)
+			return *slots;
+
+		auto created = std::make_unique<details::lock_tracking_slots>();
+		if (_tracking_slots.compare_exchange_strong(slots, created.get(), std::memory_order_acq_rel, std::memory_order_acquire))
+			return *created.release();
+
+		return *slots;
+	}
+
 private:
 	mutable mutex_lock_details _mutex_lock_details = std::make_shared<std::mutex>();
-	mutable exclusive_lock_details _exclusive_lock_details;
+	mutable std::optional<details::lock_record> _exclusive_lock_details;
+
+	// Records of the concurrent holders which did not get a tracking slot
+	mutable std::conditional_t<constraints::is_shared_mutex_type<_MutexType>, std::unordered_map<void*, details::lock_record>, std::monostate> _concurrent_lock_details;
+	mutable std::atomic<details::lock_tracking_slots*> _tracking_slots = nullptr;
+
+	std::conditional_t<_Profiled, details::contention_table, std::monostate> _contention;
+	std::conditional_t<_Ordered, details::lock_order_node, std::monostate> _lock_order;
+};
+
+/// <summary>
+/// Intention to lock the owner exclusively or concurrently, it is passed to lock_all which acquires all intents together.
+/// The source location of the intent is reported by the tracking policies as the location of the acquisition.
+/// </summary>
+template <class _Holder, class _Owner>
+class [[nodiscard]] lock_intent
+{
+public:
+	using holder_type = _Holder;
+
+	constexpr lock_intent(_Owner& owner, std::source_location&& srcl) noexcept
+		: _owner(&owner)
+		, _location(std::move(srcl))
+	{
+	}
+
+	[[nodiscard]] constexpr _Holder make_deferred() const noexcept
+	{
+		return _Holder(*_owner, std::defer_lock);
+	}
 
-	mutable concurrent_lock_details _concurrent_lock_details;
+	[[nodiscard]] constexpr const std::source_location& location() const noexcept
+	{
+		return _location;
+	}
+
+private:
+	_Owner* _owner;
+	std::source_location _location;
 };
 
 template <is_supported_mutex _Type, lock_tracking_policy _Policy>
-class [[nodiscard]] lock_owner_base : public std::conditional_t<_Policy::is_compile_time && !_Policy::should_track(), std::monostate, owner_lock_details<_Type>>
+class [[nodiscard]] lock_owner_base : public std::conditional_t<_Policy::is_compile_time && !_Policy::should_track(), std::monostate, owner_lock_details<_Type, lock_profiling_policy<_Policy>, lock_order_policy<_Policy>>>
 {
+	template <class, lock_tracking_policy, class>
+	friend class lock_holder_base;
+
 	friend exclusive_lock_holder<_Type, _Policy>;
 	friend concurrent_lock_holder<_Type, _Policy>;
 
@@ -749,15 +1136,120 @@ public:
 		return concurrent_lock_holder<_Type, _Policy>(const_cast<lock_owner_base<_Type, _Policy>&>(*this));
 	}
 
+	// Intents for lock_all
+	[[nodiscard]] constexpr auto exclusive_intent(std::source_location srcl = std::source_location::current()) noexcept
+	{
+		return lock_intent<exclusive_lock_holder<_Type, _Policy>, lock_owner_base<_Type, _Policy>>(*this, std::move(srcl));
+	}
+
+	[[nodiscard]] constexpr auto concurrent_intent(std::source_location srcl = std::source_location::current()) const noexcept
+		requires(constraints::is_shared_mutex_type<_Type>)
+	{
+		return lock_intent<concurrent_lock_holder<_Type, _Policy>, lock_owner_base<_Type, _Policy>>(const_cast<lock_owner_base<_Type, _Policy>&>(*this), std::move(srcl));
+	}
+
 	[[nodiscard]] const std::shared_ptr<_Type> get_mutex() const noexcept
 	{
 		return _mutex;
 	}
 
+protected:
+	/// <summary>
+	/// Adopts the mutex allocated by the derived owner, e.g. together with its resource in one allocation.
+	/// </summary>
+	explicit lock_owner_base(std::shared_ptr<_Type> mutex) noexcept
+		: _mutex(std::move(mutex))
+	{
+	}
+
+private:
+	// Holders lock the mutex through the reference, copying the shared pointer would write its reference count on every lock
+	[[nodiscard]] _Type& _get_mutex() const noexcept
+	{
+		return *_mutex;
+	}
+
 private:
 	std::shared_ptr<_Type> _mutex = std::make_shared<_Type>();
 };
 
+namespace details
+{
+template <class _Holder>
+bool lock_holder(void* holder, const std::source_location& location, bool blocking)
+{
+	auto& target = *static_cast<_Holder*>(holder);
+	if (!blocking)
+		return target.try_lock(location);
+
+	target.lock(location);
+	return true;
+}
+
+template <class _Holder>
+void unlock_holder(void* holder)
+{
+	auto& target = *static_cast<_Holder*>(holder);
+	if (target.owns_lock())
+		target.unlock();
+}
+
+/// <summary>
+/// Deadlock avoidance of std::lock over the holders: the thread blocks on one holder only, tries the others
+///	and on a failure releases all of them and starts blocking on the one that failed.
+/// Holders lock through their own lock and try_lock, so the tracking policies see every acquisition and release.
+/// </summary>
+template <class... _Holders, size_t... _Indexes>
+void lock_all_holders(std::tuple<_Holders...>& holders, const std::array<std::source_location, sizeof...(_Holders)>& locations, std::index_sequence<_Indexes...>)
+{
+	constexpr size_t count = sizeof...(_Holders);
+	const std::array<void*, count> targets{ static_cast<void*>(&std::get<_Indexes>(holders))... };
+	const std::array<bool (*)(void*, const std::source_location&, bool), count> lock{ &lock_holder<_Holders>... };
+	const std::array<void (*)(void*), count> unlock{ &unlock_holder<_Holders>... };
+
+	size_t first = 0;
+	while (true)
+	{
+		lock[first](targets[first], locations[first], true);
+
+		size_t failed = count;
+		for (size_t i = 1; i < count; i++)
+		{
+			const auto index = (first + i) % count;
+			if (!lock[index](targets[index], locations[index], false))
+			{
+				failed = index;
+				break;
+			}
+		}
+
+		if (failed == count)
+			return;
+
+		for (size_t i = 0; i < count; i++)
+			unlock[i](targets[i]);
+
+		first = failed;
+		std::this_thread::yield();
+	}
+}
+} // namespace details
+
+/// <summary>
+/// Acquires all intents without the risk of deadlock and returns the tuple of their holders in the order of the intents,
+///	e.g. auto [first, second] = lock_all(owner1.exclusive_intent(), owner2.concurrent_intent());
+/// Intents have to refer to different owners.
+/// </summary>
+template <class... _Intents>
+[[nodiscard]] auto lock_all(_Intents&&... intents)
+{
+	static_assert(sizeof...(_Intents) > 0, "lock_all requires at least one intent!");
+
+	std::tuple<typename std::remove_cvref_t<_Intents>::holder_type...> holders{ intents.make_deferred()... };
+	details::lock_all_holders(holders, { intents.location()... }, std::index_sequence_for<_Intents...>());
+	return holders;
+}
+
 // CTAD
 template <class T>
 lock_owner_base(T&&) -> lock_owner_base<T, lock_tracking_disabled>;
@@ -780,12 +1272,30 @@ using lock_owner_debug = lock_owner_base<_Type, lock_tracking_enabled>;
 template <class _Type = std::shared_mutex>
 using lock_owner_runtime = lock_owner_base<_Type, lock_tracking_runtime>;
 
+/// <summary>
+/// Contention profiling alias
+/// </summary>
+template <class _Type = std::shared_mutex>
+using lock_owner_profiled = lock_owner_base<_Type, lock_tracking_profiled>;
+
+/// <summary>
+/// Lock order validation alias
+/// </summary>
+template <class _Type = std::shared_mutex>
+using lock_owner_ordered = lock_owner_base<_Type, lock_tracking_ordered>;
+
 /// <summary>
 /// Build configuration alias
 /// </summary>
 #if defined(SYNCHRONIZATION_RUNTIME_TRACKING)
 template <class _Type = std::shared_mutex>
 using lock_owner = lock_owner_runtime<_Type>;
+#elif defined(SYNCHRONIZATION_CONTENTION_PROFILING)
+template <class _Type = std::shared_mutex>
+using lock_owner = lock_owner_profiled<_Type>;
+#elif defined(SYNCHRONIZATION_LOCK_ORDER_CHECKING)
+template <class _Type = std::shared_mutex>
+using lock_owner = lock_owner_ordered<_Type>;
 #elif defined(NDEBUG) || defined(SYNCHRONIZATION_NO_TRACKING)
 template <class _Type = std::shared_mutex>
 using lock_owner = lock_owner_release<_Type>;
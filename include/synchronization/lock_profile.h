@@ -0,0 +1,366 @@
+/*
+MIT License
+Copyright (c) 2025 Vit Janecek (mailto:janecekvit@outlook.com)
+
+lock_profile.h
+Purpose:	header file contains the lock contention profiler,
+			histograms of wait and hold times per lock owner and call site, their snapshot and export
+
+
+@author: Vit Janecek
+@mailto: <mailto:janecekvit@outlook.com>
+@version 1.00 16/10/2026
+*/
+
+#pragma once
+
+#include "synchronization/lock_record.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <source_location>
+#include <string_view>
+#include <typeindex>
+#include <utility>
+#include <vector>
+
+namespace janecekvit::synchronization
+{
+/// <summary>
+/// Snapshot of one histogram of durations.
+/// Buckets hold the upper bound and the count of the non-empty buckets, the bounds grow by powers of two.
+/// </summary>
+struct lock_histogram
+{
+	uint64_t Count = 0;
+	std::chrono::nanoseconds Total{};
+	std::chrono::nanoseconds Max{};
+	std::vector<std::pair<std::chrono::nanoseconds, uint64_t>> Buckets;
+
+	/// <summary>
+	/// Returns the upper bound of the bucket which contains the given fraction of the samples, e.g. 0.99 for the 99th percentile.
+	/// </summary>
+	[[nodiscard]] std::chrono::nanoseconds percentile(double fraction) const noexcept
+	{
+		const auto rank = static_cast<double>(Count) * std::clamp(fraction, 0.0, 1.0);
+		uint64_t seen = 0;
+		for (const auto& [bound, count] : Buckets)
+		{
+			seen += count;
+			if (static_cast<double>(seen) >= rank)
+				return std::min(bound, Max);
+		}
+
+		return Max;
+	}
+};
+
+/// <summary>
+/// Wait and hold times of the acquisitions made at one call site of the owner.
+/// The call site with the default location collects the acquisitions beyond the capacity of the owner.
+/// </summary>
+struct lock_call_site_profile
+{
+	std::source_location Location;
+	lock_histogram ExclusiveWait;
+	lock_histogram ExclusiveHold;
+	lock_histogram ConcurrentWait;
+	lock_histogram ConcurrentHold;
+};
+
+/// <summary>
+/// Contention profile of one lock owner, Owner is the address of its lock_owner_base.
+/// </summary>
+struct lock_owner_profile
+{
+	const void* Owner = nullptr;
+	std::type_index MutexType = typeid(void);
+	std::optional<std::type_index> ResourceType;
+	std::vector<lock_call_site_profile> CallSites;
+};
+
+namespace details
+{
+/// <summary>
+/// Histogram of durations in clock ticks with one bucket per power of two, the writers only increment relaxed counters.
+/// </summary>
+class contention_histogram
+{
+public:
+	static constexpr size_t bucket_count = 40;
+
+	void add(lock_clock::tick_type ticks) noexcept
+	{
+		_buckets[std::min<size_t>(std::bit_width(ticks), bucket_count - 1)].fetch_add(1, std::memory_order_relaxed);
+		_total.fetch_add(ticks, std::memory_order_relaxed);
+
+		auto max = _max.load(std::memory_order_relaxed);
+		while (ticks > max && !_max.compare_exchange_weak(max, ticks, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	[[nodiscard]] lock_histogram snapshot() const
+	{
+		lock_histogram histogram;
+		for (size_t i = 0; i < bucket_count; i++)
+		{
+			const auto count = _buckets[i].load(std::memory_order_relaxed);
+			if (count == 0)
+				continue;
+
+			histogram.Count += count;
+			histogram.Buckets.emplace_back(lock_clock::to_duration(uint64_t(1) << i), count);
+		}
+
+		histogram.Total = lock_clock::to_duration(_total.load(std::memory_order_relaxed));
+		histogram.Max = lock_clock::to_duration(_max.load(std::memory_order_relaxed));
+		return histogram;
+	}
+
+private:
+	std::array<std::atomic<uint64_t>, bucket_count> _buckets = {};
+	std::atomic<uint64_t> _total = 0;
+	std::atomic<uint64_t> _max = 0;
+};
+
+/// <summary>
+/// Histograms of one call site of one owner.
+/// </summary>
+struct contention_site
+{
+	contention_site(const lock_record& record) noexcept
+		: location(record.location)
+		, mutex_type(record.mutex_type)
+		, resource_type(record.resource_type)
+	{
+	}
+
+	const std::source_location* const location;
+	const std::type_index mutex_type;
+	const std::optional<std::type_index> resource_type;
+
+	contention_histogram exclusive_wait;
+	contention_histogram exclusive_hold;
+	contention_histogram concurrent_wait;
+	contention_histogram concurrent_hold;
+};
+
+/// <summary>
+/// Call sites of one owner in a fixed open-addressing table keyed by the interned location.
+/// The site is allocated by the first acquisition from its location and published by one compare-and-swap,
+///	acquisitions from locations beyond the capacity share the last site.
+/// </summary>
+class contention_table
+{
+public:
+	static constexpr size_t site_count = 32;
+
+	explicit contention_table(const void* owner)
+		: _owner(owner)
+	{
+		_register(this);
+	}
+
+	contention_table(const contention_table&) = delete;
+	contention_table& operator=(const contention_table&) = delete;
+
+	~contention_table()
+	{
+		_unregister(this);
+		for (auto& site : _sites)
+			delete site.load(std::memory_order_acquire);
+	}
+
+	[[nodiscard]] contention_site& site(const lock_record& record)
+	{
+		const auto start = std::hash<const void*>()(record.location) % site_count;
+		for (size_t i = 0; i < site_count; i++)
+		{
+			auto& slot = _sites[(start + i) % site_count];
+			if (auto* found = _claim(slot, record); found->location == record.location)
+				return *found;
+		}
+
+		return *_claim(_sites[site_count], record);
+	}
+
+	[[nodiscard]] lock_owner_profile snapshot() const
+	{
+		lock_owner_profile profile;
+		profile.Owner = _owner;
+		for (size_t i = 0; i <= site_count; i++)
+		{
+			const auto* site = _sites[i].load(std::memory_order_acquire);
+			if (!site)
+				continue;
+
+			profile.MutexType = site->mutex_type;
+			if (site->resource_type.has_value())
+				profile.ResourceType = site->resource_type;
+
+			profile.CallSites.push_back(lock_call_site_profile{
+				i < site_count && site->location ? *site->location : std::source_location(),
+				site->exclusive_wait.snapshot(),
+				site->exclusive_hold.snapshot(),
+				site->concurrent_wait.snapshot(),
+				site->concurrent_hold.snapshot() });
+		}
+
+		return profile;
+	}
+
+	/// <summary>
+	/// Profiles of all living owners with the profiling policy.
+	/// </summary>
+	[[nodiscard]] static std::vector<lock_owner_profile> snapshot_all()
+	{
+		std::vector<lock_owner_profile> profiles;
+		std::unique_lock lock(_registry_mutex());
+		for (const auto* table : _registry())
+			profiles.push_back(table->snapshot());
+
+		return profiles;
+	}
+
+private:
+	// Returns the site in the slot, the new one for the record when the slot was empty
+	[[nodiscard]] static contention_site* _claim(std::atomic<contention_site*>& slot, const lock_record& record)
+	{
+		auto* current = slot.load(std::memory_order_acquire);
+		if (current)
+			return current;
+
+		auto created = std::make_unique<contention_site>(record);
+		if (slot.compare_exchange_strong(current, created.get(), std::memory_order_acq_rel, std::memory_order_acquire))
+			return created.release();
+
+		return current;
+	}
+
+	static void _register(const contention_table* table)
+	{
+		std::unique_lock lock(_registry_mutex());
+		_registry().push_back(table);
+	}
+
+	static void _unregister(const contention_table* table) noexcept
+	{
+		std::unique_lock lock(_registry_mutex());
+		std::erase(_registry(), table);
+	}
+
+	[[nodiscard]] static std::mutex& _registry_mutex() noexcept
+	{
+		static std::mutex mutex;
+		return mutex;
+	}
+
+	[[nodiscard]] static std::vector<const contention_table*>& _registry() noexcept
+	{
+		static std::vector<const contention_table*> registry;
+		return registry;
+	}
+
+private:
+	const void* const _owner;
+	std::array<std::atomic<contention_site*>, site_count + 1> _sites = {};
+};
+
+/// <summary>
+/// Profiling state of one holder, the call site and the tick of the acquisition.
+/// </summary>
+struct contention_timer
+{
+	contention_site* site = nullptr;
+	lock_clock::tick_type wait_started = 0;
+	lock_clock::tick_type acquired_at = 0;
+};
+} // namespace details
+
+/// <summary>
+/// Entry point of the contention profiler, it reads the profiles of all living owners with the lock_tracking_profiled policy.
+/// </summary>
+class lock_contention_profiler
+{
+public:
+	[[nodiscard]] static std::vector<lock_owner_profile> snapshot()
+	{
+		return details::contention_table::snapshot_all();
+	}
+
+	/// <summary>
+	/// Writes the profiles as CSV, one line per owner, call site and histogram, durations are in nanoseconds.
+	/// All text fields are quoted (RFC 4180).
+	/// </summary>
+	static void export_csv(std::ostream& stream, const std::vector<lock_owner_profile>& profiles)
+	{
+		stream << "owner,mutex_type,resource_type,file,line,function,histogram,count,total_ns,max_ns,p50_ns,p99_ns\n";
+		for (const auto& profile : profiles)
+		{
+			for (const auto& site : profile.CallSites)
+			{
+				const std::pair<const char*, const lock_histogram*> histograms[] = {
+					{ "exclusive_wait", &site.ExclusiveWait },
+					{ "exclusive_hold", &site.ExclusiveHold },
+					{ "concurrent_wait", &site.ConcurrentWait },
+					{ "concurrent_hold", &site.ConcurrentHold },
+				};
+
+				for (const auto& [name, histogram] : histograms)
+				{
+					if (histogram->Count == 0)
+						continue;
+
+					stream << profile.Owner << ',';
+					_write_text(stream, profile.MutexType.name());
+					stream << ',';
+					_write_text(stream, profile.ResourceType ? profile.ResourceType->name() : "");
+					stream << ',';
+					_write_text(stream, site.Location.file_name());
+					stream << ',' << site.Location.line() << ',';
+					_write_text(stream, site.Location.function_name());
+					stream << ',';
+					_write_text(stream, name);
+					stream << ',' << histogram->Count << ',' << histogram->Total.count() << ',' << histogram->Max.count() << ','
+						   << histogram->percentile(0.5).count() << ',' << histogram->percentile(0.99).count() << '\n';
+				}
+			}
+		}
+	}
+
+	static void export_csv(std::ostream& stream)
+	{
+		export_csv(stream, snapshot());
+	}
+
+private:
+	/// <summary>
+	/// Writes the quoted CSV field, type names may contain commas (MSVC) and embedded quotes are doubled.
+	/// </summary>
+	static void _write_text(std::ostream& stream, std::string_view text)
+	{
+		stream << '"';
+		for (auto character : text)
+		{
+			if (character == '"')
+				stream << '"';
+
+			stream << character;
+		}
+
+		stream << '"';
+	}
+};
+
+} // namespace janecekvit::synchronization
@@ -0,0 +1,347 @@
+/*
+MIT License
+Copyright (c) 2025 Vit Janecek (mailto:janecekvit@outlook.com)
+
+lock_record.h
+Purpose:	header file contains information about the lock acquisition and its compact record,
+			the record is written on every tracked acquisition and converted to the information only when somebody reads it
+
+
+@author: Vit Janecek
+@mailto: <mailto:janecekvit@outlook.com>
+@version 1.00 16/10/2026
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <source_location>
+#include <thread>
+#include <tuple>
+#include <typeindex>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define SYNCHRONIZATION_LOCK_CLOCK_TSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define SYNCHRONIZATION_LOCK_CLOCK_TSC
+#endif
+
+namespace janecekvit::synchronization
+{
+/// <summary>
+/// Information about a lock acquisition event.
+/// Captures mutex type, resource type, source location, thread ID and timestamp.
+///
+/// </summary>
+class lock_information
+{
+public:
+	std::type_index MutexType = typeid(void);
+	std::source_location Location;
+	std::thread::id ThreadId = std::this_thread::get_id();
+	std::chrono::system_clock::time_point AcquiredAt = std::chrono::system_clock::now();
+
+	std::optional<std::type_index> ResourceType;
+};
+
+namespace details
+{
+/// <summary>
+/// Tick source of the lock tracking, the time stamp counter on x86 and the steady clock elsewhere.
+/// The length of the tick is measured once between the static initialization and the first conversion, so reading the clock costs no calibration.
+/// The time stamp counter is expected to be invariant, i.e. synchronized between cores and independent of the frequency scaling.
+/// </summary>
+class lock_clock
+{
+public:
+	using tick_type = uint64_t;
+
+	[[nodiscard]] static tick_type now() noexcept
+	{
+#if defined(SYNCHRONIZATION_LOCK_CLOCK_TSC)
+		return __rdtsc();
+#else
+		return static_cast<tick_type>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+	}
+
+	[[nodiscard]] static std::chrono::nanoseconds to_duration(tick_type ticks) noexcept
+	{
+		return std::chrono::nanoseconds(std::llround(static_cast<double>(ticks) * _nanoseconds_per_tick()));
+	}
+
+	[[nodiscard]] static std::chrono::system_clock::time_point to_time_point(tick_type tick) noexcept
+	{
+		const auto current = now();
+		const auto system_now = std::chrono::system_clock::now();
+		const auto elapsed = current >= tick ? to_duration(current - tick) : -to_duration(tick - current);
+		return system_now - std::chrono::duration_cast<std::chrono::system_clock::duration>(elapsed);
+	}
+
+private:
+	struct anchor
+	{
+		tick_type tick;
+		std::chrono::steady_clock::time_point time;
+	};
+
+	[[nodiscard]] static anchor _take_anchor() noexcept
+	{
+		return anchor{ now(), std::chrono::steady_clock::now() };
+	}
+
+	/// <summary>
+	/// The ratio is measured by the first conversion and cached, later conversions read no clock.
+	/// </summary>
+	[[nodiscard]] static double _nanoseconds_per_tick() noexcept
+	{
+		static const double ratio = _measure_nanoseconds_per_tick();
+		return ratio;
+	}
+
+	[[nodiscard]] static double _measure_nanoseconds_per_tick() noexcept
+	{
+#if defined(SYNCHRONIZATION_LOCK_CLOCK_TSC)
+		// The first conversion shortly after the start waits until the measured interval is long enough for a precise ratio
+		auto current = _take_anchor();
+		while (current.time - _origin.time < std::chrono::milliseconds(1))
+			current = _take_anchor();
+
+		return std::chrono::duration<double, std::nano>(current.time - _origin.time).count() / static_cast<double>(current.tick - _origin.tick);
+#else
+		return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::duration(1)).count();
+#endif
+	}
+
+	static const anchor _origin;
+};
+
+inline const lock_clock::anchor lock_clock::_origin = lock_clock::_take_anchor();
+
+/// <summary>
+/// Interns source locations of the lock call sites, so the record keeps one pointer and the call site may be used as a key.
+/// The lookup compares the line, the column and the pointers of the file and function names, the names are compared by value only on a mismatch,
+///	because the same file may have different pointers in different translation units.
+/// Interned locations are never released, the number of call sites is bounded by the program.
+/// </summary>
+class call_site_table
+{
+public:
+	[[nodiscard]] static const std::source_location* intern(const std::source_location& location)
+	{
+		auto& bucket = _buckets()[(location.line() * 31 + location.column()) % bucket_count];
+		auto* head = bucket.load(std::memory_order_acquire);
+		if (const auto* found = _find(head, nullptr, location))
+			return found;
+
+		auto created = std::make_unique<node>(location, head);
+		while (!bucket.compare_exchange_weak(created->next, created.get(), std::memory_order_release, std::memory_order_acquire))
+		{
+			// Only the nodes pushed meanwhile may contain the location
+			if (const auto* found = _find(created->next, head, location))
+				return found;
+
+			head = created->next;
+		}
+
+		return &created.release()->location;
+	}
+
+private:
+	static constexpr size_t bucket_count = 1024;
+
+	struct node
+	{
+		node(const std::source_location& srcl, node* following) noexcept
+			: location(srcl)
+			, next(following)
+		{
+		}
+
+		const std::source_location location;
+		node* next;
+	};
+
+	[[nodiscard]] static std::array<std::atomic<node*>, bucket_count>& _buckets() noexcept
+	{
+		static std::array<std::atomic<node*>, bucket_count> buckets = {};
+		return buckets;
+	}
+
+	[[nodiscard]] static const std::source_location* _find(const node* first, const node* last, const std::source_location& location) noexcept
+	{
+		for (auto* current = first; current != last; current = current->next)
+		{
+			if (_equal(current->location, location))
+				return &current->location;
+		}
+
+		return nullptr;
+	}
+
+	[[nodiscard]] static bool _equal(const std::source_location& left, const std::source_location& right) noexcept
+	{
+		return left.line() == right.line() && left.column() == right.column()
+			   && (left.file_name() == right.file_name() || std::strcmp(left.file_name(), right.file_name()) == 0)
+			   && (left.function_name() == right.function_name() || std::strcmp(left.function_name(), right.function_name()) == 0);
+	}
+};
+
+/// <summary>
+/// Assigns small indexes to threads, the first tracked acquisition of the thread registers its id, later ones read a thread local value.
+/// The index is converted back to the thread id only when the record is read.
+/// The index is released when the thread exits and reused by the next registered thread, so the table is bounded by the number of living threads.
+/// Records keep the key of the thread, i.e. the index with its generation, so records of exited threads report an empty id even after the index is reused.
+/// </summary>
+class thread_table
+{
+public:
+	using key_type = uint64_t;
+
+	[[nodiscard]] static uint32_t index()
+	{
+		return _registered().index;
+	}
+
+	[[nodiscard]] static key_type key()
+	{
+		const auto& thread = _registered();
+		return static_cast<key_type>(thread.generation) << 32 | thread.index;
+	}
+
+	[[nodiscard]] static std::thread::id id(key_type key)
+	{
+		const auto thread = static_cast<uint32_t>(key);
+		const auto generation = static_cast<uint32_t>(key >> 32);
+
+		std::unique_lock lock(_mutex());
+		if (thread >= _slots().size() || _slots()[thread].generation != generation)
+			return std::thread::id();
+
+		return _slots()[thread].id;
+	}
+
+private:
+	struct slot
+	{
+		std::thread::id id;
+		uint32_t generation = 0;
+	};
+
+	struct registration
+	{
+		registration()
+		{
+			std::tie(index, generation) = _register();
+		}
+
+		~registration()
+		{
+			_release(index);
+		}
+
+		registration(const registration&) = delete;
+		registration& operator=(const registration&) = delete;
+
+		uint32_t index = 0;
+		uint32_t generation = 0;
+	};
+
+	[[nodiscard]] static const registration& _registered()
+	{
+		thread_local const registration thread;
+		return thread;
+	}
+
+	[[nodiscard]] static std::pair<uint32_t, uint32_t> _register()
+	{
+		std::unique_lock lock(_mutex());
+		auto& released = _released();
+		if (!released.empty())
+		{
+			const auto thread = released.back();
+			released.pop_back();
+
+			auto& reused = _slots()[thread];
+			reused.id = std::this_thread::get_id();
+			return { thread, reused.generation };
+		}
+
+		// Every index may be released, so the release never allocates
+		released.reserve(_slots().size() + 1);
+		_slots().push_back(slot{ std::this_thread::get_id() });
+		return { static_cast<uint32_t>(_slots().size() - 1), 0 };
+	}
+
+	static void _release(uint32_t thread) noexcept
+	{
+		std::unique_lock lock(_mutex());
+		auto& released = _slots()[thread];
+		released.id = std::thread::id();
+		released.generation++;
+		_released().push_back(thread);
+	}
+
+	[[nodiscard]] static std::vector<uint32_t>& _released() noexcept
+	{
+		static std::vector<uint32_t> released;
+		return released;
+	}
+
+	[[nodiscard]] static std::mutex& _mutex() noexcept
+	{
+		static std::mutex mutex;
+		return mutex;
+	}
+
+	[[nodiscard]] static std::vector<slot>& _slots() noexcept
+	{
+		static std::vector<slot> slots;
+		return slots;
+	}
+};
+
+/// <summary>
+/// Compact record written on every tracked acquisition: clock tick, interned call site and thread key.
+/// It is converted to lock_information only when the details are queried or the logging callback fires.
+/// </summary>
+struct lock_record
+{
+	std::type_index mutex_type = typeid(void);
+	const std::source_location* location = nullptr;
+	lock_clock::tick_type acquired_at = 0;
+	thread_table::key_type thread = 0;
+	std::optional<std::type_index> resource_type;
+
+	[[nodiscard]] static lock_record make(std::type_index mutexType, const std::source_location& srcl, std::optional<std::type_index> resourceType = {})
+	{
+		return lock_record{ mutexType, call_site_table::intern(srcl), lock_clock::now(), thread_table::key(), resourceType };
+	}
+
+	[[nodiscard]] lock_information to_information() const
+	{
+		return lock_information{
+			mutex_type,
+			location ? *location : std::source_location(),
+			thread_table::id(thread),
+			lock_clock::to_time_point(acquired_at),
+			resource_type
+		};
+	}
+};
+} // namespace details
+
+} // namespace janecekvit::synchronization
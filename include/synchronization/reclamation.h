@@ -0,0 +1,630 @@
+/*
+MIT License
+Copyright (c) 2025 Vit Janecek (mailto:janecekvit@outlook.com)
+
+reclamation.h
+Purpose:	header file contains safe memory reclamation for lock-free readers,
+			epoch-based reclamation and hazard pointers release retired objects once no reader can access them
+
+
+@author: Vit Janecek
+@mailto: <mailto:janecekvit@outlook.com>
+@version 1.00 16/10/2026
+*/
+
+#pragma once
+
+#include "synchronization/cache_line.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace janecekvit::synchronization
+{
+class epoch_domain;
+class hazard_domain;
+
+namespace details
+{
+/// <summary>
+/// Object unlinked by the writer, it is deleted once no reader can hold it.
+/// </summary>
+struct retired_object
+{
+	void* pointer;
+	void (*deleter)(void*);
+	uint64_t epoch;
+};
+
+template <class _Type>
+[[nodiscard]] retired_object make_retired(_Type* pointer, uint64_t epoch = 0) noexcept
+{
+	return retired_object{ const_cast<void*>(static_cast<const void*>(pointer)), [](void* object)
+		{
+			delete static_cast<_Type*>(object);
+		},
+		epoch };
+}
+
+inline void delete_retired(std::vector<retired_object>& objects) noexcept
+{
+	for (auto& object : objects)
+		object.deleter(object.pointer);
+
+	objects.clear();
+}
+
+/// <summary>
+/// Read-side state of one thread in one epoch domain, records live on separate cache lines, so pinning threads do not share lines.
+/// The state is the pinned epoch shifted left with the lowest bit set, zero when the thread is outside of the critical section.
+/// </summary>
+struct alignas(cache_line_size) epoch_record
+{
+	std::atomic<uint64_t> state = 0;
+	std::atomic<bool> in_use = true;
+	uint32_t nesting = 0; // Accessed by the owning thread only
+	epoch_record* next = nullptr;
+};
+
+/// <summary>
+/// Records of the domain, threads keep it alive until they exit, so a thread exiting after the domain was destroyed releases its record safely.
+/// </summary>
+struct epoch_registry
+{
+	epoch_registry() = default;
+	epoch_registry(const epoch_registry&) = delete;
+	epoch_registry& operator=(const epoch_registry&) = delete;
+
+	~epoch_registry()
+	{
+		for (auto* record = head.load(std::memory_order_acquire); record;)
+			delete std::exchange(record, record->next);
+	}
+
+	[[nodiscard]] epoch_record* acquire()
+	{
+		for (auto* record = head.load(std::memory_order_acquire); record; record = record->next)
+		{
+			bool expected = false;
+			if (!record->in_use.load(std::memory_order_relaxed) && record->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire))
+				return record;
+		}
+
+		auto* record = new epoch_record();
+		record->next = head.load(std::memory_order_relaxed);
+		while (!head.compare_exchange_weak(record->next, record, std::memory_order_release, std::memory_order_relaxed))
+			;
+
+		return record;
+	}
+
+	std::atomic<epoch_record*> head = nullptr;
+};
+
+/// <summary>
+/// Records of the calling thread, they are returned to their domains when the thread exits.
+/// </summary>
+class epoch_thread_cache
+{
+public:
+	epoch_thread_cache() = default;
+	epoch_thread_cache(const epoch_thread_cache&) = delete;
+	epoch_thread_cache& operator=(const epoch_thread_cache&) = delete;
+
+	~epoch_thread_cache()
+	{
+		for (auto& [registry, record] : _entries)
+			record->in_use.store(false, std::memory_order_release);
+	}
+
+	[[nodiscard]] epoch_record* find(const std::shared_ptr<epoch_registry>& registry)
+	{
+		for (auto& [owner, record] : _entries)
+		{
+			if (owner == registry)
+				return record;
+		}
+
+		auto* record = registry->acquire();
+		_entries.emplace_back(registry, record);
+		return record;
+	}
+
+private:
+	std::vector<std::pair<std::shared_ptr<epoch_registry>, epoch_record*>> _entries;
+};
+
+/// <summary>
+/// Hazard pointer slot of the domain, slots are reused by other hazard pointers and deleted with the domain.
+/// </summary>
+struct alignas(cache_line_size) hazard_record
+{
+	std::atomic<const void*> pointer = nullptr;
+	std::atomic<bool> in_use = true;
+	hazard_record* next = nullptr;
+};
+
+} // namespace details
+
+/// <summary>
+/// Read-side critical section of the epoch domain, objects retired meanwhile are not deleted until the guard is released.
+/// The guard belongs to the thread which pinned it, it must be released by the same thread.
+/// </summary>
+class [[nodiscard]] epoch_guard
+{
+	friend class epoch_domain;
+
+public:
+	epoch_guard() noexcept = default;
+
+	epoch_guard(const epoch_guard&) = delete;
+
+	epoch_guard(epoch_guard&& other) noexcept
+		: _record(std::exchange(other._record, nullptr))
+	{
+	}
+
+	~epoch_guard()
+	{
+		reset();
+	}
+
+	epoch_guard& operator=(const epoch_guard&) = delete;
+
+	epoch_guard& operator=(epoch_guard&& other) noexcept
+	{
+		if (this != &other)
+		{
+			reset();
+			_record = std::exchange(other._record, nullptr);
+		}
+
+		return *this;
+	}
+
+	/// <summary>
+	/// Leaves the critical section, pointers read under the guard must not be used anymore.
+	/// </summary>
+	void reset() noexcept
+	{
+		if (auto* record = std::exchange(_record, nullptr); record && --record->nesting == 0)
+			record->state.store(0, std::memory_order_release);
+	}
+
+	[[nodiscard]] bool owns_epoch() const noexcept
+	{
+		return _record != nullptr;
+	}
+
+private:
+	explicit epoch_guard(details::epoch_record* record) noexcept
+		: _record(record)
+	{
+	}
+
+private:
+	details::epoch_record* _record = nullptr;
+};
+
+/// <summary>
+/// Epoch-based reclamation: readers announce the global epoch in their own record and writers retire unlinked objects with the epoch of their retirement.
+/// The epoch advances only when all pinned readers have seen the current one, so the object retired in epoch E is unreachable once the epoch reaches E + 2.
+/// Pinning costs a store to the record of the calling thread and one fence, there is no write to a shared cache line and no reference counting,
+///	releasing is a single store. Readers never wait, but a reader staying pinned for long delays the reclamation of all objects retired meanwhile.
+/// Retired objects are deleted by the thread which calls collect. Retire tries to advance the epoch and collects whenever it advanced
+///	or enough objects were retired, so the rarely replaced snapshot keeps at most two retired copies alive.
+/// </summary>
+/// <example>
+/// <code>
+///  std::atomic<config*> current;
+///
+///  { // Reader
+///     auto guard = epoch_domain::global().pin();
+///     use(*current.load(std::memory_order_acquire));
+///  }
+///
+///  // Writer
+///  auto* old = current.exchange(new config(...), std::memory_order_acq_rel);
+///  epoch_domain::global().retire(old);
+/// </code>
+/// </example>
+class epoch_domain
+{
+public:
+	static constexpr size_t collect_threshold = 64;
+
+public:
+	epoch_domain()
+		: _registry(std::make_shared<details::epoch_registry>())
+	{
+	}
+
+	epoch_domain(const epoch_domain&) = delete;
+	epoch_domain& operator=(const epoch_domain&) = delete;
+
+	/// <summary>
+	/// Deletes all retired objects, no reader may be pinned anymore.
+	/// </summary>
+	~epoch_domain()
+	{
+		details::delete_retired(_retired);
+	}
+
+	/// <summary>
+	/// Domain shared by all containers of the framework.
+	/// </summary>
+	[[nodiscard]] static epoch_domain& global()
+	{
+		static epoch_domain domain;
+		return domain;
+	}
+
+	/// <summary>
+	/// Enters the read-side critical section, guards of one thread may be nested.
+	/// </summary>
+	[[nodiscard]] epoch_guard pin()
+	{
+		auto* record = _thread_record();
+		if (record->nesting++ == 0)
+		{
+			record->state.store((_epoch.load(std::memory_order_relaxed) << 1) | 1, std::memory_order_relaxed);
+
+			// The announced epoch must be visible before the reader loads any shared pointer
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+		}
+
+		return epoch_guard(record);
+	}
+
+	/// <summary>
+	/// Deletes the object once no reader pinned before this call holds it, the object must be unlinked already.
+	/// </summary>
+	template <class _Type>
+	void retire(_Type* object)
+	{
+		if (!object)
+			return;
+
+		// Unlinking of the object must be visible before the epoch is read
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const auto epoch = _epoch.load(std::memory_order_relaxed);
+
+		bool full = false;
+		{
+			std::scoped_lock lock(_retired_mutex);
+			_retired.emplace_back(details::make_retired(object, epoch));
+			full = _retired.size() >= collect_threshold;
+		}
+
+		// Only the advanced epoch makes more objects reclaimable, the failed attempt costs one pass over the thread records
+		if (_try_advance() || full)
+			collect();
+	}
+
+	/// <summary>
+	/// Tries to advance the epoch and deletes the objects which are not reachable by readers anymore.
+	/// </summary>
+	/// <returns>Number of deleted objects.</returns>
+	size_t collect()
+	{
+		_try_advance();
+		const auto epoch = _epoch.load(std::memory_order_acquire);
+
+		std::vector<details::retired_object> reclaimable;
+		{
+			std::scoped_lock lock(_retired_mutex);
+			auto it = std::partition(_retired.begin(), _retired.end(), [epoch](const details::retired_object& object)
+				{
+					return object.epoch + 2 > epoch;
+				});
+
+			reclaimable.assign(it, _retired.end());
+			_retired.erase(it, _retired.end());
+		}
+
+		const auto count = reclaimable.size();
+		details::delete_retired(reclaimable);
+		return count;
+	}
+
+	/// <summary>
+	/// Waits until readers pinned before the call leave and deletes the objects retired before it.
+	/// </summary>
+	/// <exception cref="std::logic_error">When the calling thread is pinned, it would wait for itself.</exception>
+	void synchronize()
+	{
+		if (_thread_record()->nesting != 0)
+			throw std::logic_error("epoch_domain::synchronize cannot be called from the read-side critical section!");
+
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const auto target = _epoch.load(std::memory_order_relaxed) + 2;
+		while (_epoch.load(std::memory_order_acquire) < target)
+		{
+			if (!_try_advance())
+				std::this_thread::yield();
+		}
+
+		collect();
+	}
+
+	[[nodiscard]] uint64_t epoch() const noexcept
+	{
+		return _epoch.load(std::memory_order_acquire);
+	}
+
+	/// <summary>
+	/// Number of objects waiting for deletion.
+	/// </summary>
+	[[nodiscard]] size_t retired_count() const
+	{
+		std::scoped_lock lock(_retired_mutex);
+		return _retired.size();
+	}
+
+private:
+	[[nodiscard]] details::epoch_record* _thread_record()
+	{
+		thread_local details::epoch_thread_cache cache;
+		return cache.find(_registry);
+	}
+
+	bool _try_advance() noexcept
+	{
+		auto epoch = _epoch.load(std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		for (auto* record = _registry->head.load(std::memory_order_acquire); record; record = record->next)
+		{
+			const auto state = record->state.load(std::memory_order_acquire);
+			if ((state & 1) != 0 && (state >> 1) != epoch)
+				return false;
+		}
+
+		return _epoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order_acq_rel);
+	}
+
+private:
+	const std::shared_ptr<details::epoch_registry> _registry;
+	alignas(cache_line_size) std::atomic<uint64_t> _epoch = 1;
+	alignas(cache_line_size) mutable std::mutex _retired_mutex;
+	std::vector<details::retired_object> _retired;
+};
+
+/// <summary>
+/// Protection of one pointer from the deletion by its hazard domain, the pointer protected by protect may be dereferenced until it is reset.
+/// The hazard pointer keeps its slot for its whole lifetime, so create it once and protect many pointers with it.
+/// </summary>
+class [[nodiscard]] hazard_pointer
+{
+	friend class hazard_domain;
+
+public:
+	hazard_pointer() noexcept = default;
+
+	hazard_pointer(const hazard_pointer&) = delete;
+
+	hazard_pointer(hazard_pointer&& other) noexcept
+		: _record(std::exchange(other._record, nullptr))
+	{
+	}
+
+	~hazard_pointer()
+	{
+		_release();
+	}
+
+	hazard_pointer& operator=(const hazard_pointer&) = delete;
+
+	hazard_pointer& operator=(hazard_pointer&& other) noexcept
+	{
+		if (this != &other)
+		{
+			_release();
+			_record = std::exchange(other._record, nullptr);
+		}
+
+		return *this;
+	}
+
+	/// <summary>
+	/// Loads the pointer from source and protects it, the load is repeated until the protected pointer is still published.
+	/// </summary>
+	template <class _Type>
+	[[nodiscard]] _Type* protect(const std::atomic<_Type*>& source) noexcept
+	{
+		auto* pointer = source.load(std::memory_order_relaxed);
+		while (!try_protect(pointer, source))
+			;
+
+		return pointer;
+	}
+
+	/// <summary>
+	/// Protects the pointer and checks it is still published in source, pointer is updated to the current value otherwise.
+	/// </summary>
+	template <class _Type>
+	[[nodiscard]] bool try_protect(_Type*& pointer, const std::atomic<_Type*>& source) noexcept
+	{
+		auto* expected = pointer;
+		_record->pointer.store(expected, std::memory_order_seq_cst);
+		pointer = source.load(std::memory_order_seq_cst);
+		if (pointer == expected)
+			return true;
+
+		_record->pointer.store(nullptr, std::memory_order_release);
+		return false;
+	}
+
+	void reset_protection() noexcept
+	{
+		_record->pointer.store(nullptr, std::memory_order_release);
+	}
+
+	[[nodiscard]] bool empty() const noexcept
+	{
+		return _record == nullptr;
+	}
+
+private:
+	explicit hazard_pointer(details::hazard_record* record) noexcept
+		: _record(record)
+	{
+	}
+
+	void _release() noexcept
+	{
+		if (auto* record = std::exchange(_record, nullptr))
+		{
+			record->pointer.store(nullptr, std::memory_order_release);
+			record->in_use.store(false, std::memory_order_release);
+		}
+	}
+
+private:
+	details::hazard_record* _record = nullptr;
+};
+
+/// <summary>
+/// Hazard pointers: the reader publishes the pointer it is going to dereference in its own slot, writers delete retired objects not published in any slot.
+/// Unlike epochs, the reader protects only the pointers it holds, so a slow reader blocks the deletion of one object only, but every protect costs a fence.
+/// The scan runs when the retired objects outnumber twice the slots, so the number of objects waiting for deletion stays bounded.
+/// All hazard pointers must be destroyed before their domain.
+/// </summary>
+/// <example>
+/// <code>
+///  auto hazard = hazard_domain::global().make_hazard_pointer();
+///  node* head = hazard.protect(list_head); // head cannot be deleted until it is reset
+///  ...
+///  hazard.reset_protection();
+/// </code>
+/// </example>
+class hazard_domain
+{
+public:
+	static constexpr size_t collect_threshold = 64;
+
+public:
+	hazard_domain() = default;
+	hazard_domain(const hazard_domain&) = delete;
+	hazard_domain& operator=(const hazard_domain&) = delete;
+
+	~hazard_domain()
+	{
+		details::delete_retired(_retired);
+		for (auto* record = _records.load(std::memory_order_acquire); record;)
+			delete std::exchange(record, record->next);
+	}
+
+	[[nodiscard]] static hazard_domain& global()
+	{
+		static hazard_domain domain;
+		return domain;
+	}
+
+	/// <summary>
+	/// Hazard pointer with the free slot of the domain, the new slot is allocated when all slots are used.
+	/// </summary>
+	[[nodiscard]] hazard_pointer make_hazard_pointer()
+	{
+		for (auto* record = _records.load(std::memory_order_acquire); record; record = record->next)
+		{
+			bool expected = false;
+			if (!record->in_use.load(std::memory_order_relaxed) && record->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire))
+				return hazard_pointer(record);
+		}
+
+		auto* record = new details::hazard_record();
+		record->next = _records.load(std::memory_order_relaxed);
+		while (!_records.compare_exchange_weak(record->next, record, std::memory_order_release, std::memory_order_relaxed))
+			;
+
+		_record_count.fetch_add(1, std::memory_order_relaxed);
+		return hazard_pointer(record);
+	}
+
+	/// <summary>
+	/// Deletes the object once no hazard pointer protects it, the object must be unlinked already.
+	/// </summary>
+	template <class _Type>
+	void retire(_Type* object)
+	{
+		if (!object)
+			return;
+
+		bool full = false;
+		{
+			std::scoped_lock lock(_retired_mutex);
+			_retired.emplace_back(details::make_retired(object));
+			full = _retired.size() >= std::max(collect_threshold, 2 * _record_count.load(std::memory_order_relaxed));
+		}
+
+		if (full)
+			collect();
+	}
+
+	/// <summary>
+	/// Deletes the retired objects which are not protected by any hazard pointer.
+	/// </summary>
+	/// <returns>Number of deleted objects.</returns>
+	size_t collect()
+	{
+		std::vector<details::retired_object> candidates;
+		{
+			std::scoped_lock lock(_retired_mutex);
+			candidates.swap(_retired);
+		}
+
+		// Unlinking of the objects must be visible before the slots are read
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		std::vector<const void*> protected_pointers;
+		for (auto* record = _records.load(std::memory_order_acquire); record; record = record->next)
+		{
+			if (auto* pointer = record->pointer.load(std::memory_order_acquire))
+				protected_pointers.push_back(pointer);
+		}
+
+		std::sort(protected_pointers.begin(), protected_pointers.end());
+		auto it = std::partition(candidates.begin(), candidates.end(), [&protected_pointers](const details::retired_object& object)
+			{
+				return std::binary_search(protected_pointers.begin(), protected_pointers.end(), static_cast<const void*>(object.pointer));
+			});
+
+		std::vector<details::retired_object> reclaimable(it, candidates.end());
+		candidates.erase(it, candidates.end());
+		if (!candidates.empty())
+		{
+			std::scoped_lock lock(_retired_mutex);
+			_retired.insert(_retired.end(), candidates.begin(), candidates.end());
+		}
+
+		const auto count = reclaimable.size();
+		details::delete_retired(reclaimable);
+		return count;
+	}
+
+	/// <summary>
+	/// Number of objects waiting for deletion.
+	/// </summary>
+	[[nodiscard]] size_t retired_count() const
+	{
+		std::scoped_lock lock(_retired_mutex);
+		return _retired.size();
+	}
+
+private:
+	std::atomic<details::hazard_record*> _records = nullptr;
+	std::atomic<size_t> _record_count = 0;
+	mutable std::mutex _retired_mutex;
+	std::vector<details::retired_object> _retired;
+};
+
+} // namespace janecekvit::synchronization
@@ -0,0 +1,337 @@
+/*
+MIT License
+Copyright (c) 2025 Vit Janecek (mailto:janecekvit@outlook.com)
+
+sharded_unordered_map.h
+Purpose:	header file contains concurrent hash map split to independently locked shards,
+			writers of keys in different shards do not wait for each other
+
+
+@author: Vit Janecek
+@mailto: <mailto:janecekvit@outlook.com>
+@version 1.00 16/10/2026
+*/
+
+#pragma once
+#include "synchronization/concurrent.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <source_location>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace janecekvit::synchronization::concurrent
+{
+/// <summary>
+/// Hash map split to the power of two shards, every shard is std::unordered_map owned by its own cache-aligned resource owner.
+/// The shard is selected by the high bits of the mixed key hash, so the shards stay balanced even for weak hashes
+///	and the bucket index inside the shard does not correlate with the shard index.
+/// Every operation locks only the shard of its key, operations over the whole map lock one shard at a time,
+///	so they never block the whole map, but they do not see an atomic snapshot of it either.
+/// Values are returned by copy, references would outlive the lock of their shard, use visit to work with the value in place.
+/// Operations pass the source location of their caller to the shard locks, so the tracking policies report the caller, not this header.
+/// </summary>
+/// <example>
+/// <code>
+///  concurrent::sharded_unordered_map<std::string, session> sessions;
+///
+///  sessions.insert("alice", session{});
+///  sessions.visit("alice", [](session& value)
+///  {
+///     value.touch(); // exclusive lock of the shard of "alice" only
+///  });
+///
+///  auto alice = sessions.find("alice"); // std::optional<session>
+///  sessions.erase_if([](const std::string&, const session& value)
+///  {
+///     return value.expired(); // locks one shard at a time
+///  });
+/// </code>
+/// </example>
+template <class _Key, class _Value, class _Hash = std::hash<_Key>, class _KeyEqual = std::equal_to<_Key>,
+	lock_tracking_policy _Policy = typename resource_owner<std::unordered_map<_Key, _Value, _Hash, _KeyEqual>>::policy_type>
+class sharded_unordered_map
+{
+public:
+	using key_type = _Key;
+	using mapped_type = _Value;
+	using hasher = _Hash;
+	using key_equal = _KeyEqual;
+	using shard_type = std::unordered_map<_Key, _Value, _Hash, _KeyEqual>;
+	using policy_type = _Policy;
+
+public:
+	/// <summary>
+	/// Four shards per hardware thread, so two writers rarely meet in one shard.
+	/// </summary>
+	sharded_unordered_map()
+		: sharded_unordered_map(4 * std::max<size_t>(std::thread::hardware_concurrency(), 1))
+	{
+	}
+
+	/// <summary>
+	/// The shard count is rounded up to the power of two.
+	/// </summary>
+	/// <exception cref="std::invalid_argument">When the shard count is zero.</exception>
+	explicit sharded_unordered_map(size_t shards, const _Hash& hash = _Hash(), const _KeyEqual& equal = _KeyEqual())
+		: _count(_round_shards(shards))
+		, _shift(64 - static_cast<unsigned>(std::countr_zero(_count)))
+		, _hash(hash)
+	{
+		// Reserved up front, the owners are never relocated
+		_shards.reserve(_count);
+		for (size_t i = 0; i < _count; i++)
+			_shards.emplace_back(shard_type(0, hash, equal));
+	}
+
+	sharded_unordered_map(const sharded_unordered_map&) = delete;
+	sharded_unordered_map& operator=(const sharded_unordered_map&) = delete;
+
+	/// <summary>
+	/// Key of emplace with the source location of its caller, the value arguments leave no place for the defaulted location parameter.
+	/// </summary>
+	struct located_key
+	{
+		template <class _FwdKey>
+			requires std::is_constructible_v<_Key, _FwdKey>
+		located_key(_FwdKey&& key, std::source_location srcl = std::source_location::current())
+			: value(std::forward<_FwdKey>(key))
+			, location(srcl)
+		{
+		}
+
+		_Key value;
+		std::source_location location;
+	};
+
+	/// <summary>
+	/// Copy of the value, std::nullopt when the key is not present.
+	/// </summary>
+	[[nodiscard]] std::optional<_Value> find(const _Key& key, std::source_location srcl = std::source_location::current()) const
+	{
+		auto holder = _concurrent(_shard(key), std::move(srcl));
+		const auto& shard = holder.get();
+		if (auto it = shard.find(key); it != shard.end())
+			return it->second;
+
+		return std::nullopt;
+	}
+
+	[[nodiscard]] bool contains(const _Key& key, std::source_location srcl = std::source_location::current()) const
+	{
+		return _concurrent(_shard(key), std::move(srcl)).get().contains(key);
+	}
+
+	/// <summary>
+	/// Inserts the value when the key is not present.
+	/// </summary>
+	/// <returns>True when the value was inserted.</returns>
+	template <class _FwdKey, class _FwdValue>
+	bool insert(_FwdKey&& key, _FwdValue&& value, std::source_location srcl = std::source_location::current())
+	{
+		return emplace(located_key(std::forward<_FwdKey>(key), srcl), std::forward<_FwdValue>(value));
+	}
+
+	/// <summary>
+	/// Constructs the value in place when the key is not present, arguments are not consumed otherwise.
+	/// </summary>
+	/// <returns>True when the value was inserted.</returns>
+	template <class... _Args>
+	bool emplace(located_key key, _Args&&... args)
+	{
+		auto& owner = _shard(key.value);
+		return _exclusive(owner, std::move(key.location)).get().try_emplace(std::move(key.value), std::forward<_Args>(args)...).second;
+	}
+
+	/// <returns>True when the value was inserted, false when the existing value was assigned.</returns>
+	template <class _FwdKey, class _FwdValue>
+	bool insert_or_assign(_FwdKey&& key, _FwdValue&& value, std::source_location srcl = std::source_location::current())
+	{
+		_Key stored(std::forward<_FwdKey>(key));
+		return _exclusive(_shard(stored), std::move(srcl)).get().insert_or_assign(std::move(stored), std::forward<_FwdValue>(value)).second;
+	}
+
+	/// <returns>Number of erased values, zero or one.</returns>
+	size_t erase(const _Key& key, std::source_location srcl = std::source_location::current())
+	{
+		return _exclusive(_shard(key), std::move(srcl)).get().erase(key);
+	}
+
+	/// <summary>
+	/// Calls fn(value&) under the exclusive lock of the key shard.
+	/// </summary>
+	/// <returns>False when the key is not present and fn was not called.</returns>
+	template <class _Fn>
+	bool visit(const _Key& key, _Fn&& fn, std::source_location srcl = std::source_location::current())
+	{
+		auto holder = _exclusive(_shard(key), std::move(srcl));
+		auto& shard = holder.get();
+		auto it = shard.find(key);
+		if (it == shard.end())
+			return false;
+
+		std::invoke(std::forward<_Fn>(fn), it->second);
+		return true;
+	}
+
+	/// <summary>
+	/// Calls fn(const value&) under the concurrent lock of the key shard.
+	/// </summary>
+	/// <returns>False when the key is not present and fn was not called.</returns>
+	template <class _Fn>
+	bool visit(const _Key& key, _Fn&& fn, std::source_location srcl = std::source_location::current()) const
+	{
+		auto holder = _concurrent(_shard(key), std::move(srcl));
+		const auto& shard = holder.get();
+		auto it = shard.find(key);
+		if (it == shard.end())
+			return false;
+
+		std::invoke(std::forward<_Fn>(fn), std::as_const(it->second));
+		return true;
+	}
+
+	/// <summary>
+	/// Calls fn(const key&, value&) for every value, shards are locked exclusively one at a time.
+	/// </summary>
+	template <class _Fn>
+	void visit_all(_Fn&& fn, std::source_location srcl = std::source_location::current())
+	{
+		for (auto& owner : _shards)
+		{
+			auto holder = _exclusive(owner, srcl);
+			for (auto& [key, value] : holder.get())
+				std::invoke(fn, key, value);
+		}
+	}
+
+	/// <summary>
+	/// Calls fn(const key&, const value&) for every value, shards are locked concurrently one at a time.
+	/// </summary>
+	template <class _Fn>
+	void visit_all(_Fn&& fn, std::source_location srcl = std::source_location::current()) const
+	{
+		for (const auto& owner : _shards)
+		{
+			auto holder = _concurrent(owner, srcl);
+			for (const auto& [key, value] : holder.get())
+				std::invoke(fn, key, value);
+		}
+	}
+
+	/// <summary>
+	/// Erases all values satisfying pred(const key&, const value&), shards are locked exclusively one at a time.
+	/// </summary>
+	/// <returns>Number of erased values.</returns>
+	template <class _Predicate>
+	size_t erase_if(_Predicate&& pred, std::source_location srcl = std::source_location::current())
+	{
+		size_t erased = 0;
+		for (auto& owner : _shards)
+		{
+			erased += std::erase_if(_exclusive(owner, srcl).get(), [&pred](const auto& item)
+				{
+					return std::invoke(pred, std::as_const(item.first), std::as_const(item.second));
+				});
+		}
+
+		return erased;
+	}
+
+	/// <summary>
+	/// Sum of the shard sizes, it is exact only when no other thread modifies the map.
+	/// </summary>
+	[[nodiscard]] size_t size(std::source_location srcl = std::source_location::current()) const
+	{
+		size_t count = 0;
+		for (const auto& owner : _shards)
+			count += _concurrent(owner, srcl).get().size();
+
+		return count;
+	}
+
+	[[nodiscard]] bool empty(std::source_location srcl = std::source_location::current()) const
+	{
+		return std::all_of(_shards.begin(), _shards.end(), [&srcl](const auto& owner)
+			{
+				return _concurrent(owner, srcl).get().empty();
+			});
+	}
+
+	void clear(std::source_location srcl = std::source_location::current())
+	{
+		for (auto& owner : _shards)
+			_exclusive(owner, srcl).get().clear();
+	}
+
+	[[nodiscard]] size_t shard_count() const noexcept
+	{
+		return _count;
+	}
+
+	/// <summary>
+	/// Index of the shard which owns the key.
+	/// </summary>
+	[[nodiscard]] size_t shard_index(const _Key& key) const
+	{
+		// Fibonacci hashing mixes all bits of the hash into the high bits used as the shard index
+		constexpr uint64_t golden_ratio = 0x9E3779B97F4A7C15ull;
+		const auto mixed = static_cast<uint64_t>(_hash(key)) * golden_ratio;
+		// A single shard would need the shift by 64 bits, which is undefined
+		return _count == 1 ? 0 : static_cast<size_t>(mixed >> _shift);
+	}
+
+private:
+	using owner_type = resource_owner_base<shard_type, _Policy, owner_layout::cache_aligned>;
+
+	[[nodiscard]] static uint64_t _round_shards(size_t shards)
+	{
+		if (shards == 0)
+			throw std::invalid_argument("sharded_unordered_map requires at least one shard!");
+
+		return std::bit_ceil(static_cast<uint64_t>(shards));
+	}
+
+	[[nodiscard]] owner_type& _shard(const _Key& key)
+	{
+		return _shards[shard_index(key)];
+	}
+
+	[[nodiscard]] const owner_type& _shard(const _Key& key) const
+	{
+		return _shards[shard_index(key)];
+	}
+
+	// Owners without tracking take no source location
+	[[nodiscard]] static auto _exclusive(owner_type& owner, [[maybe_unused]] std::source_location srcl)
+	{
+		if constexpr (_Policy::is_compile_time && !_Policy::should_track())
+			return owner.exclusive();
+		else
+			return owner.exclusive(std::move(srcl));
+	}
+
+	[[nodiscard]] static auto _concurrent(const owner_type& owner, [[maybe_unused]] std::source_location srcl)
+	{
+		if constexpr (_Policy::is_compile_time && !_Policy::should_track())
+			return owner.concurrent();
+		else
+			return owner.concurrent(std::move(srcl));
+	}
+
+private:
+	const uint64_t _count;
+	const unsigned _shift;
+	[[no_unique_address]] const _Hash _hash;
+	std::vector<owner_type> _shards;
+};
+
+} // namespace janecekvit::synchronization::concurrent
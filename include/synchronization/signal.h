@@ -1,11 +1,17 @@
 #pragma once
 #include "extensions/constraints.h"
 #include "extensions/finally.h"
+#include "synchronization/cache_line.h"
+#include "synchronization/wait_policy.h"
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <mutex>
 #include <semaphore>
+#include <thread>
 
 namespace janecekvit::synchronization
 {
@@ -13,11 +19,14 @@ namespace janecekvit::synchronization
 /// <summary>
 /// The signal is used for synchronization between different threads.
 /// It sets an auto reset state by default, where it resets after each blocking call, or to the manual reset state.
-/// It could be used with std::condition_variable_any, std::condition_variable, or std::binary_semaphore.
-/// Manual reset works only with std::condition_variable_any, std::condition_variable.
+/// It could be used with std::condition_variable_any, std::condition_variable, std::binary_semaphore, or std::atomic<uint64_t> (see the specialization below).
+/// Manual reset works only with std::condition_variable_any, std::condition_variable and std::atomic<uint64_t>.
+/// The wait policy decides whether the untimed wait spins before it parks in the primitive, see wait_policy::spin_then_park and wait_policy::adaptive_spin.
+/// The cache-aligned layout puts the primitive, the state mutex, the hot signal state and the reset versions on separate cache lines
+///	and aligns the whole signal to the cache line, so signals stored next to each other in an array do not share lines.
 /// </summary>
-template <typename _SyncPrimitive = std::binary_semaphore, bool _ManualReset = false>
-	requires(constraints::semaphore_type<_SyncPrimitive, 1> || constraints::condition_variable_type<_SyncPrimitive>) && (!(constraints::semaphore_type<_SyncPrimitive> && _ManualReset))
+template <typename _SyncPrimitive = std::binary_semaphore, bool _ManualReset = false, wait_policy_type _WaitPolicy = wait_policy::park, bool _CacheAligned = false>
+	requires(constraints::semaphore_type<_SyncPrimitive, 1> || constraints::condition_variable_type<_SyncPrimitive> || constraints::atomic_wait_type<_SyncPrimitive>) && (!(constraints::semaphore_type<_SyncPrimitive> && _ManualReset))
 class signal
 {
 public:
@@ -32,6 +41,19 @@ public:
 	{
 	}
 
+	explicit signal(_WaitPolicy policy)
+		requires constraints::condition_variable_type<_SyncPrimitive>
+		: _policy(std::move(policy))
+	{
+	}
+
+	explicit signal(_WaitPolicy policy)
+		requires constraints::semaphore_type<_SyncPrimitive>
+		: _primitive(_SyncPrimitive{ 0 })
+		, _policy(std::move(policy))
+	{
+	}
+
 	virtual ~signal() = default;
 
 	template <class _TLock>
@@ -39,6 +61,8 @@ public:
 		requires constraints::condition_variable_type<_SyncPrimitive>
 	{
 		const auto initial_version = _get_initial_version();
+		if (_spin(lock, initial_version))
+			return;
 
 		_primitive.wait(lock, [this, initial_version]() -> bool
 			{
@@ -51,6 +75,8 @@ public:
 		requires constraints::condition_variable_type<_SyncPrimitive> && std::predicate<_PredicateType>
 	{
 		const auto initial_version = _get_initial_version();
+		if (_spin(lock, initial_version))
+			return;
 
 		_primitive.wait(lock, [this, initial_version, predicate = std::move(pred)]() -> bool
 			{
@@ -62,6 +88,8 @@ public:
 		requires constraints::semaphore_type<_SyncPrimitive, 1>
 	{
 		const auto initial_version = _get_initial_version();
+		if (_spin(initial_version))
+			return;
 
 		while (!_check_signal(initial_version))
 			_primitive.acquire();
@@ -72,6 +100,8 @@ public:
 		requires constraints::semaphore_type<_SyncPrimitive, 1> && std::predicate<_PredicateType>
 	{
 		const auto initial_version = _get_initial_version();
+		if (_spin(initial_version))
+			return;
 
 		while (!(pred() || _check_signal(initial_version)))
 			_primitive.acquire();
@@ -262,6 +292,37 @@ public:
 	}
 
 private:
+	bool _spin(uint64_t initial_version) const
+	{
+		if constexpr (std::is_same_v<_WaitPolicy, wait_policy::park>)
+			return false;
+		else
+		{
+			return _policy.spin([this, initial_version]() -> bool
+				{
+					return _check_signal(initial_version);
+				});
+		}
+	}
+
+	template <class _TLock>
+	bool _spin(_TLock& lock, uint64_t initial_version) const
+	{
+		if constexpr (std::is_same_v<_WaitPolicy, wait_policy::park>)
+			return false;
+		else
+		{
+			// The lock is released while spinning like by the wait of the condition variable, so the waiter does not stall the signaler
+			lock.unlock();
+			auto relock = extensions::finally([&lock]()
+				{
+					lock.lock();
+				});
+
+			return _spin(initial_version);
+		}
+	}
+
 	uint64_t _get_initial_version() const noexcept
 		requires _ManualReset
 	{
@@ -299,12 +360,15 @@ private:
 	/// </summary>
 	struct signal_state
 	{
-		mutable std::mutex state_mutex;
-		std::atomic<bool> signalized{ false };
+		alignas(cache_alignment<std::mutex, _CacheAligned>) mutable std::mutex state_mutex;
+
+		// written by every signalize and consumed by waiters
+		alignas(cache_alignment<std::atomic<bool>, _CacheAligned>) std::atomic<bool> signalized{ false };
 		std::atomic<uint64_t> signal_version{ 0 }; // Detects signal changes
 
+		// read by every wait, written only by signalize_all() and reset()
 		// auto-reset mode - broadcast to all waiters signalize_all()
-		std::atomic<uint64_t> auto_reset_version{ 0 };
+		alignas(cache_alignment<std::atomic<uint64_t>, _CacheAligned>) std::atomic<uint64_t> auto_reset_version{ 0 };
 
 		// manual-reset mode - wake all waiters
 		std::atomic<bool> manual_reset_requested{ false };
@@ -312,10 +376,242 @@ private:
 	};
 
 private:
-	mutable _SyncPrimitive _primitive;
+	alignas(cache_alignment<_SyncPrimitive, _CacheAligned>) mutable _SyncPrimitive _primitive;
 	mutable signal_state _state;
+	[[no_unique_address]] mutable _WaitPolicy _policy;
 };
 
+/// <summary>
+/// The signal built only on std::atomic<uint64_t>::wait and notify, there is neither the state mutex nor the separate primitive.
+/// The signaled flag, the number of parked waiters, the wake-up version and the signal version are packed into one word,
+///	so signalize is a single compare-and-swap and it calls notify only when some waiter is parked.
+/// std::atomic has no timed wait, timed waits therefore poll the word with an exponential back-off of at most max_poll_interval.
+/// The signal version wraps around after 2^32 signals and at most 32767 waiters may be parked at once.
+/// </summary>
+template <bool _ManualReset, wait_policy_type _WaitPolicy, bool _CacheAligned>
+class signal<std::atomic<uint64_t>, _ManualReset, _WaitPolicy, _CacheAligned>
+{
+public:
+	static constexpr auto max_poll_interval = std::chrono::milliseconds(1);
+
+	signal() = default;
+
+	explicit signal(_WaitPolicy policy)
+		: _policy(std::move(policy))
+	{
+	}
+
+	virtual ~signal() = default;
+
+	void wait() const
+	{
+		_wait(_word.load(std::memory_order_acquire), []() noexcept
+			{
+				return false;
+			});
+	}
+
+	template <class _PredicateType>
+	void wait(_PredicateType&& pred) const
+		requires std::predicate<_PredicateType>
+	{
+		_wait(_word.load(std::memory_order_acquire), pred);
+	}
+
+	template <class TRep, class TPeriod>
+	[[nodiscard]] bool wait_for(const std::chrono::duration<TRep, TPeriod>& rel_time) const
+	{
+		return wait_until(std::chrono::steady_clock::now() + rel_time);
+	}
+
+	template <class TRep, class TPeriod, class _PredicateType>
+	[[nodiscard]] bool wait_for(const std::chrono::duration<TRep, TPeriod>& rel_time, _PredicateType&& pred) const
+		requires std::predicate<_PredicateType>
+	{
+		return wait_until(std::chrono::steady_clock::now() + rel_time, std::forward<_PredicateType>(pred));
+	}
+
+	template <class _TClock, class _TDuration>
+	[[nodiscard]] bool wait_until(const std::chrono::time_point<_TClock, _TDuration>& abs_time) const
+	{
+		return _wait_until(abs_time, _word.load(std::memory_order_acquire), []() noexcept
+			{
+				return false;
+			});
+	}
+
+	template <class _TClock, class _TDuration, class _PredicateType>
+	[[nodiscard]] bool wait_until(const std::chrono::time_point<_TClock, _TDuration>& abs_time, _PredicateType&& pred) const
+		requires std::predicate<_PredicateType>
+	{
+		return _wait_until(abs_time, _word.load(std::memory_order_acquire), pred);
+	}
+
+	void signalize() noexcept
+	{
+		const auto previous = _update([](uint64_t word) noexcept
+			{
+				return (word | signaled_bit) + signal_unit;
+			});
+
+		if (previous & waiters_mask)
+		{
+			if constexpr (_ManualReset)
+				_word.notify_all();
+			else
+				_word.notify_one();
+		}
+	}
+
+	void signalize_all() noexcept
+	{
+		const auto previous = _update([](uint64_t word) noexcept
+			{
+				word = (word | signaled_bit) + signal_unit;
+
+				// auto-reset mode - increment broadcast version
+				if constexpr (!_ManualReset)
+					word = _next_wake_version(word);
+
+				return word;
+			});
+
+		if (previous & waiters_mask)
+			_word.notify_all();
+	}
+
+	void reset() noexcept
+		requires _ManualReset
+	{
+		const auto previous = _update([](uint64_t word) noexcept
+			{
+				return _next_wake_version(word & ~signaled_bit);
+			});
+
+		if (previous & waiters_mask)
+			_word.notify_all();
+	}
+
+	[[nodiscard]] bool is_signalized() const noexcept
+	{
+		return (_word.load(std::memory_order_acquire) & signaled_bit) != 0;
+	}
+
+	[[nodiscard]] uint64_t get_signal_version() const noexcept
+	{
+		return _word.load(std::memory_order_acquire) >> signal_shift;
+	}
+
+	[[nodiscard]] uint64_t get_reset_version() const noexcept
+	{
+		if constexpr (_ManualReset)
+			return _wake_version(_word.load(std::memory_order_acquire));
+		else
+			return 0;
+	}
+
+private:
+	// bit 0: signaled flag, bits 1-15: parked waiters, bits 16-31: wake-up version (broadcast or reset), bits 32-63: signal version
+	static constexpr uint64_t signaled_bit = 1;
+	static constexpr uint64_t waiter_unit = uint64_t{ 1 } << 1;
+	static constexpr uint64_t waiters_mask = uint64_t{ 0x7FFF } << 1;
+	static constexpr uint64_t wake_unit = uint64_t{ 1 } << 16;
+	static constexpr uint64_t wake_mask = uint64_t{ 0xFFFF } << 16;
+	static constexpr int signal_shift = 32;
+	static constexpr uint64_t signal_unit = uint64_t{ 1 } << signal_shift;
+
+	static constexpr uint64_t _wake_version(uint64_t word) noexcept
+	{
+		return (word & wake_mask) >> 16;
+	}
+
+	static constexpr uint64_t _next_wake_version(uint64_t word) noexcept
+	{
+		// The wake-up version wraps around inside its bits, the carry must not leak into the signal version
+		return (word & ~wake_mask) | ((word + wake_unit) & wake_mask);
+	}
+
+	template <class _Fn>
+	uint64_t _update(_Fn&& fn) noexcept
+	{
+		auto word = _word.load(std::memory_order_relaxed);
+		while (!_word.compare_exchange_weak(word, fn(word), std::memory_order_acq_rel, std::memory_order_relaxed))
+		{
+		}
+
+		return word;
+	}
+
+	bool _check_signal(uint64_t initial) const noexcept
+	{
+		auto word = _word.load(std::memory_order_acquire);
+		while (true)
+		{
+			if (_wake_version(word) != _wake_version(initial))
+				return true;
+
+			if (!(word & signaled_bit))
+				return false;
+
+			if constexpr (_ManualReset)
+				return true;
+			else if (_word.compare_exchange_weak(word, word & ~signaled_bit, std::memory_order_acq_rel, std::memory_order_acquire))
+				return true; // Auto-reset: atomically check and reset
+		}
+	}
+
+	template <class _PredicateType>
+	void _wait(uint64_t initial, _PredicateType&& pred) const
+	{
+		if constexpr (!std::is_same_v<_WaitPolicy, wait_policy::park>)
+		{
+			if (_policy.spin([this, initial, &pred]() -> bool
+					{
+						return pred() || _check_signal(initial);
+					}))
+				return;
+		}
+
+		while (!(pred() || _check_signal(initial)))
+		{
+			const auto word = _word.fetch_add(waiter_unit, std::memory_order_acq_rel) + waiter_unit;
+
+			// Signal published after the check changed the word, so the wait returns immediately instead of missing it
+			if (!(word & signaled_bit) && _wake_version(word) == _wake_version(initial))
+				_word.wait(word, std::memory_order_acquire);
+
+			_word.fetch_sub(waiter_unit, std::memory_order_acq_rel);
+		}
+	}
+
+	template <class _TClock, class _TDuration, class _PredicateType>
+	bool _wait_until(const std::chrono::time_point<_TClock, _TDuration>& abs_time, uint64_t initial, _PredicateType&& pred) const
+	{
+		std::chrono::nanoseconds interval = std::chrono::microseconds(10);
+		while (!(pred() || _check_signal(initial)))
+		{
+			const auto now = _TClock::now();
+			if (now >= abs_time)
+				return pred() || _check_signal(initial);
+
+			std::this_thread::sleep_for(std::min(interval, std::chrono::duration_cast<std::chrono::nanoseconds>(abs_time - now)));
+			interval = std::min<std::chrono::nanoseconds>(interval * 2, max_poll_interval);
+		}
+
+		return true;
+	}
+
+private:
+	alignas(cache_alignment<std::atomic<uint64_t>, _CacheAligned>) mutable std::atomic<uint64_t> _word = 0;
+	[[no_unique_address]] mutable _WaitPolicy _policy;
+};
+
+/// <summary>
+/// Signal in the cache-aligned layout, use it for arrays of signals signalized by different threads.
+/// </summary>
+template <typename _SyncPrimitive = std::binary_semaphore, bool _ManualReset = false, wait_policy_type _WaitPolicy = wait_policy::park>
+using cache_aligned_signal = signal<_SyncPrimitive, _ManualReset, _WaitPolicy, true>;
+
 template <class _Type, class _InnerType = std::binary_semaphore>
 concept signal_type = std::is_same_v<_Type, janecekvit::synchronization::signal<_InnerType>>;
 
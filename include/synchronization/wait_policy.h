@@ -0,0 +1,181 @@
+/*
+MIT License
+Copyright (c) 2025 Vit Janecek (mailto:janecekvit@outlook.com)
+
+wait_policy.h
+Purpose:	header file contains wait strategies of blocking synchronization primitives,
+			they decide how long the waiter spins before it parks in the operating system
+
+
+@author: Vit Janecek
+@mailto: <mailto:janecekvit@outlook.com>
+@version 1.00 16/10/2026
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+namespace janecekvit::synchronization
+{
+namespace details
+{
+/// <summary>
+/// Hints the CPU that the thread is in a spin-wait loop, it lowers the power consumption and frees resources of the sibling hyper-thread.
+/// </summary>
+inline void cpu_relax() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+	_mm_pause();
+#elif (defined(__aarch64__) || defined(__arm__)) && defined(__GNUC__)
+	asm volatile("yield" ::: "memory");
+#endif
+}
+} // namespace details
+
+/// <summary>
+/// Wait policy decides whether the waiter may avoid the park in the operating system.
+/// spin(ready) polls the ready predicate for a bounded time and returns true when it has been satisfied,
+///	the waiter parks only when it returns false.
+/// </summary>
+template <class _Policy>
+concept wait_policy_type = requires(_Policy& policy, bool (*ready)()) {
+	{ policy.spin(ready) } -> std::same_as<bool>;
+};
+
+namespace wait_policy
+{
+/// <summary>
+/// The waiter parks immediately, it is the default and the cheapest policy when the wake-ups are rare.
+/// </summary>
+struct park
+{
+	template <class _Predicate>
+	bool spin(_Predicate&&) const noexcept
+	{
+		return false;
+	}
+};
+
+/// <summary>
+/// The waiter polls with the CPU pause instruction, then with yielding the time slice, and parks afterwards.
+/// It pays off when the signaler usually fires within a few microseconds, so the futex sleep and wake-up are avoided.
+/// </summary>
+struct spin_then_park
+{
+	size_t spins = 1000;
+	size_t yields = 10;
+
+	template <class _Predicate>
+	bool spin(_Predicate&& ready) const
+	{
+		for (size_t i = 0; i < spins; i++)
+		{
+			if (ready())
+				return true;
+
+			details::cpu_relax();
+		}
+
+		for (size_t i = 0; i < yields; i++)
+		{
+			if (ready())
+				return true;
+
+			std::this_thread::yield();
+		}
+
+		return false;
+	}
+};
+
+/// <summary>
+/// Spin policy which tunes its spin budget from the recent wait times.
+/// Waits satisfied while spinning move the moving average towards their duration, parked waits move it towards the maximum budget,
+///	the waiter spins for twice the average, but only for a short probe when the waits are longer than the maximum budget.
+/// The policy is thread-safe, so one instance may be shared by all waiters of the signal.
+/// </summary>
+class adaptive_spin
+{
+public:
+	using clock = std::chrono::steady_clock;
+
+	explicit adaptive_spin(std::chrono::nanoseconds max_spin = std::chrono::microseconds(50))
+		: _max_spin(max_spin.count())
+		, _average(max_spin.count() / 2)
+	{
+		if (max_spin <= std::chrono::nanoseconds::zero())
+			throw std::invalid_argument("adaptive_spin requires positive max_spin!");
+	}
+
+	adaptive_spin(const adaptive_spin& other) noexcept
+		: _max_spin(other._max_spin)
+		, _average(other._average.load(std::memory_order_relaxed))
+	{
+	}
+
+	template <class _Predicate>
+	bool spin(_Predicate&& ready)
+	{
+		const auto budget = spin_budget();
+		const auto start = clock::now();
+		for (size_t i = 0;; i++)
+		{
+			if (ready())
+			{
+				_update(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count());
+				return true;
+			}
+
+			details::cpu_relax();
+
+			// The clock is not read on every iteration, pause already takes tens of cycles
+			if ((i & 15) == 15 && clock::now() - start >= budget)
+				break;
+		}
+
+		_update(2 * _max_spin);
+		return false;
+	}
+
+	/// <summary>
+	/// Time the next waiter spins before it parks.
+	/// </summary>
+	[[nodiscard]] std::chrono::nanoseconds spin_budget() const noexcept
+	{
+		const auto average = _average.load(std::memory_order_relaxed);
+		if (average > _max_spin)
+			return std::chrono::nanoseconds(std::max<int64_t>(_max_spin / probe_divisor, 1));
+
+		return std::chrono::nanoseconds(std::min(2 * average, _max_spin));
+	}
+
+private:
+	static constexpr int64_t probe_divisor = 16;
+	static constexpr int64_t smoothing = 8;
+
+	void _update(int64_t waited) noexcept
+	{
+		// Racy read-modify-write is fine, the average is only a heuristic
+		const auto average = _average.load(std::memory_order_relaxed);
+		_average.store(average + (waited - average) / smoothing, std::memory_order_relaxed);
+	}
+
+private:
+	const int64_t _max_spin;
+	std::atomic<int64_t> _average;
+};
+
+} // namespace wait_policy
+} // namespace janecekvit::synchronization
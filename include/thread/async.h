@@ -31,12 +31,15 @@ Purpose: header file of static thread pool class
 #pragma once
 #include "synchronization/concurrent.h"
 #include "synchronization/wait_for_multiple_signals.h"
+#include "thread/sync_thread_pool.h"
 
+#include <algorithm>
 #include <atomic>
 #include <functional>
 #include <future>
 #include <list>
 #include <queue>
+#include <thread>
 #include <type_traits>
 
 namespace janecekvit::thread::async
@@ -56,4 +59,33 @@ template <typename _Fn, typename... Args>
 	return std::async(std::launch::async, std::forward<_Fn>(fn), std::forward<Args>(args)...);
 }
 
+#if defined(HAS_JTHREAD)
+
+/// <summary>
+/// Creates a new asynchronous task executed on the given thread pool instead of a new thread.
+/// The function and the arguments are decay-copied like by std::async.
+/// </summary>
+/// <param name="pool">Thread pool executing the task, e.g. shared_pool().</param>
+/// <returns>A pooled_future object representing the result of the function invocation, continuations are chained by then(), on_error() and when_all().</returns>
+template <typename _Fn, typename... Args>
+	requires std::is_invocable_v<std::decay_t<_Fn>, std::decay_t<Args>...> && (!std::is_reference_v<std::invoke_result_t<std::decay_t<_Fn>, std::decay_t<Args>...>>)
+[[nodiscard]] pooled_future<std::invoke_result_t<std::decay_t<_Fn>, std::decay_t<Args>...>> create(sync_thread_pool& pool, _Fn&& fn, Args&&... args) noexcept
+{
+	return pool.add_pooled_task([fn = std::forward<_Fn>(fn), ... args = std::forward<Args>(args)]() mutable
+		{
+			return std::invoke(std::move(fn), std::move(args)...);
+		});
+}
+
+/// <summary>
+/// Process-wide thread pool with one worker per hardware thread, created on the first use.
+/// </summary>
+[[nodiscard]] inline sync_thread_pool& shared_pool()
+{
+	static sync_thread_pool pool(std::max<size_t>(std::thread::hardware_concurrency(), 1));
+	return pool;
+}
+
+#endif // defined(HAS_JTHREAD)
+
 } // namespace janecekvit::thread::async
@@ -0,0 +1,847 @@
+/*
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2025 Vit janecek <mailto:janecekvit@outlook.com>.
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+coroutine.h
+Purpose: header file of coroutine task type, thread pool scheduler and task combinators
+
+@author: Vit Janecek
+@mailto: janecekvit@outlook.com
+@version 1.00 16/10/2026
+*/
+
+#pragma once
+
+#include "compatibility/compiler_support.h"
+#include "thread/sync_thread_pool.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#if defined(HAS_JTHREAD)
+
+namespace janecekvit::thread::coroutine
+{
+template <class _Type = void>
+class task;
+
+namespace details
+{
+/// <summary>
+/// Value type of the combinator results, void tasks are represented by std::monostate.
+/// </summary>
+template <class _Type>
+using non_void_t = std::conditional_t<std::is_void_v<_Type>, std::monostate, _Type>;
+
+class task_promise_base
+{
+	struct final_awaiter
+	{
+		bool await_ready() const noexcept
+		{
+			return false;
+		}
+
+		template <class _Promise>
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<_Promise> handle) const noexcept
+		{
+			// Symmetric transfer to the awaiting coroutine, the stack does not grow with the length of the await chain
+			return handle.promise()._continuation;
+		}
+
+		void await_resume() const noexcept
+		{
+		}
+	};
+
+public:
+	std::suspend_always initial_suspend() const noexcept
+	{
+		return {};
+	}
+
+	final_awaiter final_suspend() const noexcept
+	{
+		return {};
+	}
+
+	void unhandled_exception() noexcept
+	{
+		_exception = std::current_exception();
+	}
+
+	void set_continuation(std::coroutine_handle<> continuation) noexcept
+	{
+		_continuation = continuation;
+	}
+
+protected:
+	void _rethrow_if_failed() const
+	{
+		if (_exception)
+			std::rethrow_exception(_exception);
+	}
+
+private:
+	std::coroutine_handle<> _continuation = std::noop_coroutine();
+	std::exception_ptr _exception;
+};
+
+template <class _Type>
+class task_promise : public task_promise_base
+{
+public:
+	task<_Type> get_return_object() noexcept;
+
+	template <class _Value>
+		requires std::is_convertible_v<_Value&&, _Type>
+	void return_value(_Value&& value) noexcept(std::is_nothrow_constructible_v<_Type, _Value&&>)
+	{
+		_value.emplace(std::forward<_Value>(value));
+	}
+
+	_Type result()
+	{
+		_rethrow_if_failed();
+		return std::move(*_value);
+	}
+
+private:
+	std::optional<_Type> _value;
+};
+
+template <>
+class task_promise<void> : public task_promise_base
+{
+public:
+	task<void> get_return_object() noexcept;
+
+	void return_void() const noexcept
+	{
+	}
+
+	void result() const
+	{
+		_rethrow_if_failed();
+	}
+};
+
+/// <summary>
+/// Counts the completion of the children of when_all, the awaiting coroutine is counted as well,
+///	so it does not suspend at all when all children complete synchronously.
+/// </summary>
+class when_all_latch
+{
+public:
+	explicit when_all_latch(size_t children) noexcept
+		: _count(children + 1)
+	{
+	}
+
+	std::coroutine_handle<> arrive() noexcept
+	{
+		if (_count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			return _awaiting;
+
+		return std::noop_coroutine();
+	}
+
+	bool await_ready() const noexcept
+	{
+		return _count.load(std::memory_order_acquire) == 1;
+	}
+
+	bool await_suspend(std::coroutine_handle<> awaiting) noexcept
+	{
+		_awaiting = awaiting;
+		return _count.fetch_sub(1, std::memory_order_acq_rel) > 1;
+	}
+
+	void await_resume() const noexcept
+	{
+	}
+
+private:
+	std::atomic<size_t> _count;
+	std::coroutine_handle<> _awaiting;
+};
+
+/// <summary>
+/// Result or exception of one child of the combinator.
+/// </summary>
+template <class _Type>
+struct result_slot
+{
+	std::optional<non_void_t<_Type>> value;
+	std::exception_ptr exception;
+
+	non_void_t<_Type> take()
+	{
+		if (exception)
+			std::rethrow_exception(exception);
+
+		return std::move(*value);
+	}
+};
+
+/// <summary>
+/// Coroutine which awaits one child of when_all, its frame is owned and destroyed by when_all.
+/// </summary>
+class when_all_child
+{
+public:
+	struct promise_type
+	{
+		struct final_awaiter
+		{
+			bool await_ready() const noexcept
+			{
+				return false;
+			}
+
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) const noexcept
+			{
+				return handle.promise().latch->arrive();
+			}
+
+			void await_resume() const noexcept
+			{
+			}
+		};
+
+		when_all_child get_return_object() noexcept
+		{
+			return when_all_child(std::coroutine_handle<promise_type>::from_promise(*this));
+		}
+
+		std::suspend_always initial_suspend() const noexcept
+		{
+			return {};
+		}
+
+		final_awaiter final_suspend() const noexcept
+		{
+			return {};
+		}
+
+		void return_void() const noexcept
+		{
+		}
+
+		void unhandled_exception() const noexcept
+		{
+			// Exceptions of the awaited task are stored in the result slot by the child body
+			std::terminate();
+		}
+
+		when_all_latch* latch = nullptr;
+	};
+
+	when_all_child(when_all_child&& other) noexcept
+		: _handle(std::exchange(other._handle, nullptr))
+	{
+	}
+
+	when_all_child(const when_all_child&) = delete;
+	when_all_child& operator=(const when_all_child&) = delete;
+	when_all_child& operator=(when_all_child&&) = delete;
+
+	~when_all_child()
+	{
+		if (_handle)
+			_handle.destroy();
+	}
+
+	void start(when_all_latch& latch) noexcept
+	{
+		_handle.promise().latch = &latch;
+		_handle.resume();
+	}
+
+private:
+	explicit when_all_child(std::coroutine_handle<promise_type> handle) noexcept
+		: _handle(handle)
+	{
+	}
+
+private:
+	std::coroutine_handle<promise_type> _handle;
+};
+
+template <class _Type>
+when_all_child make_when_all_child(task<_Type> awaited, result_slot<_Type>& slot)
+{
+	try
+	{
+		if constexpr (std::is_void_v<_Type>)
+		{
+			co_await std::move(awaited);
+			slot.value.emplace();
+		}
+		else
+			slot.value.emplace(co_await std::move(awaited));
+	}
+	catch (...)
+	{
+		slot.exception = std::current_exception();
+	}
+}
+
+/// <summary>
+/// Shared state of when_any, it is kept alive by the awaiting coroutine and by every child which has not finished yet.
+/// </summary>
+template <class _Type>
+struct when_any_state
+{
+	std::atomic<bool> completed = false;
+	std::atomic<size_t> arrivals = 2;
+	std::coroutine_handle<> awaiting;
+	size_t index = 0;
+	result_slot<_Type> slot;
+
+	std::coroutine_handle<> arrive() noexcept
+	{
+		if (arrivals.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			return awaiting;
+
+		return std::noop_coroutine();
+	}
+};
+
+/// <summary>
+/// Coroutine which awaits one child of when_any, the frame destroys itself when the child finishes.
+/// </summary>
+class when_any_child
+{
+public:
+	struct promise_type
+	{
+		when_any_child get_return_object() noexcept
+		{
+			return when_any_child(std::coroutine_handle<promise_type>::from_promise(*this));
+		}
+
+		std::suspend_always initial_suspend() const noexcept
+		{
+			return {};
+		}
+
+		std::suspend_never final_suspend() const noexcept
+		{
+			return {};
+		}
+
+		void return_void() const noexcept
+		{
+		}
+
+		void unhandled_exception() const noexcept
+		{
+			std::terminate();
+		}
+	};
+
+	void start() noexcept
+	{
+		_handle.resume();
+	}
+
+private:
+	explicit when_any_child(std::coroutine_handle<promise_type> handle) noexcept
+		: _handle(handle)
+	{
+	}
+
+private:
+	std::coroutine_handle<promise_type> _handle;
+};
+
+/// <summary>
+/// Destroys the frame of the winning child and resumes the awaiting coroutine of when_any.
+/// </summary>
+template <class _Type>
+struct when_any_arrival
+{
+	when_any_state<_Type>* state;
+
+	bool await_ready() const noexcept
+	{
+		return false;
+	}
+
+	std::coroutine_handle<> await_suspend(std::coroutine_handle<> child) const noexcept
+	{
+		// The awaiter lives in the child frame, nothing of it may be touched after the frame is destroyed
+		auto next = state->arrive();
+		child.destroy();
+		return next;
+	}
+
+	void await_resume() const noexcept
+	{
+	}
+};
+
+template <class _Type>
+when_any_child make_when_any_child(task<_Type> awaited, std::shared_ptr<when_any_state<_Type>> state, size_t index)
+{
+	result_slot<_Type> slot;
+	try
+	{
+		if constexpr (std::is_void_v<_Type>)
+		{
+			co_await std::move(awaited);
+			slot.value.emplace();
+		}
+		else
+			slot.value.emplace(co_await std::move(awaited));
+	}
+	catch (...)
+	{
+		slot.exception = std::current_exception();
+	}
+
+	if (state->completed.exchange(true, std::memory_order_acq_rel))
+		co_return;
+
+	state->index = index;
+	state->slot = std::move(slot);
+	co_await when_any_arrival<_Type>{ state.get() };
+}
+
+/// <summary>
+/// Coroutine which lets a plain thread block on the task, its frame is owned and destroyed by sync_wait.
+/// </summary>
+class sync_wait_task
+{
+public:
+	struct promise_type
+	{
+		struct final_awaiter
+		{
+			bool await_ready() const noexcept
+			{
+				return false;
+			}
+
+			void await_suspend(std::coroutine_handle<promise_type> handle) const noexcept
+			{
+				// Notified under the lock, so the waiting thread cannot destroy the frame before the notification is done
+				auto& promise = handle.promise();
+				std::scoped_lock lck(*promise.lock);
+				*promise.done = true;
+				promise.event->notify_all();
+			}
+
+			void await_resume() const noexcept
+			{
+			}
+		};
+
+		sync_wait_task get_return_object() noexcept
+		{
+			return sync_wait_task(std::coroutine_handle<promise_type>::from_promise(*this));
+		}
+
+		std::suspend_always initial_suspend() const noexcept
+		{
+			return {};
+		}
+
+		final_awaiter final_suspend() const noexcept
+		{
+			return {};
+		}
+
+		void return_void() const noexcept
+		{
+		}
+
+		void unhandled_exception() const noexcept
+		{
+			std::terminate();
+		}
+
+		std::mutex* lock = nullptr;
+		std::condition_variable* event = nullptr;
+		bool* done = nullptr;
+	};
+
+	sync_wait_task(const sync_wait_task&) = delete;
+	sync_wait_task& operator=(const sync_wait_task&) = delete;
+
+	~sync_wait_task()
+	{
+		_handle.destroy();
+	}
+
+	void run()
+	{
+		std::mutex lock;
+		std::condition_variable event;
+		bool done = false;
+
+		auto& promise = _handle.promise();
+		promise.lock = &lock;
+		promise.event = &event;
+		promise.done = &done;
+		_handle.resume();
+
+		std::unique_lock lck(lock);
+		event.wait(lck, [&done]()
+			{
+				return done;
+			});
+	}
+
+private:
+	explicit sync_wait_task(std::coroutine_handle<promise_type> handle) noexcept
+		: _handle(handle)
+	{
+	}
+
+private:
+	std::coroutine_handle<promise_type> _handle;
+};
+
+template <class _Type>
+sync_wait_task make_sync_wait_task(task<_Type>& awaited, result_slot<_Type>& slot)
+{
+	try
+	{
+		if constexpr (std::is_void_v<_Type>)
+		{
+			co_await std::move(awaited);
+			slot.value.emplace();
+		}
+		else
+			slot.value.emplace(co_await std::move(awaited));
+	}
+	catch (...)
+	{
+		slot.exception = std::current_exception();
+	}
+}
+
+} // namespace details
+
+/// <summary>
+/// Lazily started coroutine producing _Type.
+/// The coroutine starts when it is awaited and resumes the awaiting coroutine by symmetric transfer when it finishes,
+///	on the thread where it finished - e.g. the pool worker after co_await scheduler.schedule().
+/// </summary>
+/// <example>
+/// <code>
+///  coroutine::task<int> compute(coroutine::scheduler scheduler)
+///  {
+///		co_await scheduler.schedule(); // continues on the pool
+///		co_return 42;
+///  }
+///
+///  int value = coroutine::sync_wait(compute(scheduler));
+/// </code>
+/// </example>
+template <class _Type>
+class [[nodiscard]] task
+{
+public:
+	using promise_type = details::task_promise<_Type>;
+	using value_type = _Type;
+
+private:
+	struct awaiter
+	{
+		std::coroutine_handle<promise_type> handle;
+
+		bool await_ready() const noexcept
+		{
+			return !handle || handle.done();
+		}
+
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) const noexcept
+		{
+			handle.promise().set_continuation(awaiting);
+			return handle;
+		}
+
+		_Type await_resume() const
+		{
+			if (!handle)
+				throw std::logic_error("task has no coroutine!");
+
+			return handle.promise().result();
+		}
+	};
+
+public:
+	task() noexcept = default;
+
+	explicit task(std::coroutine_handle<promise_type> handle) noexcept
+		: _handle(handle)
+	{
+	}
+
+	task(task&& other) noexcept
+		: _handle(std::exchange(other._handle, nullptr))
+	{
+	}
+
+	task& operator=(task&& other) noexcept
+	{
+		if (this != &other)
+		{
+			_destroy();
+			_handle = std::exchange(other._handle, nullptr);
+		}
+
+		return *this;
+	}
+
+	task(const task&) = delete;
+	task& operator=(const task&) = delete;
+
+	~task()
+	{
+		_destroy();
+	}
+
+	[[nodiscard]] bool valid() const noexcept
+	{
+		return static_cast<bool>(_handle);
+	}
+
+	[[nodiscard]] bool is_ready() const noexcept
+	{
+		return !_handle || _handle.done();
+	}
+
+	awaiter operator co_await() && noexcept
+	{
+		return awaiter{ _handle };
+	}
+
+private:
+	void _destroy() noexcept
+	{
+		if (_handle)
+			std::exchange(_handle, nullptr).destroy();
+	}
+
+private:
+	std::coroutine_handle<promise_type> _handle;
+};
+
+template <class _Type>
+task<_Type> details::task_promise<_Type>::get_return_object() noexcept
+{
+	return task<_Type>(std::coroutine_handle<task_promise>::from_promise(*this));
+}
+
+inline task<void> details::task_promise<void>::get_return_object() noexcept
+{
+	return task<void>(std::coroutine_handle<task_promise>::from_promise(*this));
+}
+
+/// <summary>
+/// Awaitable scheduler which resumes coroutines on the workers of sync_thread_pool.
+/// The scheduler only refers to the pool, the pool has to outlive all coroutines scheduled on it.
+/// </summary>
+class scheduler
+{
+	struct schedule_awaiter
+	{
+		sync_thread_pool& pool;
+		sync_thread_pool::task_options options;
+
+		bool await_ready() const noexcept
+		{
+			return false;
+		}
+
+		void await_suspend(std::coroutine_handle<> handle) const
+		{
+			pool.add_task(options, [handle]()
+				{
+					handle.resume();
+				});
+		}
+
+		void await_resume() const noexcept
+		{
+		}
+	};
+
+public:
+	explicit scheduler(sync_thread_pool& pool, sync_thread_pool::task_options options = {}) noexcept
+		: _pool(pool)
+		, _options(options)
+	{
+	}
+
+	/// <summary>
+	/// Suspends the awaiting coroutine and resumes it on a worker of the pool.
+	/// </summary>
+	[[nodiscard]] schedule_awaiter schedule() const noexcept
+	{
+		return { _pool, _options };
+	}
+
+	[[nodiscard]] sync_thread_pool& pool() const noexcept
+	{
+		return _pool;
+	}
+
+private:
+	sync_thread_pool& _pool;
+	const sync_thread_pool::task_options _options;
+};
+
+/// <summary>
+/// Starts all tasks concurrently and completes when all of them are finished.
+/// Void tasks yield std::monostate, the first exception in the order of arguments is rethrown after all tasks are finished.
+/// </summary>
+template <class... _Types>
+task<std::tuple<details::non_void_t<_Types>...>> when_all(task<_Types>... tasks)
+{
+	std::tuple<details::result_slot<_Types>...> slots;
+	details::when_all_latch latch(sizeof...(_Types));
+
+	auto children = [&]<size_t... _Index>(std::index_sequence<_Index...>)
+	{
+		return std::array<details::when_all_child, sizeof...(_Types)>{ details::make_when_all_child(std::move(tasks), std::get<_Index>(slots))... };
+	}(std::index_sequence_for<_Types...>{});
+
+	for (auto& child : children)
+		child.start(latch);
+
+	co_await latch;
+	co_return std::apply([](auto&... slot)
+		{
+			return std::tuple<details::non_void_t<_Types>...>{ slot.take()... };
+		},
+		slots);
+}
+
+/// <summary>
+/// Starts all tasks concurrently and completes when all of them are finished.
+/// </summary>
+/// <returns>Results in the order of the input, the first exception in this order is rethrown after all tasks are finished.</returns>
+template <class _Type>
+task<std::vector<details::non_void_t<_Type>>> when_all(std::vector<task<_Type>> tasks)
+{
+	std::vector<details::result_slot<_Type>> slots(tasks.size());
+	details::when_all_latch latch(tasks.size());
+
+	std::vector<details::when_all_child> children;
+	children.reserve(tasks.size());
+	for (size_t i = 0; i < tasks.size(); i++)
+		children.emplace_back(details::make_when_all_child(std::move(tasks[i]), slots[i]));
+
+	for (auto& child : children)
+		child.start(latch);
+
+	co_await latch;
+
+	std::vector<details::non_void_t<_Type>> results;
+	results.reserve(slots.size());
+	for (auto& slot : slots)
+		results.emplace_back(slot.take());
+
+	co_return results;
+}
+
+template <class _Type>
+struct when_any_result
+{
+	size_t index = 0;
+	details::non_void_t<_Type> value;
+};
+
+/// <summary>
+/// Starts all tasks concurrently and completes with the first finished one, exception of the first finished task is rethrown.
+/// The other tasks are not cancelled, they run to completion in the background and their results are dropped.
+/// </summary>
+/// <exception cref="std::invalid_argument">When there is no task.</exception>
+template <class _Type>
+task<when_any_result<_Type>> when_any(std::vector<task<_Type>> tasks)
+{
+	if (tasks.empty())
+		throw std::invalid_argument("when_any requires at least one task!");
+
+	auto state = std::make_shared<details::when_any_state<_Type>>();
+	for (size_t i = 0; i < tasks.size(); i++)
+		details::make_when_any_child(std::move(tasks[i]), state, i).start();
+
+	struct awaiter
+	{
+		details::when_any_state<_Type>& state;
+
+		bool await_ready() const noexcept
+		{
+			return false;
+		}
+
+		bool await_suspend(std::coroutine_handle<> awaiting) const noexcept
+		{
+			state.awaiting = awaiting;
+			return state.arrivals.fetch_sub(1, std::memory_order_acq_rel) > 1;
+		}
+
+		void await_resume() const noexcept
+		{
+		}
+	};
+
+	co_await awaiter{ *state };
+	co_return when_any_result<_Type>{ state->index, state->slot.take() };
+}
+
+/// <summary>
+/// Starts the task and blocks the calling thread until it is finished.
+/// </summary>
+template <class _Type>
+_Type sync_wait(task<_Type> awaited)
+{
+	details::result_slot<_Type> slot;
+	details::make_sync_wait_task(awaited, slot).run();
+
+	if constexpr (std::is_void_v<_Type>)
+		slot.take();
+	else
+		return slot.take();
+}
+
+} // namespace janecekvit::thread::coroutine
+
+#endif // defined(HAS_JTHREAD)
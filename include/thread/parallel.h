@@ -0,0 +1,264 @@
+/*
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2025 Vit janecek <mailto:janecekvit@outlook.com>.
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+parallel.h
+Purpose: header file of data-parallel algorithms executed on thread pools
+
+@author: Vit Janecek
+@mailto: janecekvit@outlook.com
+@version 1.00 16/10/2026
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace janecekvit::thread
+{
+/// <summary>
+/// Concept for thread pools usable by data-parallel algorithms (sync_thread_pool, work_stealing_thread_pool)
+/// </summary>
+template <class _Pool>
+concept thread_pool_type = requires(_Pool& pool) {
+	{ pool.pool_size() } -> std::convertible_to<size_t>;
+	pool.add_task([]()
+		{
+		});
+};
+
+namespace details
+{
+/// <summary>
+/// Shared state of one fork-join execution, it outlives the caller when a helper task is started after all chunks are done.
+/// </summary>
+struct fork_join_state
+{
+	std::atomic<size_t> next_chunk = 0;
+	std::atomic<size_t> done_chunks = 0;
+	std::atomic_flag failed;
+	std::exception_ptr exception;
+};
+
+inline size_t automatic_grain_size(size_t count, size_t pool_size) noexcept
+{
+	// Roughly four chunks per participating thread (workers + caller) to balance uneven chunk costs
+	constexpr size_t chunks_per_thread = 4;
+	return std::max<size_t>(1, count / ((pool_size + 1) * chunks_per_thread));
+}
+
+/// <summary>
+/// Splits [0, count) into chunks of grain_size elements and executes them on the pool.
+/// The calling thread executes chunks as well and then waits until the chunks claimed by workers are finished,
+/// so the algorithm makes progress even when called from a pool worker or when all workers are busy.
+/// The first exception thrown by a chunk cancels the chunks which have not been started yet and is rethrown to the caller.
+/// </summary>
+template <thread_pool_type _Pool, class _ChunkFn>
+	requires std::is_invocable_v<_ChunkFn&, size_t, size_t, size_t>
+void fork_join(_Pool& pool, size_t count, size_t grain_size, _ChunkFn& chunk)
+{
+	if (count == 0)
+		return;
+
+	if (grain_size == 0)
+		grain_size = automatic_grain_size(count, pool.pool_size());
+
+	const size_t chunks = (count + grain_size - 1) / grain_size;
+	auto state = std::make_shared<fork_join_state>();
+
+	auto execute = [state, &chunk, count, grain_size, chunks]()
+	{
+		for (;;)
+		{
+			const auto index = state->next_chunk.fetch_add(1, std::memory_order_relaxed);
+			if (index >= chunks)
+				return;
+
+			try
+			{
+				if (!state->failed.test(std::memory_order_acquire))
+				{
+					const auto begin = index * grain_size;
+					chunk(begin, std::min(begin + grain_size, count), index);
+				}
+			}
+			catch (...)
+			{
+				if (!state->failed.test_and_set(std::memory_order_acq_rel))
+					state->exception = std::current_exception();
+			}
+
+			if (state->done_chunks.fetch_add(1, std::memory_order_acq_rel) + 1 == chunks)
+				state->done_chunks.notify_all();
+		}
+	};
+
+	// The caller takes part in the execution, so one worker less is needed
+	const auto helpers = std::min(pool.pool_size(), chunks - 1);
+	for (size_t i = 0; i < helpers; i++)
+		pool.add_task(execute);
+
+	execute();
+
+	auto done = state->done_chunks.load(std::memory_order_acquire);
+	while (done != chunks)
+	{
+		state->done_chunks.wait(done, std::memory_order_acquire);
+		done = state->done_chunks.load(std::memory_order_acquire);
+	}
+
+	if (state->exception)
+		std::rethrow_exception(state->exception);
+}
+
+} // namespace details
+
+/// <summary>
+/// Invokes fn for every element of the random-access range in parallel.
+/// </summary>
+/// <param name="grain_size">Number of elements processed by one task, 0 selects the grain size automatically.</param>
+template <thread_pool_type _Pool, std::ranges::random_access_range _Range, class _Fn>
+	requires std::ranges::sized_range<_Range> && std::is_invocable_v<_Fn&, std::ranges::range_reference_t<_Range>>
+void parallel_for(_Pool& pool, _Range&& range, _Fn&& fn, size_t grain_size = 0)
+{
+	using difference_type = std::ranges::range_difference_t<_Range>;
+
+	auto first = std::ranges::begin(range);
+	auto chunk = [&first, &fn](size_t begin, size_t end, size_t)
+	{
+		const auto last = first + static_cast<difference_type>(end);
+		for (auto it = first + static_cast<difference_type>(begin); it != last; ++it)
+			std::invoke(fn, *it);
+	};
+
+	details::fork_join(pool, static_cast<size_t>(std::ranges::size(range)), grain_size, chunk);
+}
+
+/// <summary>
+/// Invokes fn for every index of [first, last) in parallel.
+/// </summary>
+/// <param name="grain_size">Number of indexes processed by one task, 0 selects the grain size automatically.</param>
+template <thread_pool_type _Pool, std::integral _Index, class _Fn>
+	requires std::is_invocable_v<_Fn&, _Index>
+void parallel_for(_Pool& pool, _Index first, _Index last, _Fn&& fn, size_t grain_size = 0)
+{
+	if (last <= first)
+		return;
+
+	parallel_for(pool, std::views::iota(first, last), std::forward<_Fn>(fn), grain_size);
+}
+
+/// <summary>
+/// Reduces transformed elements of the random-access range in parallel.
+/// Every chunk is reduced separately, the partial results are combined with init in the order of the range,
+/// so the reduce operation has to be associative but does not have to be commutative.
+/// </summary>
+/// <param name="grain_size">Number of elements processed by one task, 0 selects the grain size automatically.</param>
+template <thread_pool_type _Pool, std::ranges::random_access_range _Range, class _Type, class _Reduce, class _Transform = std::identity>
+	requires std::ranges::sized_range<_Range>
+	&& std::is_invocable_v<_Transform&, std::ranges::range_reference_t<_Range>>
+	&& std::is_invocable_r_v<_Type, _Reduce&, _Type, std::invoke_result_t<_Transform&, std::ranges::range_reference_t<_Range>>>
+[[nodiscard]] _Type parallel_reduce(_Pool& pool, _Range&& range, _Type init, _Reduce&& reduce, _Transform&& transform = {}, size_t grain_size = 0)
+{
+	const auto count = static_cast<size_t>(std::ranges::size(range));
+	if (count == 0)
+		return init;
+
+	if (grain_size == 0)
+		grain_size = details::automatic_grain_size(count, pool.pool_size());
+
+	using difference_type = std::ranges::range_difference_t<_Range>;
+
+	std::vector<std::optional<_Type>> partials((count + grain_size - 1) / grain_size);
+	auto first = std::ranges::begin(range);
+	auto chunk = [&](size_t begin, size_t end, size_t index)
+	{
+		const auto last = first + static_cast<difference_type>(end);
+		auto it = first + static_cast<difference_type>(begin);
+		_Type partial = std::invoke(transform, *it);
+		for (++it; it != last; ++it)
+			partial = std::invoke(reduce, std::move(partial), std::invoke(transform, *it));
+
+		partials[index].emplace(std::move(partial));
+	};
+
+	details::fork_join(pool, count, grain_size, chunk);
+
+	for (auto& partial : partials)
+		init = std::invoke(reduce, std::move(init), std::move(*partial));
+
+	return init;
+}
+
+/// <summary>
+/// Reduces transformed indexes of [first, last) in parallel.
+/// </summary>
+/// <param name="grain_size">Number of indexes processed by one task, 0 selects the grain size automatically.</param>
+template <thread_pool_type _Pool, std::integral _Index, class _Type, class _Reduce, class _Transform = std::identity>
+	requires std::is_invocable_v<_Transform&, _Index> && std::is_invocable_r_v<_Type, _Reduce&, _Type, std::invoke_result_t<_Transform&, _Index>>
+[[nodiscard]] _Type parallel_reduce(_Pool& pool, _Index first, _Index last, _Type init, _Reduce&& reduce, _Transform&& transform = {}, size_t grain_size = 0)
+{
+	if (last <= first)
+		return init;
+
+	return parallel_reduce(pool, std::views::iota(first, last), std::move(init), std::forward<_Reduce>(reduce), std::forward<_Transform>(transform), grain_size);
+}
+
+/// <summary>
+/// Writes fn(element) of every element of the random-access range to the output in parallel.
+/// </summary>
+/// <param name="grain_size">Number of elements processed by one task, 0 selects the grain size automatically.</param>
+/// <returns>Iterator past the last written element.</returns>
+template <thread_pool_type _Pool, std::ranges::random_access_range _Range, std::random_access_iterator _OutIt, class _Fn>
+	requires std::ranges::sized_range<_Range>
+	&& std::is_invocable_v<_Fn&, std::ranges::range_reference_t<_Range>>
+	&& std::indirectly_writable<_OutIt, std::invoke_result_t<_Fn&, std::ranges::range_reference_t<_Range>>>
+_OutIt parallel_transform(_Pool& pool, _Range&& range, _OutIt output, _Fn&& fn, size_t grain_size = 0)
+{
+	using difference_type = std::ranges::range_difference_t<_Range>;
+	using output_difference_type = std::iter_difference_t<_OutIt>;
+
+	const auto count = static_cast<size_t>(std::ranges::size(range));
+	auto first = std::ranges::begin(range);
+	auto chunk = [&](size_t begin, size_t end, size_t)
+	{
+		const auto last = first + static_cast<difference_type>(end);
+		auto out = output + static_cast<output_difference_type>(begin);
+		for (auto it = first + static_cast<difference_type>(begin); it != last; ++it, ++out)
+			*out = std::invoke(fn, *it);
+	};
+
+	details::fork_join(pool, count, grain_size, chunk);
+	return output + static_cast<output_difference_type>(count);
+}
+
+} // namespace janecekvit::thread
@@ -0,0 +1,646 @@
+/*
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2025 Vit janecek <mailto:janecekvit@outlook.com>.
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+pooled_future.h
+Purpose: header file of lightweight future with shared state recycled by thread pool
+
+@author: Vit Janecek
+@mailto: janecekvit@outlook.com
+@version 1.00 16/10/2026
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace janecekvit::thread
+{
+template <class _Type>
+class pooled_future;
+
+namespace details
+{
+class pooled_state_allocator;
+struct pooled_future_access;
+
+template <class _Type>
+using pooled_value_t = std::conditional_t<std::is_void_v<_Type>, std::monostate, _Type>;
+
+/// <summary>
+/// Type-erased shared state of pooled_future.
+/// The callable and the result are stored inline when they fit into the state, otherwise they are boxed on the heap.
+/// States are never freed while the owning allocator lives, they are returned to its free list instead.
+/// </summary>
+class pooled_state
+{
+	friend class pooled_state_allocator;
+
+	template <class>
+	friend class thread::pooled_future;
+
+	friend struct pooled_future_access;
+
+public:
+	static constexpr size_t inline_size = 64;
+
+	template <class _Type>
+	static constexpr bool is_stored_inline = sizeof(_Type) <= inline_size && alignof(_Type) <= alignof(std::max_align_t);
+
+	/// <summary>
+	/// Stores the callable producing _Result, references are held by the returned future and by the pending execution.
+	/// </summary>
+	template <class _Result, class _Fn>
+	void emplace_task(_Fn&& fn)
+	{
+		using callable_type = std::decay_t<_Fn>;
+
+		_emplace<callable_type>(_callable, std::forward<_Fn>(fn));
+		_references.store(2, std::memory_order_relaxed);
+		_dependencies.store(1, std::memory_order_relaxed);
+		_destroy_callable = &_destroy<callable_type>;
+		_invoke = [](pooled_state& state) noexcept
+		{
+			try
+			{
+				auto& callable = _access<callable_type>(state._callable);
+				if constexpr (std::is_void_v<_Result>)
+					std::invoke(callable);
+				else
+				{
+					_emplace<_Result>(state._result, std::invoke(callable));
+					state._destroy_result = &_destroy<_Result>;
+				}
+			}
+			catch (...)
+			{
+				state._exception = std::current_exception();
+			}
+		};
+	}
+
+	/// <summary>
+	/// Executes stored callable, publishes the result and schedules the registered continuation.
+	/// </summary>
+	static void run(pooled_state& state) noexcept
+	{
+		state._invoke(state);
+		state._destroy_callable(state._callable);
+		state._invoke = nullptr;
+		state._destroy_callable = nullptr;
+
+		state._status.store(ready, std::memory_order_release);
+		state._status.notify_all();
+
+		if (auto* next = state._continuation.exchange(_completed_marker(), std::memory_order_acq_rel))
+			_arrive(*next);
+
+		release(state);
+	}
+
+	/// <summary>
+	/// Makes the next state a continuation of the previous one, the next state is scheduled once all its predecessors completed.
+	/// </summary>
+	static void continue_with(pooled_state& previous, pooled_state& next) noexcept
+	{
+		pooled_state* expected = nullptr;
+		if (!previous._continuation.compare_exchange_strong(expected, &next, std::memory_order_acq_rel, std::memory_order_acquire))
+			_arrive(next);
+	}
+
+	static void release(pooled_state& state) noexcept;
+
+private:
+	enum status : uint32_t
+	{
+		pending,
+		ready
+	};
+
+	static pooled_state* _completed_marker() noexcept
+	{
+		// Never dereferenced, it only marks that no continuation can be registered anymore
+		return reinterpret_cast<pooled_state*>(std::uintptr_t{ 1 });
+	}
+
+	static void _schedule(pooled_state& state) noexcept;
+
+	static void _arrive(pooled_state& state) noexcept
+	{
+		if (state._dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			_schedule(state);
+	}
+
+	template <class _Type, class... _Args>
+	static void _emplace(std::byte* storage, _Args&&... args)
+	{
+		if constexpr (is_stored_inline<_Type>)
+			std::construct_at(reinterpret_cast<_Type*>(storage), std::forward<_Args>(args)...);
+		else
+			std::construct_at(reinterpret_cast<_Type**>(storage), new _Type(std::forward<_Args>(args)...));
+	}
+
+	template <class _Type>
+	static _Type& _access(std::byte* storage) noexcept
+	{
+		if constexpr (is_stored_inline<_Type>)
+			return *std::launder(reinterpret_cast<_Type*>(storage));
+		else
+			return **std::launder(reinterpret_cast<_Type**>(storage));
+	}
+
+	template <class _Type>
+	static void _destroy(std::byte* storage) noexcept
+	{
+		if constexpr (is_stored_inline<_Type>)
+			std::destroy_at(&_access<_Type>(storage));
+		else
+			delete &_access<_Type>(storage);
+	}
+
+	void _wait() const noexcept
+	{
+		while (_status.load(std::memory_order_acquire) != ready)
+			_status.wait(pending, std::memory_order_acquire);
+	}
+
+	bool _is_ready() const noexcept
+	{
+		return _status.load(std::memory_order_acquire) == ready;
+	}
+
+	void _reset() noexcept
+	{
+		if (_destroy_callable)
+			_destroy_callable(_callable);
+
+		if (_destroy_result)
+			_destroy_result(_result);
+
+		_invoke = nullptr;
+		_destroy_callable = nullptr;
+		_destroy_result = nullptr;
+		_exception = nullptr;
+		_continuation.store(nullptr, std::memory_order_relaxed);
+		_dependencies.store(0, std::memory_order_relaxed);
+		_status.store(pending, std::memory_order_relaxed);
+	}
+
+private:
+	alignas(std::max_align_t) std::byte _callable[inline_size];
+	alignas(std::max_align_t) std::byte _result[inline_size];
+
+	void (*_invoke)(pooled_state&) noexcept = nullptr;
+	void (*_destroy_callable)(std::byte*) noexcept = nullptr;
+	void (*_destroy_result)(std::byte*) noexcept = nullptr;
+	std::exception_ptr _exception;
+
+	std::atomic<uint32_t> _references = 0;
+	std::atomic<uint32_t> _status = pending;
+	std::atomic<uint32_t> _dependencies = 0;
+	std::atomic<pooled_state*> _continuation = nullptr;
+
+	pooled_state_allocator* _allocator = nullptr;
+	pooled_state* _next_free = nullptr;
+};
+
+/// <summary>
+/// Per-pool free list of pooled states, new states are allocated in blocks only when the free list is empty.
+/// The thread pool detaches the allocator on its destruction, the allocator is then freed with the last outstanding state,
+///	so futures may outlive the pool.
+/// </summary>
+class pooled_state_allocator
+{
+	friend class pooled_state;
+
+public:
+	using scheduler = void (*)(void* context, pooled_state& state) noexcept;
+
+	struct detacher
+	{
+		void operator()(pooled_state_allocator* allocator) const noexcept
+		{
+			allocator->_detach();
+		}
+	};
+
+	static constexpr size_t block_size = 32;
+
+	pooled_state_allocator(void* context, scheduler schedule_state) noexcept
+		: _context(context)
+		, _schedule(schedule_state)
+	{
+	}
+
+	pooled_state_allocator(const pooled_state_allocator&) = delete;
+	pooled_state_allocator& operator=(const pooled_state_allocator&) = delete;
+
+	[[nodiscard]] pooled_state& acquire()
+	{
+		std::scoped_lock lck(_lock);
+		if (!_free)
+			_grow();
+
+		auto* state = _free;
+		_free = state->_next_free;
+		state->_next_free = nullptr;
+		_outstanding++;
+		return *state;
+	}
+
+	/// <summary>
+	/// Takes the state from the free list and stores the callable in it.
+	/// When storing throws (e.g. the boxed callable cannot be allocated or moved), the state is returned to the free list.
+	/// </summary>
+	template <class _Result, class _Fn>
+	[[nodiscard]] pooled_state& acquire_task(_Fn&& fn)
+	{
+		auto& state = acquire();
+		try
+		{
+			state.template emplace_task<_Result>(std::forward<_Fn>(fn));
+		}
+		catch (...)
+		{
+			_recycle(state);
+			throw;
+		}
+
+		return state;
+	}
+
+	void schedule(pooled_state& state) noexcept
+	{
+		// Pool has been already destroyed, execute continuation on the current thread
+		if (_detached.load(std::memory_order_acquire))
+			return pooled_state::run(state);
+
+		_schedule(_context, state);
+	}
+
+private:
+	~pooled_state_allocator() = default;
+
+	void _grow()
+	{
+		auto block = std::make_unique<pooled_state[]>(block_size);
+		for (size_t i = 0; i < block_size; i++)
+		{
+			block[i]._allocator = this;
+			block[i]._next_free = _free;
+			_free = &block[i];
+		}
+
+		_blocks.emplace_back(std::move(block));
+	}
+
+	void _recycle(pooled_state& state) noexcept
+	{
+		bool destroy = false;
+		{
+			std::scoped_lock lck(_lock);
+			state._next_free = _free;
+			_free = &state;
+			_outstanding--;
+			destroy = _detached.load(std::memory_order_relaxed) && _outstanding == 0;
+		}
+
+		if (destroy)
+			delete this;
+	}
+
+	void _detach() noexcept
+	{
+		bool destroy = false;
+		{
+			std::scoped_lock lck(_lock);
+			_detached.store(true, std::memory_order_release);
+			destroy = _outstanding == 0;
+		}
+
+		if (destroy)
+			delete this;
+	}
+
+private:
+	void* const _context;
+	const scheduler _schedule;
+
+	std::mutex _lock;
+	pooled_state* _free = nullptr;
+	size_t _outstanding = 0;
+	std::atomic<bool> _detached = false;
+	std::vector<std::unique_ptr<pooled_state[]>> _blocks;
+};
+
+inline void pooled_state::release(pooled_state& state) noexcept
+{
+	if (state._references.fetch_sub(1, std::memory_order_acq_rel) != 1)
+		return;
+
+	state._reset();
+	state._allocator->_recycle(state);
+}
+
+inline void pooled_state::_schedule(pooled_state& state) noexcept
+{
+	state._allocator->schedule(state);
+}
+
+} // namespace details
+
+/// <summary>
+/// Lightweight future returned by thread pool, its shared state is taken from the free list of the pool.
+/// Like std::future it is move-only and get() can be called only once.
+/// Continuations registered by then(), on_error() and when_all() are scheduled to the pool directly by the thread which completes the predecessor,
+///	so no worker is blocked in get() between the stages of a pipeline.
+/// </summary>
+template <class _Type>
+class [[nodiscard]] pooled_future
+{
+	template <class>
+	friend class pooled_future;
+
+	friend class sync_thread_pool;
+	friend struct details::pooled_future_access;
+
+public:
+	using value_type = _Type;
+
+public:
+	pooled_future() noexcept = default;
+
+	pooled_future(const pooled_future&) = delete;
+	pooled_future& operator=(const pooled_future&) = delete;
+
+	pooled_future(pooled_future&& other) noexcept
+		: _state(std::exchange(other._state, nullptr))
+	{
+	}
+
+	pooled_future& operator=(pooled_future&& other) noexcept
+	{
+		if (this != &other)
+		{
+			_release();
+			_state = std::exchange(other._state, nullptr);
+		}
+
+		return *this;
+	}
+
+	~pooled_future()
+	{
+		_release();
+	}
+
+	[[nodiscard]] bool valid() const noexcept
+	{
+		return _state != nullptr;
+	}
+
+	[[nodiscard]] bool is_ready() const
+	{
+		_check_state();
+		return _state->_is_ready();
+	}
+
+	void wait() const
+	{
+		_check_state();
+		_state->_wait();
+	}
+
+	/// <summary>
+	/// Waits for the result and moves it out of the shared state, the future is not valid afterwards.
+	/// </summary>
+	_Type get()
+	{
+		_check_state();
+		_state->_wait();
+
+		auto* state = std::exchange(_state, nullptr);
+		auto release = [state]() noexcept
+		{
+			details::pooled_state::release(*state);
+		};
+
+		if (state->_exception)
+		{
+			auto exception = state->_exception;
+			release();
+			std::rethrow_exception(exception);
+		}
+
+		if constexpr (std::is_void_v<_Type>)
+			release();
+		else
+		{
+			_Type result = std::move(details::pooled_state::_access<_Type>(state->_result));
+			release();
+			return result;
+		}
+	}
+
+	/// <summary>
+	/// Registers continuation invoked with the result of this future (or without arguments for void),
+	/// the future is not valid afterwards. Exception of the predecessor is propagated to the returned future without invoking fn.
+	/// </summary>
+	template <class _Fn>
+	[[nodiscard]] auto then(_Fn&& fn)
+	{
+		using result_type = typename std::conditional_t<std::is_void_v<_Type>, std::invoke_result<_Fn>, std::invoke_result<_Fn, _Type>>::type;
+
+		return _continue_with<result_type>([callable = std::forward<_Fn>(fn)](pooled_future& predecessor) mutable -> result_type
+			{
+				if constexpr (std::is_void_v<_Type>)
+				{
+					predecessor.get();
+					return std::invoke(callable);
+				}
+				else
+					return std::invoke(callable, predecessor.get());
+			});
+	}
+
+	/// <summary>
+	/// Registers continuation invoked with the exception of this future, its result replaces the failed result.
+	/// The result of the successful predecessor is passed to the returned future without invoking fn, the future is not valid afterwards.
+	/// </summary>
+	template <class _Fn>
+		requires std::is_invocable_r_v<_Type, _Fn, std::exception_ptr>
+	[[nodiscard]] pooled_future on_error(_Fn&& fn)
+	{
+		return _continue_with<_Type>([callable = std::forward<_Fn>(fn)](pooled_future& predecessor) mutable -> _Type
+			{
+				try
+				{
+					return predecessor.get();
+				}
+				catch (...)
+				{
+					return std::invoke(callable, std::current_exception());
+				}
+			});
+	}
+
+private:
+	explicit pooled_future(details::pooled_state& state) noexcept
+		: _state(&state)
+	{
+	}
+
+	void _check_state() const
+	{
+		if (!_state)
+			throw std::future_error(std::future_errc::no_state);
+	}
+
+	void _release() noexcept
+	{
+		if (_state)
+			details::pooled_state::release(*std::exchange(_state, nullptr));
+	}
+
+	template <class _Result, class _Fn>
+	pooled_future<_Result> _continue_with(_Fn&& fn)
+	{
+		_check_state();
+		auto* previous = _state;
+		auto& next = previous->_allocator->template acquire_task<_Result>([predecessor = std::move(*this), callable = std::forward<_Fn>(fn)]() mutable -> _Result
+			{
+				return callable(predecessor);
+			});
+
+		pooled_future<_Result> future(next);
+		details::pooled_state::continue_with(*previous, next);
+		return future;
+	}
+
+private:
+	details::pooled_state* _state = nullptr;
+};
+
+namespace details
+{
+struct pooled_future_access
+{
+	template <class _Type>
+	static pooled_state& state(const pooled_future<_Type>& future)
+	{
+		future._check_state();
+		return *future._state;
+	}
+
+	template <class _Type>
+	static pooled_value_t<_Type> take(pooled_future<_Type>& future)
+	{
+		if constexpr (std::is_void_v<_Type>)
+		{
+			future.get();
+			return {};
+		}
+		else
+			return future.get();
+	}
+
+	/// <summary>
+	/// Creates the state which is scheduled once all predecessors completed, fn owns the futures of the predecessors.
+	/// </summary>
+	template <class _Result, class _Fn>
+	static pooled_future<_Result> join(const std::vector<pooled_state*>& predecessors, _Fn&& fn)
+	{
+		auto& next = predecessors.front()->_allocator->template acquire_task<_Result>(std::forward<_Fn>(fn));
+		next._dependencies.store(static_cast<uint32_t>(predecessors.size()), std::memory_order_relaxed);
+
+		pooled_future<_Result> future(next);
+		for (auto* previous : predecessors)
+			pooled_state::continue_with(*previous, next);
+
+		return future;
+	}
+};
+} // namespace details
+
+/// <summary>
+/// Returns future completed with the results of all futures (std::monostate for void), no thread waits for the predecessors.
+/// The first exception in the order of the arguments is propagated to the returned future.
+/// </summary>
+/// <exception cref="std::future_error">When any future is not valid.</exception>
+template <class... _Types>
+	requires(sizeof...(_Types) > 0)
+[[nodiscard]] pooled_future<std::tuple<details::pooled_value_t<_Types>...>> when_all(pooled_future<_Types>... futures)
+{
+	using result_type = std::tuple<details::pooled_value_t<_Types>...>;
+
+	std::vector<details::pooled_state*> predecessors = { &details::pooled_future_access::state(futures)... };
+	return details::pooled_future_access::join<result_type>(predecessors, [... futures = std::move(futures)]() mutable
+		{
+			// Braced initialization keeps the order of the arguments, so the first exception wins
+			return result_type{ details::pooled_future_access::take(futures)... };
+		});
+}
+
+/// <summary>
+/// Returns future completed with the results of all futures in their order, no thread waits for the predecessors.
+/// </summary>
+/// <exception cref="std::invalid_argument">When there is no future.</exception>
+/// <exception cref="std::future_error">When any future is not valid.</exception>
+template <class _Type>
+[[nodiscard]] pooled_future<std::vector<details::pooled_value_t<_Type>>> when_all(std::vector<pooled_future<_Type>> futures)
+{
+	using result_type = std::vector<details::pooled_value_t<_Type>>;
+
+	if (futures.empty())
+		throw std::invalid_argument("when_all requires at least one future!");
+
+	std::vector<details::pooled_state*> predecessors;
+	predecessors.reserve(futures.size());
+	for (const auto& future : futures)
+		predecessors.emplace_back(&details::pooled_future_access::state(future));
+
+	return details::pooled_future_access::join<result_type>(predecessors, [futures = std::move(futures)]() mutable
+		{
+			result_type results;
+			results.reserve(futures.size());
+			for (auto& future : futures)
+				results.emplace_back(details::pooled_future_access::take(future));
+
+			return results;
+		});
+}
+
+} // namespace janecekvit::thread
@@ -31,15 +31,27 @@ Purpose: header file of static thread pool class
 #pragma once
 
 #include "compatibility/compiler_support.h"
+#include "thread/pooled_future.h"
+#include "thread/worker_placement.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstddef>
+#include <deque>
 #include <functional>
 #include <future>
+#include <limits>
 #include <list>
+#include <memory>
 #include <mutex>
-#include <queue>
+#include <optional>
 #include <ranges>
+#include <stdexcept>
 #include <thread>
+#include <utility>
+#include <vector>
 
 namespace janecekvit::thread
 {
@@ -56,19 +68,29 @@ public:
 	using task = std::move_only_function<void()>;
 #else
 
+	/// <summary>
+	/// Fallback of std::move_only_function. Nothrow movable callables which fit into the buffer of inline_size bytes are stored inline,
+	/// larger callables are boxed on the heap and only the owning pointer is stored in the buffer.
+	/// </summary>
 	class move_only_function
 	{
+	public:
+		static constexpr size_t inline_size = 64;
+
+	private:
 		struct callable_base
 		{
 			virtual ~callable_base() = default;
 			virtual void operator()() = 0;
+			virtual callable_base* move_to(std::byte* storage) noexcept = 0;
 		};
 
 		template <typename _Fn>
 		struct callable : callable_base
 		{
-			callable(_Fn&& f)
-				: _function(std::move(f))
+			template <typename _F>
+			callable(_F&& f)
+				: _function(std::forward<_F>(f))
 			{
 			}
 
@@ -77,29 +99,73 @@ public:
 				_function();
 			}
 
+			callable_base* move_to(std::byte* storage) noexcept override
+			{
+				return std::construct_at(reinterpret_cast<callable*>(storage), std::move(_function));
+			}
+
 		private:
 			_Fn _function;
 		};
 
+		template <typename _Fn>
+		struct boxed_callable : callable_base
+		{
+			boxed_callable(std::unique_ptr<_Fn>&& f) noexcept
+				: _function(std::move(f))
+			{
+			}
+
+			void operator()() override
+			{
+				(*_function)();
+			}
+
+			callable_base* move_to(std::byte* storage) noexcept override
+			{
+				return std::construct_at(reinterpret_cast<boxed_callable*>(storage), std::move(_function));
+			}
+
+		private:
+			std::unique_ptr<_Fn> _function;
+		};
+
+		template <typename _Fn>
+		static constexpr bool _is_stored_inline = sizeof(callable<_Fn>) <= inline_size
+			&& alignof(callable<_Fn>) <= alignof(std::max_align_t)
+			&& std::is_nothrow_move_constructible_v<_Fn>;
+
 	public:
 		move_only_function() = default;
-		virtual ~move_only_function() = default;
+
+		virtual ~move_only_function()
+		{
+			_reset();
+		}
 
 		template <typename _F>
+			requires(!std::is_same_v<std::remove_cvref_t<_F>, move_only_function>)
 		move_only_function(_F&& f)
-			: _function(std::make_unique<callable<_F>>(std::move(f)))
 		{
+			using function_type = std::decay_t<_F>;
+			if constexpr (_is_stored_inline<function_type>)
+				_function = std::construct_at(reinterpret_cast<callable<function_type>*>(_storage), std::forward<_F>(f));
+			else
+				_function = std::construct_at(reinterpret_cast<boxed_callable<function_type>*>(_storage), std::make_unique<function_type>(std::forward<_F>(f)));
 		}
 
 		move_only_function(move_only_function&& other) noexcept
-			: _function(std::move(other._function))
 		{
+			_move_from(other);
 		}
 
 		move_only_function& operator=(move_only_function&& other) noexcept
 		{
 			if (this != &other)
-				_function = std::move(other._function);
+			{
+				_reset();
+				_move_from(other);
+			}
 			return *this;
 		}
 
@@ -118,46 +184,293 @@ public:
 		}
 
 	private:
-		std::unique_ptr<callable_base> _function;
+		void _move_from(move_only_function& other) noexcept
+		{
+			if (!other._function)
+				return;
+
+			_function = other._function->move_to(_storage);
+			other._reset();
+		}
+
+		void _reset() noexcept
+		{
+			if (_function)
+				std::destroy_at(std::exchange(_function, nullptr));
+		}
+
+	private:
+		alignas(std::max_align_t) std::byte _storage[inline_size];
+		callable_base* _function = nullptr;
 	};
 
 	using task = move_only_function;
 #endif // __cpp_lib_move_only_function
 
+	using clock = std::chrono::steady_clock;
+
+	static constexpr size_t any_node = std::numeric_limits<size_t>::max();
+
+	/// <summary>
+	/// Scheduling options of the submitted task.
+	/// Tasks of the higher priority level are executed first, within one level the tasks with deadline are executed
+	///	in the earliest-deadline-first order before the tasks without deadline, which are executed in FIFO order.
+	/// Tasks submitted to a node of the worker placement, given by its identifier (worker_placement::node_id), are executed only by the workers pinned to that node.
+	/// </summary>
+	struct task_options
+	{
+		size_t priority = 0;
+		clock::time_point deadline = clock::time_point::max();
+		size_t node = any_node;
+	};
+
+	/// <summary>
+	/// Options of the elastic pool.
+	/// A worker is spawned on submission or dequeue when no worker is idle and the oldest queued task waits longer than latency_threshold,
+	///	a worker idle for idle_timeout is retired, the number of workers stays within [min_workers, max_workers].
+	/// </summary>
+	struct elastic_options
+	{
+		size_t min_workers = 1;
+		size_t max_workers = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+		clock::duration latency_threshold = std::chrono::milliseconds(10);
+		clock::duration idle_timeout = std::chrono::seconds(30);
+	};
+
+private:
+	/// <summary>
+	/// Queue of pending tasks with one FIFO and one deadline heap per priority level.
+	/// In the single-priority case without deadlines, push and pop cost the same as std::queue.
+	/// The queue of the elastic pool also keeps the enqueue times in the order of submission, so the wait of the oldest task is known in O(1).
+	/// </summary>
+	class task_queue
+	{
+		struct queued_task
+		{
+			size_t ticket = 0;
+			task function;
+		};
+
+		struct deadline_task
+		{
+			clock::time_point deadline;
+			size_t sequence = 0;
+			size_t ticket = 0;
+			task function;
+		};
+
+		struct level
+		{
+			std::deque<queued_task> tasks;
+			std::vector<deadline_task> deadline_tasks;
+			size_t sequence = 0;
+		};
+
+		struct arrival
+		{
+			clock::time_point enqueued;
+			bool popped = false;
+		};
+
+		static bool _later(const deadline_task& lhs, const deadline_task& rhs) noexcept
+		{
+			if (lhs.deadline != rhs.deadline)
+				return lhs.deadline > rhs.deadline;
+
+			return lhs.sequence > rhs.sequence;
+		}
+
+	public:
+		task_queue(size_t levels, bool track_latency)
+			: _levels(std::max<size_t>(levels, 1))
+			, _track_latency(track_latency)
+		{
+		}
+
+		task_queue(const task_queue&) = delete;
+		task_queue(task_queue&&) = default;
+
+		void push(const task_options& options, task&& fn, clock::time_point enqueued)
+		{
+			const auto ticket = _first_ticket + _arrivals.size();
+			if (_track_latency)
+				_arrivals.push_back({ enqueued });
+
+			auto& target = _levels[options.priority];
+			if (options.deadline == clock::time_point::max())
+				target.tasks.push_back({ ticket, std::move(fn) });
+			else
+			{
+				target.deadline_tasks.push_back({ options.deadline, target.sequence++, ticket, std::move(fn) });
+				std::push_heap(target.deadline_tasks.begin(), target.deadline_tasks.end(), &_later);
+			}
+
+			_size++;
+		}
+
+		/// <summary>
+		/// Removes the next task to execute, the queue must not be empty.
+		/// </summary>
+		task pop() noexcept
+		{
+			for (auto it = _levels.rbegin(); it != _levels.rend(); ++it)
+			{
+				if (!it->deadline_tasks.empty())
+				{
+					std::pop_heap(it->deadline_tasks.begin(), it->deadline_tasks.end(), &_later);
+					auto fn = std::move(it->deadline_tasks.back().function);
+					_popped(it->deadline_tasks.back().ticket);
+					it->deadline_tasks.pop_back();
+					_size--;
+					return fn;
+				}
+
+				if (!it->tasks.empty())
+				{
+					auto fn = std::move(it->tasks.front().function);
+					_popped(it->tasks.front().ticket);
+					it->tasks.pop_front();
+					_size--;
+					return fn;
+				}
+			}
+
+			return {};
+		}
+
+		/// <summary>
+		/// Enqueue time of the oldest pending task, time_point::max() when the queue is empty or does not track the latency.
+		/// </summary>
+		[[nodiscard]] clock::time_point oldest() const noexcept
+		{
+			return _arrivals.empty() ? clock::time_point::max() : _arrivals.front().enqueued;
+		}
+
+		[[nodiscard]] bool empty() const noexcept
+		{
+			return _size == 0;
+		}
+
+		[[nodiscard]] size_t size() const noexcept
+		{
+			return _size;
+		}
+
+		[[nodiscard]] size_t size(size_t priority) const noexcept
+		{
+			return _levels[priority].tasks.size() + _levels[priority].deadline_tasks.size();
+		}
+
+		[[nodiscard]] size_t levels() const noexcept
+		{
+			return _levels.size();
+		}
+
+	private:
+		// Tasks are popped out of the submission order, their arrivals are removed once all older ones are gone
+		void _popped(size_t ticket) noexcept
+		{
+			if (!_track_latency)
+				return;
+
+			_arrivals[ticket - _first_ticket].popped = true;
+			while (!_arrivals.empty() && _arrivals.front().popped)
+			{
+				_arrivals.pop_front();
+				_first_ticket++;
+			}
+		}
+
+	private:
+		std::vector<level> _levels;
+		size_t _size = 0;
+		const bool _track_latency;
+		std::deque<arrival> _arrivals;
+		size_t _first_ticket = 0;
+	};
+
 public:
-	sync_thread_pool(size_t size)
-		: _workers(_add_workers(size))
+	/// <param name="size">Number of worker threads.</param>
+	/// <param name="priority_levels">Number of priority levels, priorities 0 (default) to priority_levels - 1 (most urgent) are accepted.</param>
+	sync_thread_pool(size_t size, size_t priority_levels = 1)
+		: sync_thread_pool(size, std::nullopt, std::nullopt, priority_levels)
+	{
+	}
+
+	/// <summary>
+	/// Creates pool with workers pinned to the nodes of the placement, every node has its own sub-queue.
+	/// </summary>
+	/// <exception cref="std::invalid_argument">When the placement is not valid or the system rejects the CPUs of its node.</exception>
+	sync_thread_pool(size_t size, worker_placement placement, size_t priority_levels = 1)
+		: sync_thread_pool(size, std::nullopt, std::move(placement), priority_levels)
+	{
+	}
+
+	/// <summary>
+	/// Creates elastic pool starting with options.min_workers workers.
+	/// </summary>
+	/// <exception cref="std::invalid_argument">When max_workers is zero or lower than min_workers.</exception>
+	sync_thread_pool(const elastic_options& options, size_t priority_levels = 1)
+		: sync_thread_pool(options.min_workers, options, std::nullopt, priority_levels)
+	{
+	}
+
+	/// <summary>
+	/// Creates elastic pool with workers pinned to the nodes of the placement, every node has its own sub-queue.
+	/// </summary>
+	/// <exception cref="std::invalid_argument">When the elastic limits or the placement are not valid.</exception>
+	sync_thread_pool(const elastic_options& options, worker_placement placement, size_t priority_levels = 1)
+		: sync_thread_pool(options.min_workers, options, std::move(placement), priority_levels)
 	{
 	}
 
 public:
 	virtual ~sync_thread_pool()
 	{
-		for (auto& t : const_cast<std::list<std::jthread>&>(_workers))
 		{
-			t.request_stop();
+			std::scoped_lock lck(_lock);
+			_stopping = true;
+			for (auto& t : _workers)
+				t.request_stop();
 		}
 
 		_event.notify_all();
+
+		// Workers drain the queue before they exit, no worker is added or retired once the pool is stopping
+		for (auto& t : _workers)
+			t.join();
+
+		for (auto& t : _retired)
+			t.join();
 	}
 
 	template <typename _Fn>
 		requires std::is_invocable_v<_Fn>
 	void add_task(_Fn&& fn) noexcept
 	{
-		add_task(std::packaged_task<void()>(std::forward<_Fn>(fn)));
+		_enqueue({}, _make_fire_and_forget(std::forward<_Fn>(fn)));
 	}
 
 	template <class... _Args>
 		requires std::is_invocable_v<std::packaged_task<void()>, _Args...>
 	void add_task(std::packaged_task<void()>&& fn) noexcept
 	{
-		std::scoped_lock lck(_lock);
-		_tasks.emplace([x = std::move(fn)]() mutable
+		_enqueue({}, [x = std::move(fn)]() mutable
 			{
 				x();
 			});
-		_event.notify_one();
+	}
+
+	/// <summary>
+	/// Enqueues the callable with the given priority and deadline.
+	/// </summary>
+	/// <exception cref="std::out_of_range">When the priority is not lower than the number of priority levels.</exception>
+	template <typename _Fn>
+		requires std::is_invocable_v<_Fn>
+	void add_task(const task_options& options, _Fn&& fn)
+	{
+		_check_options(options);
+		_enqueue(options, _make_fire_and_forget(std::forward<_Fn>(fn)));
 	}
 
 	template <typename _Fn>
@@ -171,58 +484,557 @@ public:
 		requires std::is_invocable_v<std::packaged_task<_R()>, _Args...>
 	[[nodiscard]] std::future<_R> add_waitable_task(std::packaged_task<_R()>&& fn) noexcept
 	{
-		std::scoped_lock lck(_lock);
 		auto future = fn.get_future();
-		_tasks.emplace([x = std::move(fn)]() mutable
+		_enqueue({}, [x = std::move(fn)]() mutable
 			{
 				x();
 			});
 
-		_event.notify_one();
 		return future;
 	}
 
+	/// <summary>
+	/// Enqueues the callable with the given priority and deadline.
+	/// </summary>
+	/// <exception cref="std::out_of_range">When the priority is not lower than the number of priority levels.</exception>
+	template <typename _Fn>
+		requires std::is_invocable_v<_Fn>
+	[[nodiscard]] auto add_waitable_task(const task_options& options, _Fn&& fn)
+	{
+		_check_options(options);
+
+		std::packaged_task<typename _task_result<std::decay_t<_Fn>>::type()> packaged(std::forward<_Fn>(fn));
+		auto future = packaged.get_future();
+		_enqueue(options, [x = std::move(packaged)]() mutable
+			{
+				x();
+			});
+
+		return future;
+	}
+
+	/// <summary>
+	/// Enqueues the callable with the shared state taken from the free list of the pool.
+	/// Callable and result are stored inline in the shared state up to pooled_state::inline_size bytes,
+	///	so in the steady state no heap allocation is made per task.
+	/// </summary>
+	template <typename _Fn>
+		requires std::is_invocable_v<_Fn> && (!std::is_reference_v<std::invoke_result_t<_Fn>>)
+	[[nodiscard]] pooled_future<std::invoke_result_t<_Fn>> add_pooled_task(_Fn&& fn) noexcept
+	{
+		auto& state = _states->acquire_task<std::invoke_result_t<_Fn>>(std::forward<_Fn>(fn));
+		_schedule_pooled_state(this, state);
+		return pooled_future<std::invoke_result_t<_Fn>>(state);
+	}
+
+	/// <summary>
+	/// Enqueues the callable with the given priority and deadline, continuations registered on the returned future use the default options.
+	/// </summary>
+	/// <exception cref="std::out_of_range">When the priority is not lower than the number of priority levels.</exception>
+	template <typename _Fn>
+		requires std::is_invocable_v<_Fn> && (!std::is_reference_v<std::invoke_result_t<_Fn>>)
+	[[nodiscard]] pooled_future<std::invoke_result_t<_Fn>> add_pooled_task(const task_options& options, _Fn&& fn)
+	{
+		_check_options(options);
+
+		auto& state = _states->acquire_task<std::invoke_result_t<_Fn>>(std::forward<_Fn>(fn));
+		_enqueue(options, [&state]()
+			{
+				details::pooled_state::run(state);
+			});
+
+		return pooled_future<std::invoke_result_t<_Fn>>(state);
+	}
+
+	/// <summary>
+	/// Enqueues all callables of the range under one lock acquisition and wakes at most as many workers as there are new tasks.
+	/// Elements are moved out of the range when the range is passed as rvalue, otherwise they are copied.
+	/// </summary>
+	template <std::ranges::input_range _Range>
+		requires std::is_invocable_v<std::ranges::range_reference_t<_Range>>
+	void add_tasks(_Range&& fns) noexcept
+	{
+		add_tasks({}, std::forward<_Range>(fns));
+	}
+
+	/// <summary>
+	/// Enqueues all callables of the range with the given priority and deadline under one lock acquisition.
+	/// </summary>
+	/// <exception cref="std::out_of_range">When the priority is not lower than the number of priority levels.</exception>
+	template <std::ranges::input_range _Range>
+		requires std::is_invocable_v<std::ranges::range_reference_t<_Range>>
+	void add_tasks(const task_options& options, _Range&& fns)
+	{
+		_check_options(options);
+
+		std::vector<task> batch;
+		if constexpr (std::ranges::sized_range<_Range>)
+			batch.reserve(std::ranges::size(fns));
+
+		for (auto&& fn : fns)
+			batch.emplace_back(_make_fire_and_forget(_forward_element<_Range>(fn)));
+
+		_enqueue(options, std::move(batch));
+	}
+
+	/// <summary>
+	/// Enqueues all callables of the range under one lock acquisition and wakes at most as many workers as there are new tasks.
+	/// Elements are moved out of the range when the range is passed as rvalue, otherwise they are copied.
+	/// </summary>
+	/// <returns>Futures in the order of the input range.</returns>
+	template <std::ranges::input_range _Range>
+		requires std::is_invocable_v<std::ranges::range_reference_t<_Range>>
+	[[nodiscard]] auto add_waitable_tasks(_Range&& fns) noexcept
+	{
+		return add_waitable_tasks({}, std::forward<_Range>(fns));
+	}
+
+	/// <summary>
+	/// Enqueues all callables of the range with the given priority and deadline under one lock acquisition.
+	/// </summary>
+	/// <returns>Futures in the order of the input range.</returns>
+	/// <exception cref="std::out_of_range">When the priority is not lower than the number of priority levels.</exception>
+	template <std::ranges::input_range _Range>
+		requires std::is_invocable_v<std::ranges::range_reference_t<_Range>>
+	[[nodiscard]] auto add_waitable_tasks(const task_options& options, _Range&& fns)
+	{
+		_check_options(options);
+
+		using result_type = typename _task_result<std::remove_cvref_t<std::ranges::range_reference_t<_Range>>>::type;
+
+		std::vector<task> batch;
+		std::vector<std::future<result_type>> futures;
+		if constexpr (std::ranges::sized_range<_Range>)
+		{
+			batch.reserve(std::ranges::size(fns));
+			futures.reserve(std::ranges::size(fns));
+		}
+
+		for (auto&& fn : fns)
+		{
+			std::packaged_task<result_type()> packaged(_forward_element<_Range>(fn));
+			futures.emplace_back(packaged.get_future());
+			batch.emplace_back([x = std::move(packaged)]() mutable
+				{
+					x();
+				});
+		}
+
+		_enqueue(options, std::move(batch));
+		return futures;
+	}
+
 	size_t size() const noexcept
 	{
 		std::scoped_lock lck(_lock);
-		return _tasks.size();
+		return _pending;
+	}
+
+	/// <summary>
+	/// Number of pending tasks of the given priority level.
+	/// </summary>
+	/// <exception cref="std::out_of_range">When the priority is not lower than the number of priority levels.</exception>
+	size_t size(size_t priority) const
+	{
+		std::scoped_lock lck(_lock);
+		if (priority >= _tasks.levels())
+			throw std::out_of_range("sync_thread_pool priority is out of range!");
+
+		size_t pending = _tasks.size(priority);
+		for (const auto& queue : _node_tasks)
+			pending += queue.size(priority);
+
+		return pending;
+	}
+
+	size_t priority_levels() const noexcept
+	{
+		return _tasks.levels();
 	}
 
 	size_t pool_size() const noexcept
 	{
+		std::scoped_lock lck(_lock);
 		return _workers.size();
 	}
 
+	/// <summary>
+	/// Changes the number of workers. Surplus workers finish their current task and exit, the call waits until they are joined.
+	/// The calling worker is never retired by its own call, so a task can shrink the pool it runs on.
+	/// In the elastic mode the size is clamped to [min_workers, max_workers] and the pool may grow or shrink again within them afterwards.
+	/// </summary>
+	/// <exception cref="std::invalid_argument">When the fixed pool is resized to zero workers, its queued tasks would never run.</exception>
+	void resize(size_t size)
+	{
+		if (_elastic)
+			size = std::clamp(size, _elastic->min_workers, _elastic->max_workers);
+		else if (size == 0)
+			throw std::invalid_argument("sync_thread_pool requires at least one worker!");
+
+		std::list<std::jthread> stopped;
+		{
+			std::scoped_lock lck(_lock);
+			if (_stopping)
+				return;
+
+			stopped.splice(stopped.end(), _retired);
+			if (size > _workers.size())
+				_workers.splice(_workers.end(), _add_workers(size - _workers.size()));
+
+			for (auto it = _workers.begin(); it != _workers.end() && _workers.size() > size;)
+			{
+				if (it->get_id() == std::this_thread::get_id())
+				{
+					++it;
+					continue;
+				}
+
+				it->request_stop();
+				stopped.splice(stopped.end(), _workers, it++);
+			}
+		}
+
+		_event.notify_all();
+	}
+
+	[[nodiscard]] bool is_elastic() const noexcept
+	{
+		return _elastic.has_value();
+	}
+
+	/// <summary>
+	/// Number of nodes of the worker placement, zero when the workers are not pinned.
+	/// </summary>
+	[[nodiscard]] size_t node_count() const noexcept
+	{
+		return _node_tasks.size();
+	}
+
+	/// <summary>
+	/// Number of workers which run unpinned, because the system rejected the CPUs of their node after the pool was created.
+	/// </summary>
+	[[nodiscard]] size_t pinning_failures() const noexcept
+	{
+		return _pinning_failures.load(std::memory_order_relaxed);
+	}
+
 protected:
-	void _work(std::stop_token token)
+	template <class _Fn>
+	struct _task_result
+	{
+		using type = std::invoke_result_t<_Fn&>;
+	};
+
+	template <class _R>
+	struct _task_result<std::packaged_task<_R()>>
+	{
+		using type = _R;
+	};
+
+	sync_thread_pool(size_t size, std::optional<elastic_options> elastic, std::optional<worker_placement> placement, size_t priority_levels)
+		: _tasks(priority_levels, elastic.has_value())
+		, _node_tasks(_make_node_queues(placement, priority_levels, elastic.has_value()))
+		, _node_index(_make_node_index(placement))
+		, _node_workers(_node_tasks.size())
+		, _states(new details::pooled_state_allocator(this, &_schedule_pooled_state))
+		, _elastic(elastic ? std::optional(_check_elastic_options(*elastic)) : std::nullopt)
+		, _placement(std::move(placement))
+	{
+		// Started workers read the list (elastic idle timeout), so it is published only when complete
+		std::scoped_lock lck(_lock);
+		_workers.splice(_workers.end(), _add_workers(size));
+	}
+
+	void _work(std::stop_token token, size_t node)
 	{
 		for (;;)
 		{
 			std::unique_lock lck(_lock);
-			_event.wait(lck, [this, &token]()
+			auto ready = [this, &token, node]()
+			{
+				return _next_queue(node) != nullptr || token.stop_requested();
+			};
+
+			_idle++;
+			if (_elastic && !_stopping)
+				_event.wait_for(lck, _elastic->idle_timeout, ready);
+			else
+				_event.wait(lck, ready);
+			_idle--;
+
+			auto* queue = _next_queue(node);
+
+			// Stopped by resize exits immediately, stopped by destructor drains the queue first
+			if (token.stop_requested() && (!queue || !_stopping))
+				return _exit_worker(node);
+
+			// Idle timeout of the elastic pool
+			if (!queue)
+			{
+				if (_elastic && !_stopping && _workers.size() > _elastic->min_workers)
 				{
-					return !_tasks.empty() || token.stop_requested();
-				});
+					_retire_current_worker();
+					return _exit_worker(node);
+				}
 
-			if (token.stop_requested() && _tasks.empty())
-				return;
+				continue;
+			}
+
+			auto fnCurrentTask = queue->pop();
+			_pending--;
 
-			auto fnCurrentTask = std::move(_tasks.front());
-			_tasks.pop();
+			// Busy workers keep the pool growing after a burst even when no more tasks are submitted
+			auto retired = _grow_on_latency();
 			lck.unlock();
 
 			fnCurrentTask();
 		}
 	}
 
+	/// <summary>
+	/// Returns the queue the worker of the node takes the next task from: its node sub-queue, then the shared queue.
+	/// Sub-queues of nodes without workers are served by any worker, so their tasks are never stranded.
+	/// </summary>
+	task_queue* _next_queue(size_t node) noexcept
+	{
+		if (node != any_node && !_node_tasks[node].empty())
+			return &_node_tasks[node];
+
+		if (!_tasks.empty())
+			return &_tasks;
+
+		for (size_t i = 0; i < _node_tasks.size(); i++)
+		{
+			if (_node_workers[i] == 0 && !_node_tasks[i].empty())
+				return &_node_tasks[i];
+		}
+
+		return nullptr;
+	}
+
+	void _exit_worker(size_t node) noexcept
+	{
+		if (node == any_node)
+			return;
+
+		// The last worker of the node hands its pending tasks over to the workers of other nodes
+		if (--_node_workers[node] == 0 && !_node_tasks[node].empty())
+			_event.notify_all();
+	}
+
+	/// <summary>
+	/// Moves the jthread of the calling worker to the retired workers, it is joined by the next resize, growth or by the destructor.
+	/// </summary>
+	void _retire_current_worker() noexcept
+	{
+		const auto id = std::this_thread::get_id();
+		for (auto it = _workers.begin(); it != _workers.end(); ++it)
+		{
+			if (it->get_id() == id)
+				return _retired.splice(_retired.end(), _workers, it);
+		}
+	}
+
+	/// <summary>
+	/// Spawns a worker when the elastic pool is saturated and the oldest queued task waits longer than the latency threshold.
+	/// Called with the lock held, returns the retired workers to be joined after the lock is released.
+	/// </summary>
+	std::list<std::jthread> _grow_on_latency() noexcept
+	{
+		if (!_elastic || _stopping || _idle > 0 || _workers.size() >= _elastic->max_workers)
+			return {};
+
+		auto oldest = _tasks.oldest();
+		for (const auto& queue : _node_tasks)
+			oldest = std::min(oldest, queue.oldest());
+
+		if (oldest == clock::time_point::max() || clock::now() - oldest < _elastic->latency_threshold)
+			return {};
+
+		_workers.splice(_workers.end(), _add_workers(1));
+
+		std::list<std::jthread> retired;
+		retired.splice(retired.end(), _retired);
+		return retired;
+	}
+
+	static elastic_options _check_elastic_options(const elastic_options& options)
+	{
+		if (options.max_workers == 0 || options.max_workers < options.min_workers)
+			throw std::invalid_argument("sync_thread_pool elastic limits are invalid!");
+
+		return options;
+	}
+
+	/// <summary>
+	/// Wraps the callable of add_task. Its exception has no future to be stored in, so it is dropped
+	///	like by the std::packaged_task used before, but without allocating the shared state per task.
+	/// </summary>
+	template <typename _Fn>
+	static auto _make_fire_and_forget(_Fn&& fn)
+	{
+		return [x = std::forward<_Fn>(fn)]() mutable
+		{
+			try
+			{
+				std::invoke(x);
+			}
+			catch (...)
+			{
+			}
+		};
+	}
+
+	static void _schedule_pooled_state(void* context, details::pooled_state& state) noexcept
+	{
+		static_cast<sync_thread_pool*>(context)->_enqueue({}, [&state]()
+			{
+				details::pooled_state::run(state);
+			});
+	}
+
+	void _check_options(const task_options& options) const
+	{
+		if (options.priority >= _tasks.levels())
+			throw std::out_of_range("sync_thread_pool priority is out of range!");
+
+		if (options.node != any_node && _find_node(options.node) == any_node)
+			throw std::out_of_range("sync_thread_pool node is out of range!");
+	}
+
+	task_queue& _queue_for(const task_options& options) noexcept
+	{
+		return options.node == any_node ? _tasks : _node_tasks[_find_node(options.node)];
+	}
+
+	/// <summary>
+	/// Index of the node with the identifier, any_node when the placement has no such node.
+	/// </summary>
+	size_t _find_node(size_t id) const noexcept
+	{
+		const auto it = std::lower_bound(_node_index.begin(), _node_index.end(), std::pair(id, size_t(0)));
+		return it != _node_index.end() && it->first == id ? it->second : any_node;
+	}
+
+	// Pairs of the node identifier and the node index sorted by the identifier
+	static std::vector<std::pair<size_t, size_t>> _make_node_index(const std::optional<worker_placement>& placement)
+	{
+		std::vector<std::pair<size_t, size_t>> index;
+		if (!placement)
+			return index;
+
+		for (size_t i = 0; i < placement->nodes.size(); i++)
+			index.emplace_back(placement->node_id(i), i);
+
+		std::sort(index.begin(), index.end());
+		return index;
+	}
+
+	static std::vector<task_queue> _make_node_queues(const std::optional<worker_placement>& placement, size_t priority_levels, bool track_latency)
+	{
+		std::vector<task_queue> queues;
+		if (!placement)
+			return queues;
+
+		// Workers would fail to pin like the probe, so the pool is not created with workers silently running unpinned
+		placement->validate();
+		placement->probe();
+
+		queues.reserve(placement->nodes.size());
+		for (size_t i = 0; i < placement->nodes.size(); i++)
+			queues.emplace_back(priority_levels, track_latency);
+
+		return queues;
+	}
+
+	void _enqueue(const task_options& options, task&& fn) noexcept
+	{
+		// The options may be owned by the task itself (e.g. a suspended coroutine frame), so they are not touched once it is queued
+		const bool shared_queue = options.node == any_node;
+		std::list<std::jthread> retired;
+		{
+			std::scoped_lock lck(_lock);
+			_queue_for(options).push(options, std::move(fn), _enqueue_time());
+			_pending++;
+			retired = _grow_on_latency();
+		}
+
+		// Any worker may take the task of the shared queue, the task of the node sub-queue needs the worker of that node
+		if (shared_queue)
+			_event.notify_one();
+		else
+			_event.notify_all();
+	}
+
+	void _enqueue(const task_options& options, std::vector<task>&& batch) noexcept
+	{
+		if (batch.empty())
+			return;
+
+		std::list<std::jthread> retired;
+		size_t workers = 0;
+		{
+			std::scoped_lock lck(_lock);
+			auto& queue = _queue_for(options);
+			const auto enqueued = _enqueue_time();
+			for (auto& fn : batch)
+				queue.push(options, std::move(fn), enqueued);
+
+			_pending += batch.size();
+
+			retired = _grow_on_latency();
+			workers = _workers.size();
+		}
+
+		if (batch.size() >= workers || options.node != any_node)
+			_event.notify_all();
+		else
+		{
+			for (size_t i = 0; i < batch.size(); i++)
+				_event.notify_one();
+		}
+	}
+
+	// Only the elastic pool reads the enqueue times
+	clock::time_point _enqueue_time() const noexcept
+	{
+		return _elastic ? clock::now() : clock::time_point();
+	}
+
+	template <class _Range, class _Element>
+	static decltype(auto) _forward_element(_Element& element) noexcept
+	{
+		if constexpr (std::is_lvalue_reference_v<_Range>)
+			return element;
+		else
+			return std::move(element);
+	}
+
 	std::list<std::jthread> _add_workers(size_t count) noexcept
 	{
+		// Nodes of all new workers are counted before the first one starts, the running workers read the counts in _next_queue
+		std::vector<size_t> nodes(count, any_node);
+		if (_placement)
+		{
+			for (auto& node : nodes)
+			{
+				node = _next_worker++ % _placement->nodes.size();
+				_node_workers[node]++;
+			}
+		}
+
 		std::list<std::jthread> workers;
-		for (size_t counter = 0; counter < count; counter++)
-			workers.emplace_back(std::jthread([this](std::stop_token token)
+		for (const auto node : nodes)
+		{
+			workers.emplace_back(std::jthread([this, node](std::stop_token token)
 				{
-					this->_work(token);
+					// Placement was pinned on construction, the CPU set rejected later (e.g. the cpuset changed) leaves the worker unpinned
+					if (node != any_node && !details::set_current_thread_affinity(_placement->nodes[node]))
+						_pinning_failures.fetch_add(1, std::memory_order_relaxed);
+
+					this->_work(token, node);
 				}));
+		}
 
 		return workers;
 	}
@@ -230,8 +1042,20 @@ protected:
 private:
 	mutable std::mutex _lock;
 	std::condition_variable _event;
-	std::queue<task> _tasks;
-	const std::list<std::jthread> _workers;
+	task_queue _tasks;
+	std::vector<task_queue> _node_tasks;
+	const std::vector<std::pair<size_t, size_t>> _node_index;
+	std::vector<size_t> _node_workers;
+	size_t _pending = 0;
+	std::unique_ptr<details::pooled_state_allocator, details::pooled_state_allocator::detacher> _states;
+	const std::optional<elastic_options> _elastic;
+	const std::optional<worker_placement> _placement;
+	size_t _next_worker = 0;
+	bool _stopping = false;
+	size_t _idle = 0;
+	std::atomic<size_t> _pinning_failures = 0;
+	std::list<std::jthread> _retired;
+	std::list<std::jthread> _workers;
 };
 
 #endif
@@ -0,0 +1,257 @@
+/*
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2025 Vit janecek <mailto:janecekvit@outlook.com>.
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+work_stealing_thread_pool.h
+Purpose: header file of work-stealing thread pool class
+
+@author: Vit Janecek
+@mailto: janecekvit@outlook.com
+@version 1.00 16/10/2026
+*/
+
+#pragma once
+
+#include "compatibility/compiler_support.h"
+#include "thread/sync_thread_pool.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace janecekvit::thread
+{
+
+#if defined(HAS_JTHREAD)
+
+/// <summary>
+/// Fixed sized thread pool where every worker owns its own task deque.
+/// Workers pop their own tasks from the back of the deque (LIFO) and idle workers steal from the front of other deques (FIFO).
+/// Tasks submitted from inside a worker are pushed to that worker's deque, other tasks are distributed in round-robin order.
+/// There is no global task queue lock, the shared mutex is used only to park workers that found no work.
+/// </summary>
+class work_stealing_thread_pool
+{
+public:
+	using task = sync_thread_pool::task;
+
+public:
+	/// <exception cref="std::invalid_argument">When the size is zero, tasks would have no deque to be pushed to.</exception>
+	work_stealing_thread_pool(size_t size)
+		: _queues(_check_size(size))
+		, _workers(_add_workers(size))
+	{
+	}
+
+public:
+	virtual ~work_stealing_thread_pool()
+	{
+		for (auto& t : const_cast<std::list<std::jthread>&>(_workers))
+		{
+			t.request_stop();
+		}
+
+		_event.notify_all();
+	}
+
+	template <typename _Fn>
+		requires std::is_invocable_v<_Fn>
+	void add_task(_Fn&& fn) noexcept
+	{
+		add_task(std::packaged_task<void()>(std::forward<_Fn>(fn)));
+	}
+
+	template <class... _Args>
+		requires std::is_invocable_v<std::packaged_task<void()>, _Args...>
+	void add_task(std::packaged_task<void()>&& fn) noexcept
+	{
+		_push([x = std::move(fn)]() mutable
+			{
+				x();
+			});
+	}
+
+	template <typename _Fn>
+		requires std::is_invocable_v<_Fn>
+	[[nodiscard]] auto add_waitable_task(_Fn&& fn) noexcept
+	{
+		return add_waitable_task(std::packaged_task<std::invoke_result_t<_Fn>()>(std::forward<_Fn>(fn)));
+	}
+
+	template <class _R, class... _Args>
+		requires std::is_invocable_v<std::packaged_task<_R()>, _Args...>
+	[[nodiscard]] std::future<_R> add_waitable_task(std::packaged_task<_R()>&& fn) noexcept
+	{
+		auto future = fn.get_future();
+		_push([x = std::move(fn)]() mutable
+			{
+				x();
+			});
+
+		return future;
+	}
+
+	size_t size() const noexcept
+	{
+		return _pending.load(std::memory_order_acquire);
+	}
+
+	size_t pool_size() const noexcept
+	{
+		return _workers.size();
+	}
+
+protected:
+	static size_t _check_size(size_t size)
+	{
+		if (size == 0)
+			throw std::invalid_argument("work_stealing_thread_pool requires at least one worker!");
+
+		return size;
+	}
+
+	/// <summary>
+	/// Per-worker deque, the owner works on the back and thieves on the front.
+	/// </summary>
+	struct worker_queue
+	{
+		mutable std::mutex lock;
+		std::deque<task> tasks;
+	};
+
+	void _push(task&& fn) noexcept
+	{
+		const auto index = _current_pool == this
+			? _current_index
+			: _next_queue.fetch_add(1, std::memory_order_relaxed) % _queues.size();
+
+		{
+			auto& queue = _queues[index];
+			std::scoped_lock lck(queue.lock);
+			queue.tasks.emplace_back(std::move(fn));
+		}
+
+		_pending.fetch_add(1, std::memory_order_seq_cst);
+		if (_sleeping.load(std::memory_order_seq_cst) > 0)
+		{
+			// Synchronize with a worker which is just going to sleep to prevent lost wake-up
+			std::scoped_lock lck(_sleepLock);
+		}
+
+		_event.notify_one();
+	}
+
+	std::optional<task> _pop_local(size_t index) noexcept
+	{
+		auto& queue = _queues[index];
+		std::scoped_lock lck(queue.lock);
+		if (queue.tasks.empty())
+			return std::nullopt;
+
+		auto fn = std::move(queue.tasks.back());
+		queue.tasks.pop_back();
+		return fn;
+	}
+
+	std::optional<task> _steal(size_t index) noexcept
+	{
+		for (size_t offset = 1; offset < _queues.size(); offset++)
+		{
+			auto& queue = _queues[(index + offset) % _queues.size()];
+			std::unique_lock lck(queue.lock, std::try_to_lock);
+			if (!lck.owns_lock() || queue.tasks.empty())
+				continue;
+
+			auto fn = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+			return fn;
+		}
+
+		return std::nullopt;
+	}
+
+	void _work(std::stop_token token, size_t index)
+	{
+		_current_pool = this;
+		_current_index = index;
+
+		for (;;)
+		{
+			auto fnCurrentTask = _pop_local(index);
+			if (!fnCurrentTask && _pending.load(std::memory_order_acquire) > 0)
+				fnCurrentTask = _steal(index);
+
+			if (fnCurrentTask)
+			{
+				_pending.fetch_sub(1, std::memory_order_acq_rel);
+				(*fnCurrentTask)();
+				continue;
+			}
+
+			std::unique_lock lck(_sleepLock);
+			_sleeping.fetch_add(1, std::memory_order_seq_cst);
+			_event.wait(lck, token, [this]()
+				{
+					return _pending.load(std::memory_order_seq_cst) > 0;
+				});
+			_sleeping.fetch_sub(1, std::memory_order_relaxed);
+
+			if (token.stop_requested() && _pending.load(std::memory_order_acquire) == 0)
+				return;
+		}
+	}
+
+	std::list<std::jthread> _add_workers(size_t count) noexcept
+	{
+		std::list<std::jthread> workers;
+		for (size_t counter = 0; counter < count; counter++)
+			workers.emplace_back(std::jthread([this, counter](std::stop_token token)
+				{
+					this->_work(token, counter);
+				}));
+
+		return workers;
+	}
+
+private:
+	inline static thread_local const work_stealing_thread_pool* _current_pool = nullptr;
+	inline static thread_local size_t _current_index = 0;
+
+	std::vector<worker_queue> _queues;
+	std::atomic<size_t> _next_queue = 0;
+	std::atomic<size_t> _pending = 0;
+	std::atomic<size_t> _sleeping = 0;
+
+	std::mutex _sleepLock;
+	std::condition_variable_any _event;
+	const std::list<std::jthread> _workers;
+};
+
+#endif
+
+} // namespace janecekvit::thread
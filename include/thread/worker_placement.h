@@ -0,0 +1,307 @@
+/*
+Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+Copyright (c) 2025 Vit janecek <mailto:janecekvit@outlook.com>.
+
+Permission is hereby  granted, free of charge, to any  person obtaining a copy
+of this software and associated  documentation files (the "Software"), to deal
+in the Software  without restriction, including without  limitation the rights
+to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+worker_placement.h
+Purpose: header file of CPU and NUMA placement of thread pool workers
+
+@author: Vit Janecek
+@mailto: janecekvit@outlook.com
+@version 1.00 16/10/2026
+*/
+
+#pragma once
+
+#include "compatibility/compiler_support.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(HAS_PTHREAD_AFFINITY)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace janecekvit::thread
+{
+namespace details
+{
+/// <summary>
+/// Parses the Linux CPU list format, e.g. "0-3,8,10-11".
+/// </summary>
+/// <exception cref="std::invalid_argument">When the list is malformed.</exception>
+inline std::vector<size_t> parse_cpu_list(std::string_view list)
+{
+	auto parse_number = [](std::string_view text)
+	{
+		size_t value = 0;
+		auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+		if (error != std::errc() || end != text.data() + text.size())
+			throw std::invalid_argument("CPU list is malformed!");
+
+		return value;
+	};
+
+	while (!list.empty() && std::isspace(static_cast<unsigned char>(list.back())))
+		list.remove_suffix(1);
+
+	std::vector<size_t> cpus;
+	while (!list.empty())
+	{
+		const auto separator = list.find(',');
+		const auto range = list.substr(0, separator);
+		list = separator == std::string_view::npos ? std::string_view() : list.substr(separator + 1);
+
+		const auto dash = range.find('-');
+		const auto first = parse_number(range.substr(0, dash));
+		const auto last = dash == std::string_view::npos ? first : parse_number(range.substr(dash + 1));
+		if (last < first)
+			throw std::invalid_argument("CPU list is malformed!");
+
+		for (auto cpu = first; cpu <= last; cpu++)
+			cpus.emplace_back(cpu);
+	}
+
+	return cpus;
+}
+
+/// <summary>
+/// Pins the calling thread to the set of CPUs, it is a no-op on platforms without thread affinity support.
+/// </summary>
+/// <returns>False when the operating system rejected the CPU set.</returns>
+inline bool set_current_thread_affinity([[maybe_unused]] const std::vector<size_t>& cpus) noexcept
+{
+#if defined(HAS_PTHREAD_AFFINITY)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (auto cpu : cpus)
+		CPU_SET(cpu, &set);
+
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+	return true;
+#endif
+}
+
+/// <summary>
+/// Pins a new thread to the set of CPUs, the affinity of the calling thread is not changed.
+/// </summary>
+/// <returns>False when the operating system rejected the CPU set.</returns>
+inline bool probe_thread_affinity(const std::vector<size_t>& cpus)
+{
+	bool pinned = false;
+	std::thread([&pinned, &cpus]()
+		{
+			pinned = set_current_thread_affinity(cpus);
+		})
+		.join();
+
+	return pinned;
+}
+
+} // namespace details
+
+/// <summary>
+/// Placement of thread pool workers on CPUs.
+/// Every node is a set of CPUs with its own sub-queue in the pool, worker i is pinned to the CPUs of node i % nodes.size().
+/// Tasks submitted to the node sub-queue are executed only by the workers of that node,
+///	so memory touched by the task stays local to the socket which allocated it.
+/// Tasks address the node by its identifier, numa_nodes() keeps the NUMA node ids of the operating system,
+///	so nodes without allowed CPUs do not shift the identifiers of the others.
+/// Pinning requires pthread_setaffinity_np (Linux), elsewhere only the node sub-queues are used.
+/// </summary>
+/// <example>
+/// <code>
+///  // One node per NUMA node of the machine
+///  thread::sync_thread_pool pool(16, thread::worker_placement::numa_nodes());
+///
+///  // Memory allocated on the NUMA node 1 is processed by the workers pinned to its CPUs
+///  pool.add_task({ .node = 1 }, [buffer]() { process(buffer); });
+/// </code>
+/// </example>
+struct worker_placement
+{
+	std::vector<std::vector<size_t>> nodes;
+
+	/// <summary>
+	/// Identifiers of the nodes used by task_options::node, node i has identifier i when empty.
+	/// </summary>
+	std::vector<size_t> node_ids;
+
+	[[nodiscard]] size_t node_id(size_t index) const noexcept
+	{
+		return node_ids.empty() ? index : node_ids[index];
+	}
+
+	/// <summary>
+	/// One node per NUMA node reported by /sys/devices/system/node,
+	///	a single node with all CPUs is returned when the topology is not available.
+	/// </summary>
+	[[nodiscard]] static worker_placement numa_nodes()
+	{
+		worker_placement placement;
+		const std::filesystem::path root("/sys/devices/system/node");
+
+		std::error_code error;
+		std::vector<std::pair<size_t, std::filesystem::path>> entries;
+		for (const auto& entry : std::filesystem::directory_iterator(root, error))
+		{
+			const auto name = entry.path().filename().string();
+			if (name.size() <= 4 || !name.starts_with("node") || !std::all_of(name.begin() + 4, name.end(), [](char c)
+					{
+						return std::isdigit(static_cast<unsigned char>(c)) != 0;
+					}))
+				continue;
+
+			entries.emplace_back(std::stoul(name.substr(4)), entry.path() / "cpulist");
+		}
+
+		std::sort(entries.begin(), entries.end());
+		const auto allowed = all_cpus();
+		for (const auto& [id, path] : entries)
+		{
+			std::ifstream file(path);
+			std::string list;
+			if (!std::getline(file, list))
+				continue;
+
+			// Only CPUs the process may run on are kept, so pinning does not fail inside restricted cpusets
+			auto cpus = details::parse_cpu_list(list);
+			std::erase_if(cpus, [&allowed](size_t cpu)
+				{
+					return !std::binary_search(allowed.begin(), allowed.end(), cpu);
+				});
+
+			if (!cpus.empty())
+			{
+				placement.nodes.emplace_back(std::move(cpus));
+				placement.node_ids.emplace_back(id);
+			}
+		}
+
+		if (placement.nodes.empty())
+		{
+			placement.nodes.emplace_back(allowed);
+			placement.node_ids.clear();
+		}
+
+		return placement;
+	}
+
+	/// <summary>
+	/// One node per CPU, every worker is pinned to a single core.
+	/// </summary>
+	[[nodiscard]] static worker_placement cores(const std::vector<size_t>& cpus)
+	{
+		worker_placement placement;
+		for (auto cpu : cpus)
+			placement.nodes.push_back({ cpu });
+
+		return placement;
+	}
+
+	[[nodiscard]] static worker_placement cores()
+	{
+		return cores(all_cpus());
+	}
+
+	/// <summary>
+	/// CPUs the process is allowed to run on, all CPUs reported by std::thread::hardware_concurrency on other platforms.
+	/// </summary>
+	[[nodiscard]] static std::vector<size_t> all_cpus()
+	{
+#if defined(HAS_PTHREAD_AFFINITY)
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		if (sched_getaffinity(0, sizeof(set), &set) == 0)
+		{
+			std::vector<size_t> allowed;
+			for (size_t cpu = 0; cpu < CPU_SETSIZE; cpu++)
+			{
+				if (CPU_ISSET(cpu, &set))
+					allowed.emplace_back(cpu);
+			}
+
+			if (!allowed.empty())
+				return allowed;
+		}
+#endif
+
+		std::vector<size_t> cpus(std::max<size_t>(std::thread::hardware_concurrency(), 1));
+		for (size_t i = 0; i < cpus.size(); i++)
+			cpus[i] = i;
+
+		return cpus;
+	}
+
+	/// <summary>
+	/// Checks on a probe thread that the system accepts the CPUs of every node.
+	/// </summary>
+	/// <exception cref="std::invalid_argument">When the system rejects the CPUs of a node, e.g. outside of the cpuset of the process.</exception>
+	void probe() const
+	{
+		for (const auto& cpus : nodes)
+		{
+			if (!details::probe_thread_affinity(cpus))
+				throw std::invalid_argument("worker_placement node cannot be pinned by the system!");
+		}
+	}
+
+	/// <exception cref="std::invalid_argument">When there is no node, a node without CPU, a CPU which cannot be represented or the node identifiers do not match the nodes.</exception>
+	void validate() const
+	{
+		if (nodes.empty())
+			throw std::invalid_argument("worker_placement has no node!");
+
+		if (!node_ids.empty())
+		{
+			auto ids = node_ids;
+			std::sort(ids.begin(), ids.end());
+			if (ids.size() != nodes.size() || std::adjacent_find(ids.begin(), ids.end()) != ids.end())
+				throw std::invalid_argument("worker_placement node identifiers are not unique per node!");
+		}
+
+		for (const auto& cpus : nodes)
+		{
+			if (cpus.empty())
+				throw std::invalid_argument("worker_placement node has no CPU!");
+
+#if defined(HAS_PTHREAD_AFFINITY)
+			if (std::any_of(cpus.begin(), cpus.end(), [](size_t cpu)
+					{
+						return cpu >= CPU_SETSIZE;
+					}))
+				throw std::invalid_argument("worker_placement CPU is out of range!");
+#endif
+		}
+	}
+};
+
+} // namespace janecekvit::thread
@@ -3,6 +3,7 @@
 #include <future>
 #include <gtest/gtest.h>
 #include <iostream>
+#include <memory>
 #include <string>
 
 using namespace janecekvit::thread;
@@ -87,4 +88,46 @@ TEST_F(test_async, CreateWithException)
 	ASSERT_THROW(result.get(), std::exception);
 }
 
+#if defined(HAS_JTHREAD)
+TEST_F(test_async, CreateOnPool)
+{
+	sync_thread_pool pool(2);
+	auto result = async::create(pool, [](int value, std::unique_ptr<int> other)
+		{
+			return value + *other;
+		},
+		2, std::make_unique<int>(3));
+
+	ASSERT_EQ(result.get(), 5);
+}
+
+TEST_F(test_async, CreateOnSharedPool)
+{
+	auto result = async::create(async::shared_pool(), []()
+		{
+			return std::this_thread::get_id();
+		});
+
+	ASSERT_NE(result.get(), std::this_thread::get_id());
+	ASSERT_GE(async::shared_pool().pool_size(), 1);
+}
+
+TEST_F(test_async, CreateOnPoolThen)
+{
+	sync_thread_pool pool(2);
+	auto doubled = async::create(pool, [](int value)
+		{
+			return value * 2;
+		},
+		21);
+
+	auto result = doubled.then([](int value)
+		{
+			return std::to_string(value);
+		});
+
+	ASSERT_EQ(result.get(), "42");
+}
+#endif // defined(HAS_JTHREAD)
+
 } // namespace framework_tests
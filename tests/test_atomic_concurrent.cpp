@@ -2,18 +2,18 @@
 #include "storage/resource_wrapper.h"
 #include "synchronization/atomic_concurrent.h"
 
-#include <exception>
-#include <fstream>
+#include <atomic>
 #include <future>
 #include <gtest/gtest.h>
-#include <iostream>
+#include <latch>
+#include <new>
+#include <stdexcept>
 #include <string>
 #include <thread>
-
-#if defined(__experimental)
+#include <vector>
 
 using namespace janecekvit;
-using namespace janecekvit::experimental::synchronization;
+using namespace janecekvit::synchronization;
 
 namespace framework_tests
 {
@@ -56,19 +56,28 @@ protected:
 
 		return container;
 	}
+};
 
-	template <class _Func>
-	void _catch_all_exceptions_thow_std_exception(_Func&& callback)
+/// Counts copies, the value is copied by writers only
+struct copy_counter
+{
+	copy_counter() = default;
+
+	copy_counter(const copy_counter& other)
+		: value(other.value)
 	{
-		try
-		{
-			callback();
-		}
-		catch (...)
-		{
-			throw std::exception("access violation");
-		}
+		if (throw_on_copy)
+			throw std::bad_alloc();
+
+		copies++;
 	}
+
+	copy_counter(copy_counter&&) noexcept = default;
+	copy_counter& operator=(const copy_counter&) = default;
+
+	int value = 0;
+	static inline std::atomic<int> copies = 0;
+	static inline std::atomic<bool> throw_on_copy = false;
 };
 
 TEST_F(test_atomic_atomic_concurrent, TestContainerAliases)
@@ -135,7 +144,7 @@ TEST_F(test_atomic_atomic_concurrent, TestWriterAccessMultipleThreads)
 {
 	auto&& container = _prepare_testing_data_perf_test();
 	ASSERT_EQ((int) container->writer(), 1);
-	auto thread1 = std::jthread([&](std::stop_token token)
+	auto thread1 = std::jthread([&]()
 		{
 			for (size_t i = 0; i < IterationCount; i++)
 			{
@@ -144,7 +153,7 @@ TEST_F(test_atomic_atomic_concurrent, TestWriterAccessMultipleThreads)
 			}
 		});
 
-	auto thread2 = std::jthread([&](std::stop_token token)
+	auto thread2 = std::jthread([&]()
 		{
 			for (size_t i = 0; i < IterationCount; i++)
 			{
@@ -200,9 +209,9 @@ TEST_F(test_atomic_atomic_concurrent, TestReaderAccessScope)
 			},
 			std::out_of_range);
 
-		const int number = extensions::execute_on_container(container->reader().get(), 10, [&](const int& number)
+		const int number = extensions::execute_on_container(container->reader().get(), 10, [&](const int& value)
 			{
-				return number;
+				return value;
 			});
 
 		ASSERT_EQ(number, 10);
@@ -220,21 +229,22 @@ TEST_F(test_atomic_atomic_concurrent, TestReaderAccessMultipleThreads)
 {
 	auto&& container = _prepare_testing_data_perf_test();
 	ASSERT_EQ((int) container->reader(), 1);
-	auto thread1 = std::jthread([&](std::stop_token token)
+	auto thread1 = std::jthread([&]()
 		{
 			for (size_t i = 0; i < IterationCount; i++)
 			{
 				auto&& reader = container->reader();
-				int val = reader;
+				EXPECT_EQ(reader.get(), 1);
 			}
 		});
 
-	auto thread2 = std::jthread([&](std::stop_token token)
+	auto thread2 = std::jthread([&]()
 		{
-			auto&& writer = container->reader();
+			auto&& outer = container->reader();
 			for (size_t i = 0; i < IterationCount; i++)
 			{
 				auto&& reader = container->reader();
+				EXPECT_EQ(&reader.get(), &outer.get());
 			}
 		});
 
@@ -250,79 +260,88 @@ TEST_F(test_atomic_atomic_concurrent, TestIterators)
 	// container->reader();
 
 	// Test iterators
+	// Every writer works with its own copy, iterators are valid while the writer lives
 	auto&& container = _prepare_testing_data();
-	auto begin = container->writer()->begin();
-	auto end = container->writer()->end();
-	auto size = container->writer()->size();
-
-	ASSERT_EQ(size, 3);
-	ASSERT_FALSE(begin == end);
-	container->writer()->emplace(20, 20);
-
-	auto beginConst = container->reader()->begin();
-	auto endConst = container->reader()->end();
-	size = container->reader()->size();
-	ASSERT_FALSE(beginConst == endConst);
-	ASSERT_EQ(size, 4);
+	{
+		auto writer = container->writer();
+		ASSERT_EQ(writer->size(), 3);
+		ASSERT_FALSE(writer->begin() == writer->end());
+		writer->emplace(20, 20);
+	}
+
+	auto reader = container->reader();
+	ASSERT_FALSE(reader->begin() == reader->end());
+	ASSERT_EQ(reader->size(), 4);
 
-	{ // begin const
-		auto begin = container->writer()->begin();
+	{
+		auto writer = container->writer();
+		auto begin = writer->begin();
+		const auto key = begin->first;
 
-		// beginConst->second++; //atomic_concurrent
-		begin->second++; // Writer
-		ASSERT_EQ(begin->second, 6);
+		// reader->begin()->second++; // Reader is constant
+		begin->second++;
+		ASSERT_EQ(begin->second, key + 1);
 	}
+
+	// The snapshot of the reader is not changed by writers
+	ASSERT_EQ(reader->size(), 4);
+	for (auto&& [key, value] : reader.get())
+		ASSERT_EQ(key, value);
 }
 
 TEST_F(test_atomic_atomic_concurrent, TestRangeLoop)
 {
+	// Copies of the unordered map do not keep the iteration order
 	int result = 0;
 	auto&& container = _prepare_testing_data();
 
 	for (auto&& item : container->writer())
 	{
-		result += 5;
-		ASSERT_EQ(item.first, result);
+		result += item.first;
+		ASSERT_EQ(item.first, item.second);
 	}
+	ASSERT_EQ(result, 30);
 
 	result = 0;
 	for (auto&& item : container->reader())
 	{
-		result += 5;
-		ASSERT_EQ(item.first, result);
+		result += item.first;
+		ASSERT_EQ(item.first, item.second);
 	}
+	ASSERT_EQ(result, 30);
 }
 
 TEST_F(test_atomic_atomic_concurrent, TestWriterAccessSynchroAsync)
 {
 	auto&& container = _prepare_testing_data();
 
-	std::condition_variable con;
+	std::latch acquired(1);
+	std::latch release(1);
 	auto future = std::async(std::launch::async, [&]()
 		{
-			con.notify_one();
-			int i = 5;
-			for (auto&& item : container->writer())
-			{
-				ASSERT_EQ(item.second, i);
-				i += 5;
+			auto writer = container->writer();
+			acquired.count_down();
+			release.wait();
 
+			for (auto&& item : writer)
 				item.second += 1;
-			}
 		});
 
-	std::mutex mutex;
-	std::unique_lock<std::mutex> oLock(mutex);
-	con.wait(oLock);
-	int i = 6;
+	acquired.wait();
+	ASSERT_FALSE(container->is_writer_free());
+	ASSERT_FALSE(container->try_to_acquire_writer().has_value());
+	release.count_down();
+
+	// Waits for the first writer and modifies its published copy
 	for (auto&& item : container->writer())
 	{
-		ASSERT_EQ(item.second, i);
-		i += 5;
+		ASSERT_EQ(item.second, item.first + 1);
 		item.second -= 1;
 	}
 
 	future.get();
+	for (auto&& item : container->reader())
+		ASSERT_EQ(item.second, item.first);
 }
 
 TEST_F(test_atomic_atomic_concurrent, TestIndexOperator)
@@ -481,12 +500,12 @@ TEST_F(test_atomic_atomic_concurrent, TestUserDefinedConversion)
 {
 	int iCalls = 0;
 	auto&& container = _prepare_testing_data();
-	auto testLambda = [&](std::unordered_map<int, int>& container)
+	auto testLambda = [&](std::unordered_map<int, int>&)
 	{
 		iCalls++;
 	};
 
-	auto testLambdaConst = [&](const std::unordered_map<int, int>& container)
+	auto testLambdaConst = [&](const std::unordered_map<int, int>&)
 	{
 		iCalls++;
 	};
@@ -524,7 +543,7 @@ TEST_F(test_atomic_atomic_concurrent, TestConccurentConstraints)
 		5
 	};
 
-	// ContainerTest(listNumbers);
+	ASSERT_EQ(listNumbers.reader().size(), 5);
 }
 
 TEST_F(test_atomic_atomic_concurrent, FechAdd)
@@ -547,6 +566,142 @@ TEST_F(test_atomic_atomic_concurrent, FechAdd)
 	ASSERT_EQ(loopCount * 2, container.load());
 }
 
-} // namespace framework_tests
+TEST_F(test_atomic_atomic_concurrent, TestCopyOnFirstAccess)
+{
+	atomic_concurrent::resource_owner<copy_counter> container;
+	copy_counter::copies = 0;
+
+	{ // Unused writer does not copy the snapshot
+		auto writer = container.writer();
+	}
+	ASSERT_EQ(copy_counter::copies, 0);
+
+	{ // Replaced value is not copied either
+		auto writer = container.writer();
+		writer.set(copy_counter{});
+		writer->value = 5;
+	}
+	ASSERT_EQ(copy_counter::copies, 0);
+	ASSERT_EQ(container.reader()->value, 5);
+
+	{
+		auto writer = container.writer();
+		writer->value++;
+		writer->value++;
+	}
+	ASSERT_EQ(copy_counter::copies, 1);
+	ASSERT_EQ(container.reader()->value, 7);
+}
+
+TEST_F(test_atomic_atomic_concurrent, TestWriterAbandonedByException)
+{
+	auto&& container = _prepare_testing_data();
+	auto reader = container->reader();
+
+	ASSERT_THROW(
+		{
+			auto writer = container->writer();
+			writer->clear();
+			throw std::runtime_error("rollback");
+		},
+		std::runtime_error);
+
+	ASSERT_TRUE(container->is_writer_free());
+	ASSERT_EQ(&container->reader().get(), &reader.get());
+	ASSERT_EQ(container->reader()->size(), 3);
+}
+
+TEST_F(test_atomic_atomic_concurrent, TestUpdate)
+{
+	auto&& container = _prepare_testing_data();
+	container->update([](std::unordered_map<int, int>& value)
+		{
+			value.emplace(20, 20);
+		});
+	ASSERT_EQ(container->reader()->at(20), 20);
 
-#endif
+	ASSERT_THROW(container->update([](std::unordered_map<int, int>& value)
+					 {
+						 value.at(25)++;
+					 }),
+		std::out_of_range);
+	ASSERT_TRUE(container->is_writer_free());
+	ASSERT_EQ(container->reader()->size(), 4);
+}
+
+TEST_F(test_atomic_atomic_concurrent, TestUpdateCopyThrows)
+{
+	atomic_concurrent::resource_owner<copy_counter> container;
+	const auto* snapshot = &container.reader().get();
+
+	copy_counter::throw_on_copy = true;
+	ASSERT_THROW(container.update([](copy_counter& value)
+					 {
+						 value.value++;
+					 }),
+		std::bad_alloc);
+	copy_counter::throw_on_copy = false;
+
+	// Nothing is published by the failed batch, the next one applies only its own update
+	ASSERT_TRUE(container.is_writer_free());
+	ASSERT_EQ(&container.reader().get(), snapshot);
+
+	container.update([](copy_counter& value)
+		{
+			value.value += 2;
+		});
+	ASSERT_EQ(container.reader()->value, 2);
+}
+
+TEST_F(test_atomic_atomic_concurrent, TestBatchedUpdatesMultipleThreads)
+{
+	constexpr int thread_count = 8;
+	constexpr int updates_per_thread = 2000;
+
+	atomic_concurrent::resource_owner<copy_counter> container;
+	copy_counter::copies = 0;
+
+	std::atomic<int> inconsistent = 0;
+	std::atomic<bool> stop = false;
+	auto reader = std::jthread([&]()
+		{
+			int last = 0;
+			while (!stop)
+			{
+				// Published values only grow, readers never see a value being modified
+				const int value = container.reader()->value;
+				if (value < last || value % 2 != 0)
+					inconsistent++;
+
+				last = value;
+			}
+		});
+
+	std::vector<std::jthread> threads;
+	for (int t = 0; t < thread_count; t++)
+	{
+		threads.emplace_back([&]()
+			{
+				for (int i = 0; i < updates_per_thread; i++)
+				{
+					container.update([](copy_counter& value)
+						{
+							value.value += 2;
+						});
+				}
+			});
+	}
+
+	for (auto& thread : threads)
+		thread.join();
+
+	stop = true;
+	reader.join();
+
+	ASSERT_EQ(inconsistent, 0);
+	ASSERT_EQ(container.reader()->value, thread_count * updates_per_thread * 2);
+	// Each batch copies the snapshot once, concurrent updates share the batch
+	ASSERT_LE(copy_counter::copies, thread_count * updates_per_thread);
+}
+
+} // namespace framework_tests
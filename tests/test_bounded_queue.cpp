@@ -0,0 +1,227 @@
+#include "synchronization/bounded_queue.h"
+
+#include <algorithm>
+#include <future>
+#include <gtest/gtest.h>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+using namespace janecekvit;
+using namespace janecekvit::synchronization;
+
+namespace framework_tests
+{
+
+class test_bounded_queue : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+	}
+
+	void TearDown() override
+	{
+	}
+};
+
+TEST_F(test_bounded_queue, Capacity)
+{
+	concurrent::bounded_queue<int> queue(5);
+	ASSERT_EQ(queue.capacity(), 8);
+	ASSERT_TRUE(queue.empty());
+	ASSERT_THROW(concurrent::bounded_queue<int>(0), std::invalid_argument);
+}
+
+TEST_F(test_bounded_queue, TryPushTryPop)
+{
+	concurrent::bounded_queue<int> queue(4);
+	for (int i = 0; i < 4; i++)
+		ASSERT_TRUE(queue.try_push(i));
+
+	ASSERT_FALSE(queue.try_push(4));
+	ASSERT_EQ(queue.size(), 4);
+
+	for (int i = 0; i < 4; i++)
+		ASSERT_EQ(queue.try_pop(), i);
+
+	ASSERT_FALSE(queue.try_pop().has_value());
+
+	int value = 0;
+	ASSERT_TRUE(queue.try_emplace(42));
+	ASSERT_TRUE(queue.try_pop(value));
+	ASSERT_EQ(value, 42);
+	ASSERT_FALSE(queue.try_pop(value));
+}
+
+TEST_F(test_bounded_queue, MoveOnlyType)
+{
+	concurrent::bounded_queue<std::unique_ptr<std::string>> queue(2);
+	ASSERT_TRUE(queue.try_push(std::make_unique<std::string>("first")));
+	queue.push(std::make_unique<std::string>("second"));
+
+	ASSERT_EQ(*queue.pop(), "first");
+	ASSERT_EQ(**queue.try_pop(), "second");
+}
+
+TEST_F(test_bounded_queue, DestructorReleasesElements)
+{
+	auto value = std::make_shared<int>(5);
+	{
+		concurrent::bounded_queue<std::shared_ptr<int>> queue(4);
+		queue.push(value);
+		queue.push(value);
+		ASSERT_EQ(value.use_count(), 3);
+	}
+	ASSERT_EQ(value.use_count(), 1);
+}
+
+TEST_F(test_bounded_queue, Batch)
+{
+	concurrent::bounded_queue<int> queue(8);
+	std::vector<int> input(10);
+	std::iota(input.begin(), input.end(), 0);
+
+	ASSERT_EQ(queue.try_push_batch(input.begin(), input.end()), 8);
+	ASSERT_EQ(queue.try_push_batch(input.begin() + 8, input.end()), 0);
+
+	std::vector<int> output;
+	ASSERT_EQ(queue.try_pop_batch(std::back_inserter(output), 3), 3);
+	ASSERT_EQ(queue.try_pop_batch(std::back_inserter(output), 100), 5);
+	ASSERT_EQ(queue.try_pop_batch(std::back_inserter(output), 100), 0);
+	ASSERT_TRUE(std::equal(output.begin(), output.end(), input.begin()));
+}
+
+/// Output iterator which throws once it has written limit elements
+struct limited_output
+{
+	using difference_type = std::ptrdiff_t;
+
+	limited_output& operator*()
+	{
+		return *this;
+	}
+
+	limited_output& operator++()
+	{
+		return *this;
+	}
+
+	limited_output& operator++(int)
+	{
+		return *this;
+	}
+
+	limited_output& operator=(int value)
+	{
+		if (output->size() == limit)
+			throw std::length_error("output is full");
+
+		output->emplace_back(value);
+		return *this;
+	}
+
+	std::vector<int>* output;
+	size_t limit;
+};
+
+TEST_F(test_bounded_queue, BatchOutputThrows)
+{
+	concurrent::bounded_queue<int> queue(8);
+	std::vector<int> input(8);
+	std::iota(input.begin(), input.end(), 0);
+	ASSERT_EQ(queue.try_push_batch(input.begin(), input.end()), 8);
+
+	int* raw = nullptr;
+	static_assert(noexcept(queue.try_pop_batch(raw, 1)));
+	static_assert(!noexcept(queue.try_pop_batch(limited_output{}, 1)));
+
+	// Elements of the claim which were not written are dropped, their cells are released
+	std::vector<int> output;
+	ASSERT_THROW(std::ignore = queue.try_pop_batch(limited_output{ &output, 3 }, 6), std::length_error);
+	ASSERT_EQ(output, std::vector<int>({ 0, 1, 2 }));
+	ASSERT_EQ(queue.size(), 2);
+
+	ASSERT_EQ(queue.try_push_batch(input.begin(), input.end()), 6);
+	ASSERT_EQ(queue.try_pop_batch(std::back_inserter(output), 100), 8);
+	ASSERT_EQ(output.size(), 11);
+}
+
+TEST_F(test_bounded_queue, BlockingPushWaitsForConsumer)
+{
+	concurrent::bounded_queue<int> queue(1);
+	ASSERT_EQ(queue.capacity(), 2);
+	queue.push(0);
+	queue.push(1);
+
+	auto producer = std::async(std::launch::async, [&queue]()
+		{
+			queue.push(2);
+		});
+
+	ASSERT_EQ(producer.wait_for(std::chrono::milliseconds(20)), std::future_status::timeout);
+	ASSERT_EQ(queue.pop(), 0);
+	producer.get();
+	ASSERT_EQ(queue.pop(), 1);
+	ASSERT_EQ(queue.pop(), 2);
+}
+
+TEST_F(test_bounded_queue, BlockingPopWaitsForProducer)
+{
+	concurrent::bounded_queue<int> queue(4);
+	auto consumer = std::async(std::launch::async, [&queue]()
+		{
+			std::vector<int> output;
+			while (output.size() < 3)
+				std::ignore = queue.pop_batch(std::back_inserter(output), 3 - output.size());
+
+			return output;
+		});
+
+	ASSERT_EQ(consumer.wait_for(std::chrono::milliseconds(20)), std::future_status::timeout);
+	std::vector<int> input = { 1, 2, 3 };
+	queue.push_batch(input.begin(), input.end());
+	ASSERT_EQ(consumer.get(), input);
+}
+
+TEST_F(test_bounded_queue, MultipleProducersMultipleConsumers)
+{
+	constexpr size_t producers = 4;
+	constexpr size_t consumers = 4;
+	constexpr size_t items = 20000;
+
+	concurrent::bounded_queue<size_t> queue(64);
+	std::atomic<size_t> consumed = 0;
+	std::atomic<size_t> sum = 0;
+
+	std::vector<std::jthread> threads;
+	for (size_t p = 0; p < producers; p++)
+	{
+		threads.emplace_back([&queue, p]()
+			{
+				for (size_t i = 0; i < items; i++)
+					queue.push(p * items + i + 1);
+			});
+	}
+
+	for (size_t c = 0; c < consumers; c++)
+	{
+		threads.emplace_back([&]()
+			{
+				while (consumed.fetch_add(1) < producers * items)
+					sum += queue.pop();
+			});
+	}
+
+	threads.clear();
+
+	const size_t total = producers * items;
+	ASSERT_EQ(sum, total * (total + 1) / 2);
+	ASSERT_TRUE(queue.empty());
+}
+
+} // namespace framework_tests
@@ -2,12 +2,16 @@
 #include "storage/resource_wrapper.h"
 #include "synchronization/concurrent.h"
 
+#include <array>
 #include <fstream>
 #include <future>
 #include <gtest/gtest.h>
 #include <iostream>
+#include <source_location>
 #include <string>
 #include <thread>
+#include <unordered_set>
+#include <vector>
 
 using namespace janecekvit;
 using namespace janecekvit::synchronization;
@@ -931,4 +935,172 @@ TEST_F(test_concurrent, TestResourceTypeTrackingRuntime)
 	lock_tracking_runtime::disable_tracking();
 }
 
+
+TEST_F(test_concurrent, TestCacheAlignedOwner)
+{
+	concurrent::cache_aligned_resource_owner<std::vector<int>> container(std::vector<int>{ 1, 2, 3 });
+	container.exclusive()->push_back(4);
+	ASSERT_EQ(container.concurrent()->size(), 4);
+	ASSERT_EQ(container.concurrent().get()[3], 4);
+
+	// Set assigns in place, the resource stays in the block shared with the mutex
+	const auto* address = &container.concurrent().get();
+	container.exclusive().set(std::vector<int>{ 5 });
+	ASSERT_EQ(&container.concurrent().get(), address);
+	ASSERT_EQ(container.concurrent().get(), std::vector<int>{ 5 });
+
+	auto moved = std::move(container);
+	ASSERT_EQ(moved.exclusive().move(), std::vector<int>{ 5 });
+
+	std::array<concurrent::cache_aligned_resource_owner<size_t, lock_tracking_disabled>, 4> counters;
+	std::vector<std::thread> workers;
+	for (auto& counter : counters)
+	{
+		workers.emplace_back([&counter]()
+			{
+				for (size_t i = 0; i < 1000; i++)
+					counter.exclusive().get()++;
+			});
+	}
+
+	for (auto& worker : workers)
+		worker.join();
+
+	for (auto& counter : counters)
+		ASSERT_EQ(counter.concurrent().get(), 1000);
+}
+
+TEST_F(test_concurrent, TestInlineOwner)
+{
+	using owner_type = concurrent::inline_resource_owner<std::vector<int>, lock_tracking_enabled>;
+	static_assert(!std::is_copy_constructible_v<owner_type> && !std::is_move_constructible_v<owner_type>);
+	static_assert(std::is_same_v<decltype(std::declval<owner_type::exclusive_holder_type&>().operator->()), std::vector<int>*>);
+	static_assert(std::is_same_v<decltype(std::declval<owner_type::concurrent_holder_type&>().operator->()), const std::vector<int>*>);
+
+	owner_type container(std::vector<int>{ 1, 2, 3 });
+	container.exclusive()->push_back(4);
+	ASSERT_EQ(container.concurrent()->size(), 4);
+
+	// The resource and the mutex are stored in the owner itself
+	const auto* begin = reinterpret_cast<const std::byte*>(&container);
+	const auto* resource = reinterpret_cast<const std::byte*>(&container.concurrent().get());
+	ASSERT_TRUE(resource >= begin && resource < begin + sizeof(owner_type));
+	ASSERT_EQ(container.get_mutex().use_count(), 0);
+
+	container.exclusive().set(std::vector<int>{ 5 });
+	ASSERT_EQ(reinterpret_cast<const std::byte*>(&container.concurrent().get()), resource);
+	ASSERT_EQ(container.exclusive().move(), std::vector<int>{ 5 });
+
+	// Tracking owner locks its mutex in the destructor, the inline mutex outlives it
+	auto counter = std::make_unique<concurrent::inline_resource_owner<size_t, lock_tracking_enabled>>();
+	std::vector<std::thread> workers;
+	for (size_t t = 0; t < 4; t++)
+	{
+		workers.emplace_back([&counter]()
+			{
+				for (size_t i = 0; i < 1000; i++)
+					counter->exclusive().get()++;
+			});
+	}
+
+	for (auto& worker : workers)
+		worker.join();
+
+	ASSERT_EQ(counter->concurrent().get(), 4000);
+	counter.reset();
+}
+
+TEST_F(test_concurrent, TestReadMostlyOwner)
+{
+	concurrent::read_mostly_unordered_map<int, int> container;
+	static_assert(std::is_same_v<decltype(container)::mutex_type, distributed_shared_mutex>);
+
+	container.exclusive()->emplace(1, 1);
+
+	std::vector<std::thread> workers;
+	for (int t = 0; t < 4; t++)
+	{
+		workers.emplace_back([&container, t]()
+			{
+				for (int i = 0; i < 1000; i++)
+				{
+					if (i % 100 == 0)
+						container.exclusive()->emplace(t * 1000 + i + 2, i);
+					else
+						ASSERT_EQ(container.concurrent()->at(1), 1);
+				}
+			});
+	}
+
+	for (auto& worker : workers)
+		worker.join();
+
+	ASSERT_EQ(container.concurrent()->size(), 41);
+}
+
+TEST_F(test_concurrent, TestLockAll)
+{
+	concurrent::resource_owner_debug<std::vector<int>> first;
+	concurrent::resource_owner_debug<std::unordered_set<int>> second;
+	{
+		const auto line = std::source_location::current().line() + 1;
+		auto [values, keys] = lock_all(first.exclusive_intent(), second.concurrent_intent());
+		values->push_back(keys->size() + 1);
+
+		const auto details = first.get_exclusive_lock_details();
+		ASSERT_TRUE(details.has_value());
+		ASSERT_EQ(line, details->Location.line());
+		ASSERT_EQ(typeid(std::vector<int>), details->ResourceType);
+		ASSERT_EQ(1, second.get_concurrent_lock_details().size());
+		ASSERT_EQ(typeid(std::unordered_set<int>), second.get_concurrent_lock_details().begin()->second.ResourceType);
+
+		// Shared lock does not block the other readers
+		ASSERT_EQ(0, second.concurrent()->size());
+	}
+
+	ASSERT_FALSE(first.get_exclusive_lock_details().has_value());
+	ASSERT_TRUE(second.get_concurrent_lock_details().empty());
+
+	auto [keys] = lock_all(second.exclusive_intent());
+	keys->emplace(5);
+	keys.unlock();
+	ASSERT_EQ(1, first.concurrent()->front());
+	ASSERT_EQ(1, second.concurrent()->size());
+}
+
+TEST_F(test_concurrent, TestLockAllMultipleThreads)
+{
+	concurrent::resource_owner<int> first;
+	concurrent::resource_owner<int> second;
+	concurrent::resource_owner<int> third;
+
+	// Opposite orders of the intents would deadlock with nested exclusive() calls
+	auto forward = std::jthread([&]()
+		{
+			for (int i = 0; i < 10000; i++)
+			{
+				auto [a, b, c] = lock_all(first.exclusive_intent(), second.exclusive_intent(), third.concurrent_intent());
+				a()++;
+				b()++;
+			}
+		});
+
+	auto backward = std::jthread([&]()
+		{
+			for (int i = 0; i < 10000; i++)
+			{
+				auto [c, b, a] = lock_all(third.exclusive_intent(), second.exclusive_intent(), first.exclusive_intent());
+				a()++;
+				c()++;
+			}
+		});
+
+	forward.join();
+	backward.join();
+
+	ASSERT_EQ(20000, first.concurrent()());
+	ASSERT_EQ(10000, second.concurrent()());
+	ASSERT_EQ(10000, third.concurrent()());
+}
+
 } // namespace framework_tests
@@ -0,0 +1,188 @@
+#include "thread/coroutine.h"
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace janecekvit::thread;
+
+#if defined(HAS_JTHREAD)
+
+namespace framework_tests
+{
+constexpr const size_t thread_size = 4;
+
+class test_coroutine : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+	}
+
+	void TearDown() override
+	{
+	}
+};
+
+coroutine::task<int> value(int result)
+{
+	co_return result;
+}
+
+coroutine::task<int> scheduled_value(coroutine::scheduler scheduler, int result)
+{
+	co_await scheduler.schedule();
+	co_return result;
+}
+
+coroutine::task<void> failing(coroutine::scheduler scheduler)
+{
+	co_await scheduler.schedule();
+	throw std::runtime_error("failure");
+}
+
+TEST_F(test_coroutine, SyncWaitWithoutScheduler)
+{
+	ASSERT_EQ(coroutine::sync_wait(value(5)), 5);
+}
+
+TEST_F(test_coroutine, AwaitChain)
+{
+	sync_thread_pool pool(thread_size);
+	coroutine::scheduler scheduler(pool);
+
+	auto chain = [](coroutine::scheduler executor) -> coroutine::task<std::string>
+	{
+		const auto caller = std::this_thread::get_id();
+		co_await executor.schedule();
+		if (std::this_thread::get_id() == caller)
+			throw std::logic_error("not resumed on the pool");
+
+		auto first = co_await value(2);
+		auto second = co_await scheduled_value(executor, 3);
+		co_return std::to_string(first + second);
+	};
+
+	ASSERT_EQ(coroutine::sync_wait(chain(scheduler)), "5");
+}
+
+TEST_F(test_coroutine, Exception)
+{
+	sync_thread_pool pool(thread_size);
+	ASSERT_THROW(coroutine::sync_wait(failing(coroutine::scheduler(pool))), std::runtime_error);
+}
+
+TEST_F(test_coroutine, MoveOnlyResult)
+{
+	auto make = []() -> coroutine::task<std::unique_ptr<int>>
+	{
+		co_return std::make_unique<int>(7);
+	};
+
+	ASSERT_EQ(*coroutine::sync_wait(make()), 7);
+}
+
+TEST_F(test_coroutine, WhenAllTuple)
+{
+	sync_thread_pool pool(thread_size);
+	coroutine::scheduler scheduler(pool);
+
+	std::atomic<int> counter = 0;
+	auto side_effect = [](coroutine::scheduler executor, std::atomic<int>& calls) -> coroutine::task<void>
+	{
+		co_await executor.schedule();
+		calls++;
+	};
+
+	auto [first, second, third] = coroutine::sync_wait(coroutine::when_all(scheduled_value(scheduler, 1), value(2), side_effect(scheduler, counter)));
+	ASSERT_EQ(first, 1);
+	ASSERT_EQ(second, 2);
+	ASSERT_EQ(third, std::monostate{});
+	ASSERT_EQ(counter, 1);
+
+	ASSERT_EQ(coroutine::sync_wait(coroutine::when_all()), std::tuple<>());
+}
+
+TEST_F(test_coroutine, WhenAllVector)
+{
+	constexpr int task_count = 100;
+	sync_thread_pool pool(thread_size);
+	coroutine::scheduler scheduler(pool);
+
+	std::vector<coroutine::task<int>> tasks;
+	for (int i = 0; i < task_count; i++)
+		tasks.emplace_back(scheduled_value(scheduler, i));
+
+	auto results = coroutine::sync_wait(coroutine::when_all(std::move(tasks)));
+	ASSERT_EQ(results.size(), task_count);
+	for (int i = 0; i < task_count; i++)
+		ASSERT_EQ(results[i], i);
+}
+
+TEST_F(test_coroutine, WhenAllException)
+{
+	sync_thread_pool pool(thread_size);
+	coroutine::scheduler scheduler(pool);
+
+	ASSERT_THROW(coroutine::sync_wait(coroutine::when_all(scheduled_value(scheduler, 1), failing(scheduler))), std::runtime_error);
+}
+
+TEST_F(test_coroutine, WhenAny)
+{
+	sync_thread_pool pool(thread_size);
+	coroutine::scheduler scheduler(pool);
+
+	std::promise<void> promise;
+	auto blocker = promise.get_future().share();
+	auto blocked = [](coroutine::scheduler executor, std::shared_future<void> gate) -> coroutine::task<int>
+	{
+		co_await executor.schedule();
+		gate.wait();
+		co_return 1;
+	};
+
+	std::vector<coroutine::task<int>> tasks;
+	tasks.emplace_back(blocked(scheduler, blocker));
+	tasks.emplace_back(scheduled_value(scheduler, 2));
+
+	auto result = coroutine::sync_wait(coroutine::when_any(std::move(tasks)));
+	ASSERT_EQ(result.index, 1);
+	ASSERT_EQ(result.value, 2);
+
+	// The losing task keeps running in the background and releases its state when finished
+	promise.set_value();
+}
+
+TEST_F(test_coroutine, WhenAnyEmpty)
+{
+	ASSERT_THROW(coroutine::sync_wait(coroutine::when_any(std::vector<coroutine::task<int>>())), std::invalid_argument);
+}
+
+TEST_F(test_coroutine, ManyConcurrentCoroutines)
+{
+	constexpr int task_count = 1000;
+	sync_thread_pool pool(thread_size);
+	coroutine::scheduler scheduler(pool);
+
+	auto fan_out = [](coroutine::scheduler executor) -> coroutine::task<int>
+	{
+		std::vector<coroutine::task<int>> tasks;
+		for (int i = 0; i < task_count; i++)
+			tasks.emplace_back(scheduled_value(executor, 1));
+
+		int sum = 0;
+		for (auto result : co_await coroutine::when_all(std::move(tasks)))
+			sum += result;
+
+		co_return sum;
+	};
+
+	ASSERT_EQ(coroutine::sync_wait(fan_out(scheduler)), task_count);
+}
+} // namespace framework_tests
+
+#endif // defined(HAS_JTHREAD)
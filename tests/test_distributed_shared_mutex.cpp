@@ -0,0 +1,138 @@
+#include "synchronization/distributed_shared_mutex.h"
+#include "synchronization/lock_owner.h"
+
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace janecekvit;
+using namespace janecekvit::synchronization;
+
+namespace framework_tests
+{
+
+class test_distributed_shared_mutex : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+	}
+
+	void TearDown() override
+	{
+	}
+};
+
+TEST_F(test_distributed_shared_mutex, SlotCount)
+{
+	ASSERT_EQ(distributed_shared_mutex(1).slot_count(), 1);
+	ASSERT_EQ(distributed_shared_mutex(5).slot_count(), 8);
+	ASSERT_GE(distributed_shared_mutex().slot_count(), 1);
+	ASSERT_THROW(distributed_shared_mutex(0), std::invalid_argument);
+
+	static_assert(constraints::is_shared_mutex_type<distributed_shared_mutex>);
+	static_assert(is_supported_mutex<distributed_shared_mutex>);
+}
+
+TEST_F(test_distributed_shared_mutex, TryLock)
+{
+	distributed_shared_mutex mutex(4);
+	{
+		std::shared_lock first(mutex);
+		std::shared_lock second(mutex);
+		ASSERT_FALSE(mutex.try_lock());
+		ASSERT_TRUE(mutex.try_lock_shared());
+		mutex.unlock_shared();
+	}
+
+	ASSERT_TRUE(mutex.try_lock());
+	ASSERT_FALSE(mutex.try_lock_shared());
+	ASSERT_FALSE(mutex.try_lock());
+	mutex.unlock();
+
+	ASSERT_TRUE(mutex.try_lock_shared());
+	mutex.unlock_shared();
+}
+
+TEST_F(test_distributed_shared_mutex, WriterWaitsForReaders)
+{
+	distributed_shared_mutex mutex(2);
+	std::atomic<bool> locked = false;
+
+	std::shared_lock reader(mutex);
+	std::thread writer([&]()
+		{
+			std::unique_lock lock(mutex);
+			locked = true;
+		});
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	ASSERT_FALSE(locked);
+
+	reader.unlock();
+	writer.join();
+	ASSERT_TRUE(locked);
+}
+
+TEST_F(test_distributed_shared_mutex, ReadersAndWriters)
+{
+	constexpr int thread_count = 8;
+	constexpr int iterations = 4800;
+
+	// Slot count smaller than the number of threads, so threads share slots too
+	distributed_shared_mutex mutex(4);
+	int first = 0;
+	int second = 0;
+	std::atomic<int> torn = 0;
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < thread_count; t++)
+	{
+		threads.emplace_back([&, t]()
+			{
+				for (int i = 0; i < iterations; i++)
+				{
+					if ((i + t) % 16 == 0)
+					{
+						std::unique_lock lock(mutex);
+						first++;
+						second++;
+					}
+					else
+					{
+						std::shared_lock lock(mutex);
+						if (first != second)
+							torn++;
+					}
+				}
+			});
+	}
+
+	for (auto& thread : threads)
+		thread.join();
+
+	ASSERT_EQ(torn, 0);
+	ASSERT_EQ(first, thread_count * iterations / 16);
+}
+
+TEST_F(test_distributed_shared_mutex, LockOwner)
+{
+	lock_owner_debug<distributed_shared_mutex> owner;
+	{
+		auto first = owner.concurrent();
+		auto second = owner.concurrent();
+		ASSERT_EQ(owner.get_concurrent_lock_details().size(), 2);
+	}
+
+	{
+		auto exclusive = owner.exclusive();
+		ASSERT_TRUE(owner.get_exclusive_lock_details().has_value());
+	}
+}
+
+} // namespace framework_tests
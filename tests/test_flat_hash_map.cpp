@@ -0,0 +1,199 @@
+#include "synchronization/flat_hash_map.h"
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace janecekvit;
+using namespace janecekvit::synchronization;
+
+namespace framework_tests
+{
+
+class test_flat_hash_map : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+	}
+
+	void TearDown() override
+	{
+	}
+};
+
+struct session_info
+{
+	uint64_t first;
+	uint64_t second;
+};
+
+TEST_F(test_flat_hash_map, ControlWord)
+{
+	using control = concurrent::details::control_word;
+
+	auto word = control::all_empty;
+	word = control::set(word, 2, 0x15);
+	word = control::set(word, 5, control::deleted);
+
+	ASSERT_EQ(control::get(word, 2), 0x15);
+	ASSERT_EQ(control::first(control::match(word, 0x15)), 2);
+	ASSERT_EQ(control::first(control::match_full(word)), 2);
+	ASSERT_EQ(std::popcount(control::match_empty(word)), 6);
+	ASSERT_EQ(std::popcount(control::match_empty_or_deleted(word)), 7);
+	ASSERT_EQ(control::match(control::all_empty, 0x15), 0);
+}
+
+TEST_F(test_flat_hash_map, InsertFindErase)
+{
+	concurrent::flat_hash_map<int, int> map(16);
+	ASSERT_TRUE(map.empty());
+	ASSERT_EQ(map.capacity(), 16);
+
+	ASSERT_TRUE(map.insert(1, 10));
+	ASSERT_FALSE(map.insert(1, 20));
+	ASSERT_EQ(map.find(1), 10);
+	ASSERT_FALSE(map.insert_or_assign(1, 30));
+	ASSERT_EQ(map.find(1), 30);
+	ASSERT_TRUE(map.insert_or_assign(2, 40));
+
+	// Key zero equals the zeroed payload of the empty slots
+	ASSERT_EQ(map.find(0), std::nullopt);
+	ASSERT_FALSE(map.contains(0));
+	ASSERT_TRUE(map.insert(0, 50));
+	ASSERT_EQ(map.find(0), 50);
+
+	ASSERT_EQ(map.size(), 3);
+	ASSERT_EQ(map.erase(1), 1);
+	ASSERT_EQ(map.erase(1), 0);
+	ASSERT_EQ(map.find(1), std::nullopt);
+	ASSERT_EQ(map.size(), 2);
+
+	map.clear();
+	ASSERT_TRUE(map.empty());
+	ASSERT_FALSE(map.contains(2));
+}
+
+TEST_F(test_flat_hash_map, Grow)
+{
+	concurrent::flat_hash_map<uint64_t, session_info> map(8);
+	for (uint64_t i = 0; i < 10000; i++)
+		ASSERT_TRUE(map.insert(i, session_info{ i, i * 2 }));
+
+	ASSERT_EQ(map.size(), 10000);
+	ASSERT_GE(map.capacity(), 10000);
+	for (uint64_t i = 0; i < 10000; i++)
+		ASSERT_EQ(map.find(i)->second, i * 2);
+
+	// Churn leaves deleted slots behind, the table is rehashed instead of growing forever
+	const auto capacity = map.capacity();
+	for (uint64_t i = 10000; i < 100000; i++)
+	{
+		map.insert(i, session_info{ i, i });
+		map.erase(i - 10000);
+	}
+
+	ASSERT_EQ(map.size(), 10000);
+	ASSERT_LE(map.capacity(), capacity * 2);
+}
+
+TEST_F(test_flat_hash_map, Visit)
+{
+	concurrent::flat_hash_map<int, session_info> map;
+	map.insert(1, session_info{ 1, 1 });
+
+	ASSERT_TRUE(map.visit(1, [](session_info& value)
+		{
+			value.second = 5;
+		}));
+	ASSERT_FALSE(map.visit(2, [](session_info&)
+		{
+			FAIL();
+		}));
+
+	uint64_t second = 0;
+	ASSERT_TRUE(std::as_const(map).visit(1, [&second](const session_info& value)
+		{
+			second = value.second;
+		}));
+	ASSERT_EQ(second, 5);
+
+	for (int i = 2; i <= 100; i++)
+		map.insert(i, session_info{ static_cast<uint64_t>(i), 0 });
+
+	uint64_t sum = 0;
+	map.visit_all([&sum](const int&, const session_info& value)
+		{
+			sum += value.first;
+		});
+	ASSERT_EQ(sum, 5050);
+}
+
+TEST_F(test_flat_hash_map, ConcurrentReadersNeverSeeTornValues)
+{
+	constexpr uint64_t key_count = 64;
+	concurrent::flat_hash_map<uint64_t, session_info> map(8);
+	for (uint64_t key = 0; key < key_count; key++)
+		map.insert(key, session_info{ key, key });
+
+	std::atomic<bool> stop = false;
+	std::atomic<int> torn = 0;
+
+	std::vector<std::thread> readers;
+	for (int r = 0; r < 4; r++)
+	{
+		readers.emplace_back([&]()
+			{
+				while (!stop)
+				{
+					for (uint64_t key = 0; key < key_count; key++)
+					{
+						// Both halves are always written together
+						if (auto value = map.find(key); value && value->first != value->second)
+							torn++;
+					}
+				}
+			});
+	}
+
+	std::vector<std::thread> writers;
+	for (uint64_t w = 0; w < 4; w++)
+	{
+		writers.emplace_back([&, w]()
+			{
+				for (uint64_t i = 0; i < 20000; i++)
+				{
+					const auto key = (i * 4 + w) % key_count;
+					map.insert_or_assign(key, session_info{ i, i });
+					map.visit(key, [](session_info& value)
+						{
+							value.first++;
+							value.second++;
+						});
+
+					// Inserts of new keys force the table to grow under the readers
+					const auto extra = key_count + i * 4 + w;
+					map.insert(extra, session_info{ extra, extra });
+					map.erase(extra);
+				}
+			});
+	}
+
+	for (auto& writer : writers)
+		writer.join();
+
+	stop = true;
+	for (auto& reader : readers)
+		reader.join();
+
+	ASSERT_EQ(torn, 0);
+	ASSERT_EQ(map.size(), key_count);
+	for (uint64_t key = 0; key < key_count; key++)
+		ASSERT_TRUE(map.contains(key));
+}
+
+} // namespace framework_tests
@@ -0,0 +1,268 @@
+#include "synchronization/concurrent.h"
+#include "synchronization/lock_owner.h"
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <memory>
+#include <source_location>
+#include <thread>
+#include <vector>
+
+using namespace janecekvit;
+using namespace janecekvit::synchronization;
+
+namespace framework_tests
+{
+
+class test_lock_order : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		lock_order_checker::clear_violations();
+	}
+
+	void TearDown() override
+	{
+		lock_order_checker::clear_violation_callback();
+		lock_order_checker::clear_violations();
+	}
+};
+
+TEST_F(test_lock_order, TestConsistentOrder)
+{
+	lock_owner_ordered<> first;
+	lock_owner_ordered<> second;
+
+	for (int i = 0; i < 3; i++)
+	{
+		auto lock1 = first.exclusive();
+		auto lock2 = second.concurrent();
+	}
+
+	{
+		auto lock2 = second.exclusive();
+	}
+
+	ASSERT_TRUE(lock_order_checker::get_violations().empty());
+}
+
+TEST_F(test_lock_order, TestInvertedOrder)
+{
+	lock_owner_ordered<> first;
+	lock_owner_ordered<> second;
+
+	size_t reported = 0;
+	lock_order_checker::set_violation_callback([&reported](const lock_order_violation&)
+		{
+			reported++;
+		});
+
+	const auto held_line = std::source_location::current().line() + 2;
+	{
+		auto lock1 = first.exclusive();
+		auto lock2 = second.exclusive();
+	}
+
+	// Sequential inversion would deadlock with the previous scope running at the same time
+	const auto inverted_line = std::source_location::current().line() + 2;
+	{
+		auto lock2 = second.concurrent();
+		auto lock1 = first.exclusive();
+	}
+
+	// The cycle is reported once
+	{
+		auto lock2 = second.concurrent();
+		auto lock1 = first.exclusive();
+	}
+
+	ASSERT_EQ(1, reported);
+	const auto violations = lock_order_checker::get_violations();
+	ASSERT_EQ(1, violations.size());
+
+	const auto& cycle = violations.front().Cycle;
+	ASSERT_EQ(2, cycle.size());
+
+	ASSERT_EQ(static_cast<const void*>(&second), cycle[0].HeldOwner);
+	ASSERT_EQ(static_cast<const void*>(&first), cycle[0].AcquiredOwner);
+	ASSERT_EQ(inverted_line, cycle[0].HeldAt.line());
+	ASSERT_EQ(inverted_line + 1, cycle[0].AcquiredAt.line());
+
+	ASSERT_EQ(static_cast<const void*>(&first), cycle[1].HeldOwner);
+	ASSERT_EQ(static_cast<const void*>(&second), cycle[1].AcquiredOwner);
+	ASSERT_EQ(held_line, cycle[1].HeldAt.line());
+	ASSERT_EQ(held_line + 1, cycle[1].AcquiredAt.line());
+	ASSERT_EQ(std::this_thread::get_id(), cycle[1].ThreadId);
+}
+
+TEST_F(test_lock_order, TestLongCycle)
+{
+	concurrent::resource_owner_ordered<int> first;
+	concurrent::resource_owner_ordered<int> second;
+	concurrent::resource_owner_ordered<int> third;
+
+	std::jthread([&]()
+		{
+			auto lock1 = first.exclusive();
+			auto lock2 = second.exclusive();
+		})
+		.join();
+
+	std::jthread([&]()
+		{
+			auto lock2 = second.concurrent();
+			auto lock3 = third.exclusive();
+		})
+		.join();
+
+	ASSERT_TRUE(lock_order_checker::get_violations().empty());
+
+	{
+		auto lock3 = third.exclusive();
+		auto lock1 = first.concurrent();
+	}
+
+	const auto violations = lock_order_checker::get_violations();
+	ASSERT_EQ(1, violations.size());
+	ASSERT_EQ(3, violations.front().Cycle.size());
+	ASSERT_NE(std::this_thread::get_id(), violations.front().Cycle[1].ThreadId);
+}
+
+TEST_F(test_lock_order, TestTryLockAndDestroyedOwners)
+{
+	lock_owner_ordered<> first;
+	{
+		auto second = std::make_unique<lock_owner_ordered<>>();
+		auto lock1 = first.exclusive();
+		auto lock2 = second->exclusive();
+	}
+
+	// Edges of the destroyed owner are forgotten, even when the new owner reuses its address
+	{
+		auto third = std::make_unique<lock_owner_ordered<>>();
+		auto lock3 = third->exclusive();
+		auto lock1 = first.exclusive();
+	}
+
+	// try_lock does not wait, so it adds no edge
+	lock_owner_ordered<> fourth;
+	auto lock4 = fourth.exclusive();
+	lock4.unlock();
+	{
+		auto lock1 = first.exclusive();
+		ASSERT_TRUE(lock4.try_lock());
+		lock4.unlock();
+	}
+
+	{
+		auto lock4_again = fourth.exclusive();
+		auto lock1 = first.exclusive();
+	}
+
+	ASSERT_TRUE(lock_order_checker::get_violations().empty());
+}
+
+TEST_F(test_lock_order, TestMoreEdgesThanCache)
+{
+	const auto make_chain = []()
+	{
+		std::vector<std::unique_ptr<lock_owner_ordered<>>> owners;
+		for (int i = 0; i < 6000; i++)
+			owners.push_back(std::make_unique<lock_owner_ordered<>>());
+
+		// More edges than the cache has slots, evicted edges go through the slow path again
+		for (int pass = 0; pass < 2; pass++)
+		{
+			for (size_t i = 0; i + 1 < owners.size(); i++)
+			{
+				auto lock1 = owners[i]->exclusive();
+				auto lock2 = owners[i + 1]->exclusive();
+			}
+		}
+
+		return owners;
+	};
+
+	auto owners = make_chain();
+	ASSERT_TRUE(lock_order_checker::get_violations().empty());
+
+	{
+		auto lock2 = owners.back()->exclusive();
+		auto lock1 = owners.front()->exclusive();
+	}
+
+	ASSERT_EQ(1, lock_order_checker::get_violations().size());
+	ASSERT_EQ(owners.size(), lock_order_checker::get_violations().front().Cycle.size());
+
+	// Owners in the middle of the chain forget their edges in both directions, so the path is gone
+	lock_order_checker::clear_violations();
+	owners = make_chain();
+	owners.erase(owners.begin() + 1, owners.end() - 1);
+	{
+		auto lock2 = owners.back()->exclusive();
+		auto lock1 = owners.front()->exclusive();
+	}
+
+	ASSERT_TRUE(lock_order_checker::get_violations().empty());
+}
+
+TEST_F(test_lock_order, TestMultipleThreads)
+{
+	std::vector<std::unique_ptr<lock_owner_ordered<>>> owners;
+	for (int i = 0; i < 4; i++)
+		owners.push_back(std::make_unique<lock_owner_ordered<>>());
+
+	std::vector<std::jthread> threads;
+	for (int t = 0; t < 4; t++)
+	{
+		threads.emplace_back([&owners, t]()
+			{
+				for (int i = 0; i < 2000; i++)
+				{
+					const auto first = static_cast<size_t>((i + t) % 3);
+					auto lock1 = owners[first]->concurrent();
+					auto lock2 = owners[first + 1]->concurrent();
+				}
+			});
+	}
+
+	threads.clear();
+	ASSERT_TRUE(lock_order_checker::get_violations().empty());
+}
+
+TEST_F(test_lock_order, TestLockAll)
+{
+	lock_owner_ordered<> first;
+	lock_owner_ordered<> second;
+	lock_owner_ordered<> third;
+
+	// lock_all blocks only while it holds nothing, so the opposite orders of its intents are no violation
+	{
+		auto holders = lock_all(first.exclusive_intent(), second.concurrent_intent());
+	}
+
+	{
+		auto holders = lock_all(second.exclusive_intent(), first.exclusive_intent());
+	}
+
+	ASSERT_TRUE(lock_order_checker::get_violations().empty());
+
+	// Holders acquired by lock_all are held by the thread like any other holder
+	{
+		auto [lock1, lock2] = lock_all(first.concurrent_intent(), second.exclusive_intent());
+		auto lock3 = third.exclusive();
+	}
+
+	{
+		auto lock3 = third.exclusive();
+		auto [lock2] = lock_all(second.exclusive_intent());
+	}
+
+	const auto violations = lock_order_checker::get_violations();
+	ASSERT_EQ(1, violations.size());
+	ASSERT_EQ(static_cast<const void*>(&third), violations.front().Cycle[0].HeldOwner);
+	ASSERT_EQ(static_cast<const void*>(&second), violations.front().Cycle[0].AcquiredOwner);
+}
+
+} // namespace framework_tests
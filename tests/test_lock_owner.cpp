@@ -1,11 +1,14 @@
 #include "synchronization/lock_owner.h"
 
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <gtest/gtest.h>
 #include <mutex>
 #include <system_error>
+#include <thread>
 #include <utility>
+#include <vector>
 
 using namespace janecekvit;
 using namespace janecekvit::synchronization;
@@ -260,6 +263,145 @@ TEST_F(test_lock_owner, TestConcurentAccessMove)
 	ASSERT_EQ(1, owner.get_concurrent_lock_details().size());
 }
 
+TEST_F(test_lock_owner, TestConcurrentTrackingSlots)
+{
+	synchronization::lock_owner_debug<> owner;
+	const auto line = std::source_location::current().line() + 1;
+	auto lock = owner.concurrent();
+
+	auto details = owner.get_concurrent_lock_details();
+	ASSERT_EQ(1, details.size());
+	ASSERT_TRUE(details.contains(&lock));
+	ASSERT_EQ(line, details.at(&lock).Location.line());
+	ASSERT_EQ(std::this_thread::get_id(), details.at(&lock).ThreadId);
+
+	auto moved = std::move(lock);
+	details = owner.get_concurrent_lock_details();
+	ASSERT_EQ(1, details.size());
+	ASSERT_TRUE(details.contains(&moved));
+	ASSERT_EQ(line, details.at(&moved).Location.line());
+}
+
+TEST_F(test_lock_owner, TestLockRecord)
+{
+	// Every call site is interned once
+	const auto location = []()
+	{
+		return std::source_location::current();
+	};
+	const auto* interned = synchronization::details::call_site_table::intern(location());
+	ASSERT_EQ(interned, synchronization::details::call_site_table::intern(location()));
+	ASSERT_NE(interned, synchronization::details::call_site_table::intern(std::source_location::current()));
+	ASSERT_EQ(location().line(), interned->line());
+
+	const auto before = std::chrono::system_clock::now();
+	const auto record = synchronization::details::lock_record::make(typeid(std::shared_mutex), location(), typeid(int));
+	const auto after = std::chrono::system_clock::now();
+
+	std::optional<synchronization::details::lock_record> other;
+	std::jthread([&other, &location]()
+		{
+			other = synchronization::details::lock_record::make(typeid(std::mutex), location());
+		})
+		.join();
+
+	ASSERT_EQ(interned, record.location);
+	ASSERT_NE(record.thread, other->thread);
+
+	const auto info = record.to_information();
+	ASSERT_EQ(typeid(std::shared_mutex), info.MutexType);
+	ASSERT_EQ(typeid(int), info.ResourceType);
+	ASSERT_EQ(std::this_thread::get_id(), info.ThreadId);
+	ASSERT_EQ(location().line(), info.Location.line());
+	ASSERT_GE(info.AcquiredAt, before - std::chrono::milliseconds(10));
+	ASSERT_LE(info.AcquiredAt, after + std::chrono::milliseconds(10));
+
+	// The index of the exited thread is released and reused by the next thread, its records keep reporting an empty id
+	const auto other_info = other->to_information();
+	ASSERT_EQ(std::thread::id(), other_info.ThreadId);
+	ASSERT_FALSE(other_info.ResourceType.has_value());
+
+	std::thread::id next_id;
+	std::optional<synchronization::details::lock_record> next;
+	std::optional<synchronization::lock_information> next_info;
+	std::jthread([&]()
+		{
+			next_id	  = std::this_thread::get_id();
+			next	  = synchronization::details::lock_record::make(typeid(std::mutex), location());
+			next_info = next->to_information();
+		})
+		.join();
+
+	ASSERT_EQ(static_cast<uint32_t>(other->thread), static_cast<uint32_t>(next->thread));
+	ASSERT_NE(other->thread, next->thread);
+	ASSERT_EQ(next_id, next_info->ThreadId);
+	ASSERT_EQ(std::thread::id(), other->to_information().ThreadId);
+}
+
+TEST_F(test_lock_owner, TestConcurrentTrackingOverflow)
+{
+	synchronization::lock_owner_debug<> owner;
+	constexpr size_t count = 2 * synchronization::details::lock_tracking_slots::slot_count;
+
+	// Holders beyond the slot count are kept in the overflow map
+	std::vector<synchronization::lock_owner_debug<>::concurrent_holder_type> locks;
+	locks.reserve(count);
+	for (size_t i = 0; i < count; i++)
+		locks.emplace_back(owner.concurrent());
+
+	auto details = owner.get_concurrent_lock_details();
+	ASSERT_EQ(count, details.size());
+	for (auto& lock : locks)
+		ASSERT_TRUE(details.contains(&lock));
+
+	auto moved = std::move(locks.back());
+	locks.pop_back();
+	ASSERT_EQ(count, owner.get_concurrent_lock_details().size());
+	ASSERT_TRUE(owner.get_concurrent_lock_details().contains(&moved));
+
+	for (size_t i = 0; i < locks.size(); i += 2)
+		locks[i].unlock();
+
+	ASSERT_EQ(count / 2, owner.get_concurrent_lock_details().size());
+
+	locks.clear();
+	moved.unlock();
+	ASSERT_EQ(0, owner.get_concurrent_lock_details().size());
+}
+
+TEST_F(test_lock_owner, TestConcurrentTrackingMultipleThreads)
+{
+	synchronization::lock_tracking_runtime::enable_tracking();
+	{
+		synchronization::lock_owner_runtime<> owner;
+		std::atomic<bool> stop = false;
+		std::atomic<size_t> missing = 0;
+
+		std::vector<std::jthread> readers;
+		for (int r = 0; r < 8; r++)
+		{
+			readers.emplace_back([&]()
+				{
+					while (!stop)
+					{
+						auto lock = owner.concurrent();
+						if (lock.owns_lock() && !owner.get_concurrent_lock_details().contains(&lock))
+							missing++;
+					}
+				});
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		stop = true;
+		for (auto& reader : readers)
+			reader.join();
+
+		ASSERT_EQ(0, missing);
+		ASSERT_EQ(0, owner.get_concurrent_lock_details().size());
+	}
+	synchronization::lock_tracking_runtime::disable_tracking();
+}
+
 TEST_F(test_lock_owner, TestConcurrentAccessWait)
 {
 	synchronization::lock_owner_debug<> owner;
@@ -0,0 +1,220 @@
+#include "synchronization/concurrent.h"
+#include "synchronization/lock_owner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <latch>
+#include <source_location>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace janecekvit;
+using namespace janecekvit::synchronization;
+
+namespace framework_tests
+{
+
+class test_lock_profile : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+	}
+
+	void TearDown() override
+	{
+	}
+};
+
+namespace
+{
+template <size_t _Index>
+std::source_location call_site()
+{
+	return std::source_location::current();
+}
+
+template <size_t... _Indexes>
+std::vector<std::source_location> call_sites(std::index_sequence<_Indexes...>)
+{
+	return { call_site<_Indexes>()... };
+}
+
+const lock_call_site_profile* find_site(const lock_owner_profile& profile, uint_least32_t line)
+{
+	auto it = std::ranges::find_if(profile.CallSites, [line](const auto& site)
+		{
+			return site.Location.line() == line;
+		});
+
+	return it != profile.CallSites.end() ? &*it : nullptr;
+}
+} // namespace
+
+TEST_F(test_lock_profile, TestCallSites)
+{
+	lock_owner_profiled<> owner;
+	ASSERT_TRUE(owner.get_contention_profile().CallSites.empty());
+
+	uint_least32_t exclusive_line = 0;
+	for (int i = 0; i < 3; i++)
+	{
+		exclusive_line = std::source_location::current().line() + 1;
+		auto lock = owner.exclusive();
+		if (i == 0)
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+	}
+
+	const auto concurrent_line = std::source_location::current().line() + 1;
+	auto first = owner.concurrent();
+	auto second = std::move(first);
+	second.unlock();
+	second.lock();
+	second.unlock();
+
+	const auto profile = owner.get_contention_profile();
+	ASSERT_EQ(static_cast<const void*>(&owner), profile.Owner);
+	ASSERT_EQ(typeid(std::shared_mutex), profile.MutexType);
+	ASSERT_FALSE(profile.ResourceType.has_value());
+	ASSERT_EQ(3, profile.CallSites.size());
+
+	const auto* exclusive = find_site(profile, exclusive_line);
+	ASSERT_NE(nullptr, exclusive);
+	ASSERT_EQ(3, exclusive->ExclusiveWait.Count);
+	ASSERT_EQ(3, exclusive->ExclusiveHold.Count);
+	ASSERT_EQ(0, exclusive->ConcurrentHold.Count);
+	ASSERT_GE(exclusive->ExclusiveHold.Max, std::chrono::milliseconds(1));
+	ASSERT_GE(exclusive->ExclusiveHold.Total, exclusive->ExclusiveHold.Max);
+	ASSERT_LE(exclusive->ExclusiveHold.percentile(0.5), exclusive->ExclusiveHold.percentile(1.0));
+
+	// The moved holder keeps the call site of its first acquisition, lock() has its own call site
+	const auto* concurrent = find_site(profile, concurrent_line);
+	ASSERT_NE(nullptr, concurrent);
+	ASSERT_EQ(1, concurrent->ConcurrentWait.Count);
+	ASSERT_EQ(1, concurrent->ConcurrentHold.Count);
+	ASSERT_EQ(0, concurrent->ExclusiveWait.Count);
+}
+
+TEST_F(test_lock_profile, TestContendedWait)
+{
+	lock_owner_profiled<> owner;
+	std::latch locked(1);
+
+	auto writer = std::jthread([&]()
+		{
+			auto lock = owner.exclusive();
+			locked.count_down();
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		});
+
+	locked.wait();
+	{
+		auto lock = owner.concurrent();
+	}
+	writer.join();
+
+	const auto profile = owner.get_contention_profile();
+	const auto waited = std::ranges::max(profile.CallSites, {}, [](const auto& site)
+		{
+			return site.ConcurrentWait.Max;
+		});
+
+	ASSERT_GE(waited.ConcurrentWait.Max, std::chrono::milliseconds(5));
+	ASSERT_EQ(1, waited.ConcurrentWait.Count);
+}
+
+TEST_F(test_lock_profile, TestCallSitesOverflow)
+{
+	lock_owner_profiled<> owner;
+	const auto sites = call_sites(std::make_index_sequence<2 * details::contention_table::site_count>());
+	for (const auto& site : sites)
+	{
+		auto lock = owner.exclusive(site);
+	}
+
+	const auto profile = owner.get_contention_profile();
+	ASSERT_EQ(details::contention_table::site_count + 1, profile.CallSites.size());
+
+	uint64_t acquisitions = 0;
+	for (const auto& site : profile.CallSites)
+		acquisitions += site.ExclusiveHold.Count;
+
+	ASSERT_EQ(sites.size(), acquisitions);
+
+	// The shared site of the overflowing call sites has no location
+	ASSERT_EQ(1, std::ranges::count_if(profile.CallSites, [](const auto& site)
+					 {
+						 return site.Location.line() == 0;
+					 }));
+}
+
+TEST_F(test_lock_profile, TestProfilerExport)
+{
+	concurrent::resource_owner_profiled<std::vector<int>> owner;
+	std::vector<std::jthread> threads;
+	for (int t = 0; t < 4; t++)
+	{
+		threads.emplace_back([&owner]()
+			{
+				for (int i = 0; i < 1000; i++)
+				{
+					owner.exclusive()->push_back(i);
+					[[maybe_unused]] auto size = owner.concurrent()->size();
+				}
+			});
+	}
+
+	threads.clear();
+
+	const auto profiles = lock_contention_profiler::snapshot();
+	auto it = std::ranges::find_if(profiles, [](const auto& profile)
+		{
+			return profile.ResourceType == typeid(std::vector<int>);
+		});
+
+	ASSERT_NE(profiles.end(), it);
+	ASSERT_EQ(2, it->CallSites.size());
+
+	uint64_t exclusive = 0;
+	uint64_t concurrent = 0;
+	for (const auto& site : it->CallSites)
+	{
+		exclusive += site.ExclusiveHold.Count;
+		concurrent += site.ConcurrentHold.Count;
+	}
+
+	ASSERT_EQ(4000, exclusive);
+	ASSERT_EQ(4000, concurrent);
+
+	std::ostringstream stream;
+	lock_contention_profiler::export_csv(stream);
+	const auto csv = stream.str();
+	ASSERT_EQ(0, csv.find("owner,mutex_type,resource_type,file,line,function,histogram,count"));
+	ASSERT_NE(std::string::npos, csv.find("\"exclusive_hold\",4000,"));
+	ASSERT_NE(std::string::npos, csv.find("\"concurrent_wait\",4000,"));
+
+	// Separators inside quoted fields do not split them, every line has all columns
+	std::istringstream lines(csv);
+	std::string line;
+	while (std::getline(lines, line))
+	{
+		size_t fields = 1;
+		bool quoted = false;
+		for (auto character : line)
+		{
+			if (character == '"')
+				quoted = !quoted;
+			else if (character == ',' && !quoted)
+				fields++;
+		}
+
+		ASSERT_FALSE(quoted);
+		ASSERT_EQ(12, fields);
+	}
+}
+
+} // namespace framework_tests
@@ -0,0 +1,155 @@
+#include "thread/parallel.h"
+#include "thread/sync_thread_pool.h"
+#include "thread/work_stealing_thread_pool.h"
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace janecekvit::thread;
+
+#if defined(HAS_JTHREAD)
+
+namespace framework_tests
+{
+constexpr const size_t thread_size = 4;
+
+class test_parallel : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+	}
+
+	void TearDown() override
+	{
+	}
+};
+
+TEST_F(test_parallel, ParallelForIndexes)
+{
+	sync_thread_pool pool(thread_size);
+	std::vector<std::atomic<int>> visited(10000);
+
+	parallel_for(pool, 0, 10000, [&visited](int i)
+		{
+			visited[i]++;
+		});
+
+	for (auto& value : visited)
+		ASSERT_EQ(value, 1);
+}
+
+TEST_F(test_parallel, ParallelForRange)
+{
+	work_stealing_thread_pool pool(thread_size);
+	std::vector<int> values(1000, 1);
+
+	parallel_for(
+		pool, values, [](int& value)
+		{
+			value *= 3;
+		},
+		7);
+
+	ASSERT_EQ(std::accumulate(values.begin(), values.end(), 0), 3000);
+}
+
+TEST_F(test_parallel, ParallelForEmptyRange)
+{
+	sync_thread_pool pool(thread_size);
+	std::atomic<int> counter = 0;
+
+	parallel_for(pool, 5, 5, [&counter](int)
+		{
+			counter++;
+		});
+	parallel_for(pool, std::vector<int>{}, [&counter](int)
+		{
+			counter++;
+		});
+
+	ASSERT_EQ(counter, 0);
+}
+
+TEST_F(test_parallel, ParallelForFromWorker)
+{
+	// All workers are busy with the outer loop, the calling threads have to execute the nested chunks themselves
+	sync_thread_pool pool(2);
+	std::atomic<int> counter = 0;
+
+	parallel_for(
+		pool, 0, 8, [&](int)
+		{
+			parallel_for(pool, 0, 100, [&counter](int)
+				{
+					counter++;
+				});
+		},
+		1);
+
+	ASSERT_EQ(counter, 800);
+}
+
+TEST_F(test_parallel, ParallelForException)
+{
+	sync_thread_pool pool(thread_size);
+
+	ASSERT_THROW(parallel_for(pool, 0, 1000, [](int i)
+					 {
+						 if (i == 500)
+							 throw std::runtime_error("failure");
+					 }),
+		std::runtime_error);
+}
+
+TEST_F(test_parallel, ParallelReduce)
+{
+	sync_thread_pool pool(thread_size);
+	std::vector<long long> values(100000);
+	std::iota(values.begin(), values.end(), 1);
+
+	const auto sum = parallel_reduce(pool, values, 0LL, std::plus<>{});
+	ASSERT_EQ(sum, 100000LL * 100001LL / 2);
+
+	const auto squares = parallel_reduce(pool, 1, 101, 0, std::plus<>{}, [](int i)
+		{
+			return i * i;
+		});
+	ASSERT_EQ(squares, 338350);
+}
+
+TEST_F(test_parallel, ParallelReduceKeepsOrder)
+{
+	work_stealing_thread_pool pool(thread_size);
+	std::vector<std::string> values;
+	for (char c = 'a'; c <= 'z'; c++)
+		values.emplace_back(1, c);
+
+	const auto result = parallel_reduce(
+		pool, values, std::string(">"), std::plus<>{}, std::identity{}, 3);
+	ASSERT_EQ(result, ">abcdefghijklmnopqrstuvwxyz");
+}
+
+TEST_F(test_parallel, ParallelTransform)
+{
+	sync_thread_pool pool(thread_size);
+	std::vector<int> values(5000);
+	std::iota(values.begin(), values.end(), 0);
+	std::vector<long long> output(values.size());
+
+	auto end = parallel_transform(pool, values, output.begin(), [](int i)
+		{
+			return static_cast<long long>(i) * 2;
+		});
+
+	ASSERT_EQ(end, output.end());
+	for (size_t i = 0; i < output.size(); i++)
+		ASSERT_EQ(output[i], static_cast<long long>(i) * 2);
+}
+} // namespace framework_tests
+
+#endif // defined(HAS_JTHREAD)
@@ -0,0 +1,403 @@
+#include "thread/sync_thread_pool.h"
+
+#include <array>
+#include <cstddef>
+#include <future>
+#include <gtest/gtest.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace janecekvit::thread;
+
+#if defined(HAS_JTHREAD)
+
+namespace framework_tests
+{
+constexpr const size_t thread_size = 4;
+
+class test_pooled_future : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+	}
+
+	void TearDown() override
+	{
+	}
+};
+
+TEST_F(test_pooled_future, GetValue)
+{
+	sync_thread_pool pool(thread_size);
+	auto future = pool.add_pooled_task([]()
+		{
+			return std::string("pooled");
+		});
+
+	ASSERT_TRUE(future.valid());
+	ASSERT_EQ(future.get(), "pooled");
+	ASSERT_FALSE(future.valid());
+	ASSERT_THROW(future.get(), std::future_error);
+}
+
+TEST_F(test_pooled_future, GetVoid)
+{
+	std::atomic<int> counter = 0;
+	sync_thread_pool pool(thread_size);
+	auto future = pool.add_pooled_task([&counter]()
+		{
+			counter++;
+		});
+
+	future.wait();
+	ASSERT_TRUE(future.is_ready());
+	future.get();
+	ASSERT_EQ(counter, 1);
+}
+
+TEST_F(test_pooled_future, GetException)
+{
+	sync_thread_pool pool(thread_size);
+	auto future = pool.add_pooled_task([]() -> int
+		{
+			throw std::runtime_error("failure");
+		});
+
+	ASSERT_THROW(future.get(), std::runtime_error);
+}
+
+TEST_F(test_pooled_future, MoveOnlyResult)
+{
+	sync_thread_pool pool(thread_size);
+	auto future = pool.add_pooled_task([]()
+		{
+			return std::make_unique<int>(5);
+		});
+
+	ASSERT_EQ(*future.get(), 5);
+}
+
+TEST_F(test_pooled_future, LargeCallableAndResult)
+{
+	std::array<size_t, 32> input = {};
+	input.fill(3);
+
+	sync_thread_pool pool(thread_size);
+	auto future = pool.add_pooled_task([input]()
+		{
+			auto output = input;
+			for (auto& value : output)
+				value *= 2;
+
+			return output;
+		});
+
+	auto output = future.get();
+	ASSERT_EQ(output.front(), 6);
+	ASSERT_EQ(output.back(), 6);
+}
+
+TEST_F(test_pooled_future, ThenChain)
+{
+	sync_thread_pool pool(thread_size);
+	auto future = pool.add_pooled_task([]()
+					  {
+						  return 5;
+					  })
+					  .then([](int value)
+						  {
+							  return value * 2;
+						  })
+					  .then([](int value)
+						  {
+							  return std::to_string(value);
+						  });
+
+	ASSERT_EQ(future.get(), "10");
+}
+
+TEST_F(test_pooled_future, ThenAfterCompletion)
+{
+	sync_thread_pool pool(thread_size);
+	auto first = pool.add_pooled_task([]()
+		{
+		});
+
+	first.wait();
+	auto second = first.then([]()
+		{
+			return 7;
+		});
+
+	ASSERT_FALSE(first.valid());
+	ASSERT_EQ(second.get(), 7);
+}
+
+TEST_F(test_pooled_future, ThenPropagatesException)
+{
+	std::atomic<bool> invoked = false;
+	sync_thread_pool pool(thread_size);
+	auto future = pool.add_pooled_task([]() -> int
+					  {
+						  throw std::runtime_error("failure");
+					  })
+					  .then([&invoked](int value)
+						  {
+							  invoked = true;
+							  return value;
+						  });
+
+	ASSERT_THROW(future.get(), std::runtime_error);
+	ASSERT_FALSE(invoked);
+}
+
+TEST_F(test_pooled_future, FutureOutlivesPool)
+{
+	pooled_future<int> future;
+	{
+		sync_thread_pool pool(thread_size);
+		future = pool.add_pooled_task([]()
+			{
+				return 5;
+			});
+	}
+
+	ASSERT_TRUE(future.is_ready());
+	ASSERT_EQ(future.get(), 5);
+}
+
+TEST_F(test_pooled_future, ThenAfterPoolDestructionRunsInline)
+{
+	pooled_future<int> future;
+	{
+		sync_thread_pool pool(thread_size);
+		future = pool.add_pooled_task([]()
+			{
+				return 5;
+			});
+	}
+
+	auto next = future.then([](int value)
+		{
+			return value + 1;
+		});
+
+	ASSERT_TRUE(next.is_ready());
+	ASSERT_EQ(next.get(), 6);
+}
+
+TEST_F(test_pooled_future, ManyTasksReuseStates)
+{
+	constexpr int task_count = 1000;
+	sync_thread_pool pool(thread_size);
+
+	int sum = 0;
+	for (int i = 0; i < task_count; i++)
+	{
+		sum += pool.add_pooled_task([i]()
+					   {
+						   return i;
+					   })
+				   .get();
+	}
+
+	std::vector<pooled_future<int>> results;
+	for (int i = 0; i < task_count; i++)
+	{
+		results.emplace_back(pool.add_pooled_task([i]()
+			{
+				return i;
+			}));
+	}
+
+	for (auto& result : results)
+		sum -= result.get();
+
+	ASSERT_EQ(sum, 0);
+}
+
+TEST_F(test_pooled_future, OnErrorRecovers)
+{
+	sync_thread_pool pool(thread_size);
+	auto future = pool.add_pooled_task([]() -> int
+					  {
+						  throw std::runtime_error("failure");
+					  })
+					  .on_error([](std::exception_ptr exception)
+						  {
+							  try
+							  {
+								  std::rethrow_exception(exception);
+							  }
+							  catch (const std::runtime_error&)
+							  {
+								  return -1;
+							  }
+						  })
+					  .then([](int value)
+						  {
+							  return value * 2;
+						  });
+
+	ASSERT_EQ(future.get(), -2);
+}
+
+TEST_F(test_pooled_future, OnErrorSkippedOnSuccess)
+{
+	std::atomic<bool> invoked = false;
+	sync_thread_pool pool(thread_size);
+	auto future = pool.add_pooled_task([]()
+					  {
+						  return 5;
+					  })
+					  .on_error([&invoked](std::exception_ptr)
+						  {
+							  invoked = true;
+							  return 0;
+						  });
+
+	ASSERT_EQ(future.get(), 5);
+	ASSERT_FALSE(invoked);
+}
+
+TEST_F(test_pooled_future, WhenAllTuple)
+{
+	std::atomic<int> counter = 0;
+	sync_thread_pool pool(thread_size);
+	auto future = when_all(pool.add_pooled_task([]()
+							   {
+								   return 5;
+							   }),
+		pool.add_pooled_task([&counter]()
+			{
+				counter++;
+			}),
+		pool.add_pooled_task([]()
+			{
+				return std::string("all");
+			}));
+
+	auto [number, nothing, text] = future.get();
+	ASSERT_EQ(number, 5);
+	ASSERT_EQ(counter, 1);
+	ASSERT_EQ(text, "all");
+}
+
+TEST_F(test_pooled_future, WhenAllVector)
+{
+	sync_thread_pool pool(thread_size);
+	std::vector<pooled_future<int>> futures;
+	for (int i = 0; i < 100; i++)
+	{
+		futures.emplace_back(pool.add_pooled_task([i]()
+			{
+				return i;
+			}));
+	}
+
+	auto sum = when_all(std::move(futures)).then([](std::vector<int> values)
+		{
+			int result = 0;
+			for (auto value : values)
+				result += value;
+
+			return result;
+		});
+
+	ASSERT_EQ(sum.get(), 4950);
+}
+
+TEST_F(test_pooled_future, WhenAllException)
+{
+	sync_thread_pool pool(thread_size);
+	auto future = when_all(pool.add_pooled_task([]()
+							   {
+								   return 5;
+							   }),
+		pool.add_pooled_task([]() -> int
+			{
+				throw std::runtime_error("failure");
+			}));
+
+	ASSERT_THROW(future.get(), std::runtime_error);
+}
+
+TEST_F(test_pooled_future, WhenAllInvalid)
+{
+	ASSERT_THROW((void) when_all(std::vector<pooled_future<int>>()), std::invalid_argument);
+	ASSERT_THROW((void) when_all(pooled_future<int>()), std::future_error);
+}
+
+/// Boxed callable which cannot be moved into the state
+struct unmovable_callable
+{
+	unmovable_callable() = default;
+
+	unmovable_callable(unmovable_callable&&)
+	{
+		throw std::length_error("unmovable");
+	}
+
+	int operator()() const
+	{
+		return 1;
+	}
+
+	std::array<std::byte, 2 * janecekvit::thread::details::pooled_state::inline_size> padding = {};
+};
+
+TEST_F(test_pooled_future, AcquireTaskThrows)
+{
+	using namespace janecekvit::thread::details;
+	std::unique_ptr<pooled_state_allocator, pooled_state_allocator::detacher> allocator(new pooled_state_allocator(nullptr, nullptr));
+
+	// The released state is on the top of the free list
+	auto* released = &allocator->acquire_task<int>([]()
+		{
+			return 1;
+		});
+	pooled_state::release(*released);
+	pooled_state::release(*released);
+
+	// The state of the failed emplacement is returned to the free list instead of being leaked
+	ASSERT_THROW((void) allocator->acquire_task<int>(unmovable_callable()), std::length_error);
+
+	auto& reused = allocator->acquire_task<int>([]()
+		{
+			return 2;
+		});
+	ASSERT_EQ(released, &reused);
+	pooled_state::release(reused);
+	pooled_state::release(reused);
+}
+
+TEST_F(test_pooled_future, PipelineDoesNotBlockWorker)
+{
+	// With a single worker any stage blocked on its predecessor would deadlock the pipeline
+	sync_thread_pool pool(1);
+	std::vector<pooled_future<int>> stages;
+	for (int i = 0; i < 10; i++)
+	{
+		stages.emplace_back(pool.add_pooled_task([i]()
+								  {
+									  return i;
+								  })
+								.then([](int value)
+									{
+										return value + 1;
+									}));
+	}
+
+	auto future = when_all(std::move(stages)).then([](std::vector<int> values)
+		{
+			return values.back();
+		});
+
+	ASSERT_EQ(future.get(), 10);
+}
+} // namespace framework_tests
+
+#endif // defined(HAS_JTHREAD)
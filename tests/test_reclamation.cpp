@@ -0,0 +1,243 @@
+#include "synchronization/reclamation.h"
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace janecekvit;
+using namespace janecekvit::synchronization;
+
+namespace framework_tests
+{
+
+class test_reclamation : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+	}
+
+	void TearDown() override
+	{
+	}
+};
+
+/// Both halves are always written together, the deleted object is poisoned
+struct tracked_value
+{
+	explicit tracked_value(uint64_t value)
+		: first(value)
+		, second(value)
+	{
+		alive++;
+	}
+
+	~tracked_value()
+	{
+		first = 1;
+		second = 2;
+		alive--;
+	}
+
+	uint64_t first;
+	uint64_t second;
+	static inline std::atomic<int> alive = 0;
+};
+
+TEST_F(test_reclamation, EpochRetireAndCollect)
+{
+	tracked_value::alive = 0;
+	epoch_domain domain;
+	ASSERT_EQ(domain.collect(), 0);
+
+	{
+		auto guard = domain.pin();
+		ASSERT_TRUE(guard.owns_epoch());
+
+		domain.retire(new tracked_value(1));
+		ASSERT_EQ(domain.retired_count(), 1);
+
+		// The pinned reader may still hold the object
+		domain.collect();
+		domain.collect();
+		ASSERT_EQ(domain.collect(), 0);
+		ASSERT_EQ(tracked_value::alive, 1);
+
+		// Guards of one thread may be nested
+		auto nested = domain.pin();
+		nested.reset();
+		ASSERT_FALSE(nested.owns_epoch());
+		ASSERT_EQ(domain.collect(), 0);
+	}
+
+	domain.collect();
+	domain.collect();
+	ASSERT_EQ(domain.retired_count(), 0);
+	ASSERT_EQ(tracked_value::alive, 0);
+}
+
+TEST_F(test_reclamation, EpochSynchronize)
+{
+	tracked_value::alive = 0;
+	epoch_domain domain;
+	const auto epoch = domain.epoch();
+
+	domain.retire(new tracked_value(1));
+	domain.retire(static_cast<tracked_value*>(nullptr));
+	domain.synchronize();
+
+	ASSERT_GE(domain.epoch(), epoch + 2);
+	ASSERT_EQ(domain.retired_count(), 0);
+	ASSERT_EQ(tracked_value::alive, 0);
+
+	auto guard = domain.pin();
+	ASSERT_THROW(domain.synchronize(), std::logic_error);
+}
+
+TEST_F(test_reclamation, EpochRetireCollectsRarelyReplacedObjects)
+{
+	tracked_value::alive = 0;
+	epoch_domain domain;
+
+	// Far below the collect threshold, the retired copies are still deleted as the epoch advances
+	for (int i = 0; i < 10; i++)
+	{
+		domain.retire(new tracked_value(i));
+		ASSERT_LE(domain.retired_count(), 2);
+	}
+
+	ASSERT_LE(tracked_value::alive, 2);
+}
+
+TEST_F(test_reclamation, EpochDestroyedDomainDeletesRetired)
+{
+	tracked_value::alive = 0;
+	{
+		epoch_domain domain;
+		for (int i = 0; i < 10; i++)
+			domain.retire(new tracked_value(i));
+
+		// The thread record outlives the domain, it is released when the thread exits
+		std::jthread([&domain]()
+			{
+				auto guard = domain.pin();
+			});
+	}
+
+	ASSERT_EQ(tracked_value::alive, 0);
+}
+
+TEST_F(test_reclamation, EpochConcurrentReaders)
+{
+	tracked_value::alive = 0;
+	epoch_domain domain;
+	std::atomic<tracked_value*> current = new tracked_value(0);
+	std::atomic<bool> stop = false;
+	std::atomic<int> torn = 0;
+
+	std::vector<std::jthread> readers;
+	for (int r = 0; r < 4; r++)
+	{
+		readers.emplace_back([&]()
+			{
+				while (!stop)
+				{
+					auto guard = domain.pin();
+					const auto* value = current.load(std::memory_order_acquire);
+					if (value->first != value->second)
+						torn++;
+				}
+			});
+	}
+
+	for (uint64_t i = 1; i <= 20000; i++)
+		domain.retire(current.exchange(new tracked_value(i), std::memory_order_acq_rel));
+
+	stop = true;
+	for (auto& reader : readers)
+		reader.join();
+
+	domain.synchronize();
+	ASSERT_EQ(torn, 0);
+	ASSERT_EQ(tracked_value::alive, 1);
+	delete current.load();
+}
+
+TEST_F(test_reclamation, HazardPointers)
+{
+	tracked_value::alive = 0;
+	hazard_domain domain;
+	std::atomic<tracked_value*> current = new tracked_value(1);
+
+	{
+		auto hazard = domain.make_hazard_pointer();
+		ASSERT_FALSE(hazard.empty());
+		auto* protected_value = hazard.protect(current);
+
+		domain.retire(current.exchange(new tracked_value(2)));
+		ASSERT_EQ(domain.collect(), 0);
+		ASSERT_EQ(protected_value->first, 1);
+
+		// Slots of destroyed hazard pointers are reused
+		auto moved = std::move(hazard);
+		ASSERT_TRUE(hazard.empty());
+		moved.reset_protection();
+		ASSERT_EQ(domain.collect(), 1);
+
+		auto* expected = protected_value;
+		ASSERT_FALSE(moved.try_protect(expected, current));
+		ASSERT_EQ(expected, current.load());
+	}
+
+	ASSERT_EQ(tracked_value::alive, 1);
+	domain.retire(current.exchange(nullptr));
+	ASSERT_EQ(domain.collect(), 1);
+	ASSERT_EQ(tracked_value::alive, 0);
+}
+
+TEST_F(test_reclamation, HazardConcurrentReaders)
+{
+	tracked_value::alive = 0;
+	{
+		hazard_domain domain;
+		std::atomic<tracked_value*> current = new tracked_value(0);
+		std::atomic<bool> stop = false;
+		std::atomic<int> torn = 0;
+
+		std::vector<std::jthread> readers;
+		for (int r = 0; r < 4; r++)
+		{
+			readers.emplace_back([&]()
+				{
+					auto hazard = domain.make_hazard_pointer();
+					while (!stop)
+					{
+						const auto* value = hazard.protect(current);
+						if (value->first != value->second)
+							torn++;
+
+						hazard.reset_protection();
+					}
+				});
+		}
+
+		for (uint64_t i = 1; i <= 20000; i++)
+			domain.retire(current.exchange(new tracked_value(i), std::memory_order_acq_rel));
+
+		stop = true;
+		for (auto& reader : readers)
+			reader.join();
+
+		// Retired objects stay bounded by the scans
+		ASSERT_LT(domain.retired_count(), 2 * hazard_domain::collect_threshold);
+		ASSERT_EQ(torn, 0);
+		delete current.load();
+	}
+
+	ASSERT_EQ(tracked_value::alive, 0);
+}
+
+} // namespace framework_tests
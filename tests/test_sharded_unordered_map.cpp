@@ -0,0 +1,193 @@
+#include "synchronization/sharded_unordered_map.h"
+
+#include <algorithm>
+#include <atomic>
+#include <gtest/gtest.h>
+#include <memory>
+#include <source_location>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace janecekvit;
+using namespace janecekvit::synchronization;
+
+namespace framework_tests
+{
+
+class test_sharded_unordered_map : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+	}
+
+	void TearDown() override
+	{
+	}
+};
+
+TEST_F(test_sharded_unordered_map, InsertFindErase)
+{
+	concurrent::sharded_unordered_map<std::string, int> map(8);
+	ASSERT_EQ(map.shard_count(), 8);
+	ASSERT_TRUE(map.empty());
+
+	ASSERT_TRUE(map.insert("first", 1));
+	ASSERT_FALSE(map.insert("first", 2));
+	ASSERT_TRUE(map.emplace("second", 2));
+	ASSERT_FALSE(map.insert_or_assign("second", 3));
+	ASSERT_TRUE(map.insert_or_assign("third", 3));
+
+	ASSERT_EQ(map.find("first"), 1);
+	ASSERT_EQ(map.find("second"), 3);
+	ASSERT_EQ(map.find("missing"), std::nullopt);
+	ASSERT_TRUE(map.contains("third"));
+	ASSERT_EQ(map.size(), 3);
+
+	ASSERT_EQ(map.erase("first"), 1);
+	ASSERT_EQ(map.erase("first"), 0);
+	ASSERT_FALSE(map.contains("first"));
+
+	map.clear();
+	ASSERT_TRUE(map.empty());
+	ASSERT_THROW((concurrent::sharded_unordered_map<int, int>(0)), std::invalid_argument);
+}
+
+TEST_F(test_sharded_unordered_map, Visit)
+{
+	concurrent::sharded_unordered_map<int, std::vector<int>> map(4);
+	map.emplace(1, 2, 7);
+
+	ASSERT_TRUE(map.visit(1, [](std::vector<int>& value)
+		{
+			value.push_back(8);
+		}));
+	ASSERT_FALSE(map.visit(2, [](std::vector<int>&)
+		{
+			FAIL();
+		}));
+
+	const auto& constant = map;
+	size_t size = 0;
+	ASSERT_TRUE(constant.visit(1, [&size](const std::vector<int>& value)
+		{
+			size = value.size();
+		}));
+	ASSERT_EQ(size, 3);
+}
+
+TEST_F(test_sharded_unordered_map, VisitAllAndEraseIf)
+{
+	concurrent::sharded_unordered_map<int, int> map(16);
+	for (int i = 0; i < 1000; i++)
+		map.insert(i, i);
+
+	map.visit_all([](const int&, int& value)
+		{
+			value *= 2;
+		});
+
+	int sum = 0;
+	std::as_const(map).visit_all([&sum](const int&, const int& value)
+		{
+			sum += value;
+		});
+	ASSERT_EQ(sum, 999 * 1000);
+
+	ASSERT_EQ(map.erase_if([](const int& key, const int&)
+				  {
+					  return key % 2 == 0;
+				  }),
+		500);
+	ASSERT_EQ(map.size(), 500);
+}
+
+TEST_F(test_sharded_unordered_map, ShardsAreBalanced)
+{
+	// Sequential keys hashed by the identity hash of the standard library
+	concurrent::sharded_unordered_map<size_t, size_t> map(8);
+	std::vector<size_t> counts(map.shard_count());
+	for (size_t i = 0; i < 8000; i++)
+		counts[map.shard_index(i)]++;
+
+	for (auto count : counts)
+	{
+		ASSERT_GT(count, 500);
+		ASSERT_LT(count, 1500);
+	}
+
+	concurrent::sharded_unordered_map<size_t, size_t> single(1);
+	ASSERT_EQ(single.shard_index(12345), 0);
+}
+
+TEST_F(test_sharded_unordered_map, CallerLocations)
+{
+	concurrent::sharded_unordered_map<int, int, std::hash<int>, std::equal_to<int>, lock_tracking_profiled> map(2);
+
+	const auto insert_line = std::source_location::current().line() + 1;
+	map.insert(1, 1);
+	const auto emplace_line = std::source_location::current().line() + 1;
+	map.emplace(2, 2);
+	ASSERT_EQ(map.find(1), 1);
+	ASSERT_EQ(map.size(), 2);
+
+	// Shard locks are attributed to the callers of the map, not to its header
+	std::vector<uint_least32_t> lines;
+	for (const auto& profile : lock_contention_profiler::snapshot())
+	{
+		if (profile.ResourceType != typeid(std::unordered_map<int, int>))
+			continue;
+
+		for (const auto& site : profile.CallSites)
+		{
+			ASSERT_EQ(std::string(site.Location.file_name()), std::source_location::current().file_name());
+			lines.push_back(site.Location.line());
+		}
+	}
+
+	ASSERT_NE(std::ranges::find(lines, insert_line), lines.end());
+	ASSERT_NE(std::ranges::find(lines, emplace_line), lines.end());
+}
+
+TEST_F(test_sharded_unordered_map, ConcurrentMixedTraffic)
+{
+	constexpr int thread_count = 8;
+	constexpr int keys_per_thread = 2000;
+
+	concurrent::sharded_unordered_map<int, int> map;
+	std::atomic<int> missing = 0;
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < thread_count; t++)
+	{
+		threads.emplace_back([&, t]()
+			{
+				for (int i = 0; i < keys_per_thread; i++)
+				{
+					const int key = t * keys_per_thread + i;
+					map.insert(key, 0);
+					map.visit(key, [](int& value)
+						{
+							value++;
+						});
+
+					if (map.find(key) != 1)
+						missing++;
+
+					if (i % 2 == 1)
+						map.erase(key);
+				}
+			});
+	}
+
+	for (auto& thread : threads)
+		thread.join();
+
+	ASSERT_EQ(missing, 0);
+	ASSERT_EQ(map.size(), thread_count * keys_per_thread / 2);
+}
+
+} // namespace framework_tests
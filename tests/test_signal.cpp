@@ -1,11 +1,14 @@
 #include "synchronization/signal.h"
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <future>
 #include <gtest/gtest.h>
 #include <latch>
 #include <semaphore>
 #include <shared_mutex>
+#include <vector>
 
 using namespace janecekvit;
 using namespace std::string_literals;
@@ -420,4 +423,201 @@ TEST_F(test_signal, WaitUntilPredicate_Semaphore)
 	ASSERT_TRUE(s.wait_until(std::chrono::steady_clock::now()));
 }
 
+TEST_F(test_signal, SpinThenPark_Semaphore)
+{
+	constexpr int rounds = 1000;
+	synchronization::signal<std::binary_semaphore, false, synchronization::wait_policy::spin_then_park> ping({ .spins = 200, .yields = 5 });
+	synchronization::signal<std::binary_semaphore, false, synchronization::wait_policy::spin_then_park> pong;
+
+	auto task = AddTask([&]()
+		{
+			for (int i = 0; i < rounds; i++)
+			{
+				ping.wait();
+				pong.signalize();
+			}
+		});
+
+	for (int i = 0; i < rounds; i++)
+	{
+		ping.signalize();
+		pong.wait();
+	}
+
+	task.get();
+	ASSERT_FALSE(ping.is_signalized());
+	ASSERT_FALSE(pong.is_signalized());
+}
+
+TEST_F(test_signal, AdaptiveSpin_ConditionVariable)
+{
+	constexpr int rounds = 1000;
+	synchronization::signal<std::condition_variable_any, false, synchronization::wait_policy::adaptive_spin> ping;
+	synchronization::signal<std::condition_variable_any, false, synchronization::wait_policy::adaptive_spin> pong(synchronization::wait_policy::adaptive_spin(10us));
+	std::mutex pong_mutex;
+
+	auto task = AddTask([&]()
+		{
+			for (int i = 0; i < rounds; i++)
+			{
+				std::unique_lock<std::mutex> lock(m_conditionMtx);
+				ping.wait(lock);
+				pong.signalize();
+			}
+		});
+
+	for (int i = 0; i < rounds; i++)
+	{
+		ping.signalize();
+
+		std::unique_lock<std::mutex> lock(pong_mutex);
+		pong.wait(lock);
+		ASSERT_TRUE(lock.owns_lock());
+	}
+
+	task.get();
+	ASSERT_FALSE(pong.is_signalized());
+}
+
+TEST_F(test_signal, PersistentState_AtomicWait)
+{
+	synchronization::signal<std::atomic<uint64_t>> s;
+
+	s.signalize();
+	ASSERT_TRUE(s.is_signalized());
+	ASSERT_EQ(1, s.get_signal_version());
+
+	auto task = AddTask([&]()
+		{
+			s.wait();
+		});
+
+	task.get();
+	ASSERT_FALSE(s.is_signalized());
+	ASSERT_EQ(1, s.get_signal_version());
+}
+
+TEST_F(test_signal, AutoReset_AtomicWait)
+{
+	constexpr int rounds = 1000;
+	synchronization::signal<std::atomic<uint64_t>> ping;
+	synchronization::signal<std::atomic<uint64_t>> pong;
+
+	auto task = AddTask([&]()
+		{
+			for (int i = 0; i < rounds; i++)
+			{
+				ping.wait();
+				pong.signalize();
+			}
+		});
+
+	for (int i = 0; i < rounds; i++)
+	{
+		ping.signalize();
+		pong.wait();
+	}
+
+	task.get();
+	ASSERT_EQ(rounds, ping.get_signal_version());
+	ASSERT_FALSE(ping.is_signalized());
+}
+
+TEST_F(test_signal, SignalizeAll_AtomicWait)
+{
+	constexpr int waiters = 4;
+	synchronization::signal<std::atomic<uint64_t>> s;
+	std::atomic<int> woke_up_counter = 0;
+	std::latch started(waiters);
+
+	std::vector<std::future<void>> tasks;
+	for (int i = 0; i < waiters; i++)
+	{
+		tasks.emplace_back(AddTask([&]()
+			{
+				started.count_down();
+				s.wait();
+				woke_up_counter++;
+			}));
+	}
+
+	started.wait();
+	std::this_thread::sleep_for(10ms);
+	s.signalize_all();
+
+	for (auto& task : tasks)
+		task.get();
+
+	ASSERT_EQ(waiters, woke_up_counter.load());
+}
+
+TEST_F(test_signal, ManualReset_AtomicWait)
+{
+	synchronization::signal<std::atomic<uint64_t>, true> s;
+
+	s.signalize();
+	s.wait();
+	s.wait();
+	ASSERT_TRUE(s.is_signalized());
+
+	s.reset();
+	ASSERT_FALSE(s.is_signalized());
+	ASSERT_EQ(1, s.get_reset_version());
+	ASSERT_FALSE(s.wait_for(0ms));
+}
+
+TEST_F(test_signal, WaitFor_AtomicWait)
+{
+	synchronization::signal<std::atomic<uint64_t>, false, synchronization::wait_policy::spin_then_park> s;
+
+	ASSERT_FALSE(s.wait_for(5ms));
+	ASSERT_TRUE(s.wait_for(0ms, []()
+		{
+			return true;
+		}));
+
+	auto task = AddTask([&]()
+		{
+			std::this_thread::sleep_for(5ms);
+			s.signalize();
+		});
+
+	ASSERT_TRUE(s.wait_until(std::chrono::steady_clock::now() + 10s));
+	task.get();
+}
+
+
+TEST_F(test_signal, CacheAligned)
+{
+	using aligned_semaphore = synchronization::cache_aligned_signal<>;
+	using aligned_atomic = synchronization::cache_aligned_signal<std::atomic<uint64_t>>;
+	static_assert(alignof(aligned_semaphore) >= synchronization::cache_line_size);
+	static_assert(alignof(aligned_atomic) >= synchronization::cache_line_size);
+	static_assert(alignof(synchronization::signal<>) < synchronization::cache_line_size);
+
+	// Neighbouring elements of an array never share a cache line
+	std::array<aligned_atomic, 4> signals;
+	ASSERT_GE(reinterpret_cast<uintptr_t>(&signals[1]) - reinterpret_cast<uintptr_t>(&signals[0]), synchronization::cache_line_size);
+
+	std::vector<std::future<void>> tasks;
+	for (auto& s : signals)
+	{
+		tasks.emplace_back(AddTask([&s]()
+			{
+				s.wait();
+			}));
+	}
+
+	for (auto& s : signals)
+		s.signalize();
+
+	for (auto& task : tasks)
+		task.get();
+
+	aligned_semaphore semaphore;
+	semaphore.signalize();
+	ASSERT_TRUE(semaphore.wait_for(0ms));
+	ASSERT_EQ(1, semaphore.get_signal_version());
+}
+
 } // namespace framework_tests
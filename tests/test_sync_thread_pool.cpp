@@ -1,9 +1,14 @@
 #include "thread/sync_thread_pool.h"
 
+#include <array>
+#include <functional>
 #include <future>
 #include <gtest/gtest.h>
 #include <iostream>
+#include <memory>
+#include <ranges>
 #include <string>
+#include <vector>
 
 using namespace janecekvit::thread;
 
@@ -36,7 +41,7 @@ TEST_F(test_sync_thread_pool, Size)
 	std::promise<void> promise;
 	auto future = promise.get_future().share();
 
-	sync_thread_pool pool(thread_size);
+	sync_thread_pool pool(1);
 	pool.add_task(std::packaged_task<void()>([future]
 		{
 			future.wait();
@@ -149,6 +154,448 @@ TEST_F(test_sync_thread_pool, AddMutipleTasks)
 		result.wait();
 	ASSERT_EQ(counter, task_count);
 }
+TEST_F(test_sync_thread_pool, AddTasks)
+{
+	constexpr int task_count = 1000;
+	std::atomic<int> counter = 0;
+	{
+		sync_thread_pool pool(thread_size);
+		std::vector<std::function<void()>> tasks(task_count, [&counter]()
+			{
+				counter++;
+			});
+
+		pool.add_tasks(tasks);
+		ASSERT_EQ(tasks.size(), task_count);
+	}
+	ASSERT_EQ(counter, task_count);
+}
+
+TEST_F(test_sync_thread_pool, AddTasksEmpty)
+{
+	sync_thread_pool pool(thread_size);
+	pool.add_tasks(std::vector<std::function<void()>>{});
+	ASSERT_EQ(pool.size(), 0);
+	ASSERT_TRUE(pool.add_waitable_tasks(std::vector<std::function<int()>>{}).empty());
+}
+
+TEST_F(test_sync_thread_pool, AddWaitableTasks)
+{
+	constexpr int task_count = 1000;
+	sync_thread_pool pool(thread_size);
+
+	auto results = pool.add_waitable_tasks(std::views::iota(0, task_count) | std::views::transform([](int i)
+		{
+			return [i]()
+			{
+				return i * 2;
+			};
+		}));
+
+	ASSERT_EQ(results.size(), task_count);
+	for (int i = 0; i < task_count; i++)
+		ASSERT_EQ(results[i].get(), i * 2);
+}
+
+TEST_F(test_sync_thread_pool, AddWaitableTasksMoveOnly)
+{
+	sync_thread_pool pool(thread_size);
+	std::vector<std::packaged_task<int()>> tasks;
+	tasks.emplace_back([]()
+		{
+			return 5;
+		});
+	tasks.emplace_back([]() -> int
+		{
+			throw std::exception();
+		});
+
+	auto results = pool.add_waitable_tasks(std::move(tasks));
+	ASSERT_EQ(results[0].get(), 5);
+	ASSERT_THROW(results[1].get(), std::exception);
+}
+
+TEST_F(test_sync_thread_pool, TaskStoresSmallAndLargeCallables)
+{
+	int counter = 0;
+	std::array<int, 64> payload = {};
+	payload.fill(1);
+
+	sync_thread_pool::task small([&counter]()
+		{
+			counter++;
+		});
+
+	sync_thread_pool::task large([&counter, payload]()
+		{
+			counter += payload.back();
+		});
+
+	sync_thread_pool::task move_only([&counter, value = std::make_unique<int>(5)]()
+		{
+			counter += *value;
+		});
+
+	sync_thread_pool::task moved(std::move(small));
+	ASSERT_TRUE(moved);
+
+	small = std::move(large);
+	small();
+	moved();
+	move_only();
+	ASSERT_EQ(counter, 7);
+}
+
+TEST_F(test_sync_thread_pool, PriorityAndDeadlineOrder)
+{
+	std::promise<void> promise;
+	auto blocker = promise.get_future().share();
+	std::vector<int> order;
+
+	sync_thread_pool pool(1, 3);
+	ASSERT_EQ(pool.priority_levels(), 3);
+
+	std::atomic<bool> running = false;
+	auto started = pool.add_waitable_task([blocker, &running]()
+		{
+			running = true;
+			blocker.wait();
+		});
+
+	while (!running)
+		std::this_thread::yield();
+
+	auto record = [&order](int value)
+	{
+		return [&order, value]()
+		{
+			order.push_back(value);
+		};
+	};
+
+	const auto now = sync_thread_pool::clock::now();
+	pool.add_task(record(6));
+	pool.add_task({ .priority = 1 }, record(3));
+	pool.add_task({ .priority = 1, .deadline = now + std::chrono::seconds(2) }, record(2));
+	pool.add_task({ .priority = 1, .deadline = now + std::chrono::seconds(1) }, record(1));
+	pool.add_task({ .priority = 2 }, record(0));
+	pool.add_task({ .priority = 0, .deadline = now }, record(4));
+	pool.add_tasks({ .priority = 0 }, std::vector<std::function<void()>>{ record(7) });
+	auto last = pool.add_waitable_task({ .priority = 0, .deadline = now + std::chrono::seconds(1) }, record(5));
+
+	ASSERT_EQ(pool.size(2), 1);
+	ASSERT_EQ(pool.size(1), 3);
+	ASSERT_EQ(pool.size(0), 4);
+	ASSERT_THROW(std::ignore = pool.size(3), std::out_of_range);
+	ASSERT_THROW(pool.add_task({ .priority = 3 }, record(8)), std::out_of_range);
+
+	promise.set_value();
+	started.get();
+	last.get();
+	while (pool.size() > 0)
+		std::this_thread::yield();
+
+	pool.add_waitable_task([]()
+		{
+		}).get();
+	ASSERT_EQ(order, std::vector<int>({ 0, 1, 2, 3, 4, 5, 6, 7 }));
+}
+
+TEST_F(test_sync_thread_pool, PooledTaskWithPriority)
+{
+	sync_thread_pool pool(thread_size, 2);
+	auto future = pool.add_pooled_task({ .priority = 1 }, []()
+		{
+			return 5;
+		});
+
+	ASSERT_EQ(future.get(), 5);
+}
+TEST_F(test_sync_thread_pool, Resize)
+{
+	constexpr int task_count = 200;
+	std::atomic<int> counter = 0;
+
+	sync_thread_pool pool(2);
+	ASSERT_FALSE(pool.is_elastic());
+
+	pool.resize(thread_size);
+	ASSERT_EQ(pool.pool_size(), thread_size);
+
+	for (int i = 0; i < task_count; i++)
+	{
+		pool.add_task([&counter]()
+			{
+				counter++;
+			});
+	}
+
+	pool.resize(2);
+	ASSERT_EQ(pool.pool_size(), 2);
+
+	ASSERT_EQ(pool.add_waitable_task([&pool]()
+						  {
+							  // The calling worker is kept, the other one is stopped
+							  pool.resize(1);
+							  return pool.pool_size();
+						  })
+				  .get(),
+		1);
+
+	// The fixed pool without workers would never run its queued tasks
+	ASSERT_THROW(pool.resize(0), std::invalid_argument);
+	ASSERT_EQ(pool.pool_size(), 1);
+
+	pool.resize(2);
+	pool.add_waitable_task([]()
+		{
+		}).get();
+
+	while (counter < task_count)
+		std::this_thread::yield();
+
+	ASSERT_EQ(counter, task_count);
+}
+
+TEST_F(test_sync_thread_pool, ElasticInvalidOptions)
+{
+	ASSERT_THROW(sync_thread_pool({ .min_workers = 2, .max_workers = 1 }), std::invalid_argument);
+	ASSERT_THROW(sync_thread_pool({ .min_workers = 0, .max_workers = 0 }), std::invalid_argument);
+}
+
+TEST_F(test_sync_thread_pool, ElasticResize)
+{
+	sync_thread_pool pool({ .min_workers = 2, .max_workers = 4, .idle_timeout = std::chrono::seconds(30) });
+
+	// The size is clamped to the limits, so the pool never stays without workers
+	pool.resize(0);
+	ASSERT_EQ(pool.pool_size(), 2);
+
+	auto result = pool.add_waitable_task([]()
+		{
+			return 5;
+		});
+	ASSERT_EQ(result.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+	ASSERT_EQ(result.get(), 5);
+
+	pool.resize(10);
+	ASSERT_EQ(pool.pool_size(), 4);
+
+	pool.resize(3);
+	ASSERT_EQ(pool.pool_size(), 3);
+}
+
+TEST_F(test_sync_thread_pool, ElasticConstruction)
+{
+	// Workers time out while the constructor still spawns the others
+	for (int i = 0; i < 20; i++)
+	{
+		sync_thread_pool pool({ .min_workers = 4, .max_workers = 8, .idle_timeout = std::chrono::microseconds(1) });
+		ASSERT_EQ(pool.add_waitable_task([]()
+							  {
+								  return 1;
+							  })
+					  .get(),
+			1);
+	}
+}
+
+TEST_F(test_sync_thread_pool, ElasticGrowsAndRetires)
+{
+	std::promise<void> promise;
+	auto blocker = promise.get_future().share();
+
+	sync_thread_pool pool({ .min_workers = 1, .max_workers = 3, .latency_threshold = std::chrono::milliseconds(0), .idle_timeout = std::chrono::milliseconds(20) });
+	ASSERT_TRUE(pool.is_elastic());
+	ASSERT_EQ(pool.pool_size(), 1);
+
+	std::atomic<int> running = 0;
+	std::vector<std::future<void>> results;
+	for (int i = 0; i < 6; i++)
+	{
+		results.emplace_back(pool.add_waitable_task([blocker, &running]()
+			{
+				running++;
+				blocker.wait();
+			}));
+
+		// Saturate the workers so that the next submission finds no idle worker
+		while (running < std::min<int>(i + 1, static_cast<int>(pool.pool_size())))
+			std::this_thread::yield();
+	}
+
+	ASSERT_GT(pool.pool_size(), 1);
+	ASSERT_LE(pool.pool_size(), 3);
+
+	promise.set_value();
+	for (auto& result : results)
+		result.get();
+
+	while (pool.pool_size() > 1)
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+	ASSERT_EQ(pool.pool_size(), 1);
+	ASSERT_EQ(pool.add_pooled_task([]()
+					  {
+						  return 5;
+					  })
+				  .get(),
+		5);
+}
+
+TEST_F(test_sync_thread_pool, ElasticLatencyThreshold)
+{
+	sync_thread_pool pool({ .min_workers = 1, .max_workers = 4, .latency_threshold = std::chrono::milliseconds(50), .idle_timeout = std::chrono::seconds(30) });
+
+	// The queued task waits shorter than the threshold, so the pool does not grow
+	auto first = pool.add_waitable_task([]()
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		});
+	auto second = pool.add_waitable_task([]()
+		{
+		});
+
+	first.get();
+	second.get();
+	ASSERT_EQ(pool.pool_size(), 1);
+
+	// One burst and no submission afterwards, the busy workers grow the pool once the oldest task waits longer than the threshold
+	std::atomic<size_t> max_size = 1;
+	std::vector<std::function<void()>> burst(40, [&pool, &max_size]()
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			const auto size = pool.pool_size();
+			auto current = max_size.load();
+			while (size > current && !max_size.compare_exchange_weak(current, size))
+			{
+			}
+		});
+
+	for (auto& result : pool.add_waitable_tasks(burst))
+		result.get();
+
+	ASSERT_GT(max_size.load(), 1);
+	ASSERT_LE(max_size.load(), 4);
+}
+
+TEST_F(test_sync_thread_pool, NodeSubQueues)
+{
+	const auto cpu = worker_placement::all_cpus().front();
+	std::promise<void> promise;
+	auto blocker = promise.get_future().share();
+
+	// Worker 0 serves node 0, worker 1 serves node 1
+	sync_thread_pool pool(2, worker_placement({ { { cpu }, { cpu } } }));
+	ASSERT_EQ(pool.node_count(), 2);
+	ASSERT_THROW(pool.add_task({ .node = 2 }, []()
+					 {
+					 }),
+		std::out_of_range);
+
+	std::atomic<bool> running = false;
+	auto blocked = pool.add_waitable_task({ .node = 0 }, [blocker, &running]()
+		{
+			running = true;
+			blocker.wait();
+		});
+
+	while (!running)
+		std::this_thread::yield();
+
+	auto pending = pool.add_waitable_task({ .node = 0 }, []()
+		{
+			return 0;
+		});
+
+	ASSERT_EQ(pool.add_waitable_task({ .node = 1 }, []()
+						  {
+							  return 1;
+						  })
+				  .get(),
+		1);
+
+	// Node 0 tasks are not taken by the worker of node 1
+	ASSERT_EQ(pending.wait_for(std::chrono::milliseconds(20)), std::future_status::timeout);
+	ASSERT_EQ(pool.size(), 1);
+
+	promise.set_value();
+	blocked.get();
+	ASSERT_EQ(pending.get(), 0);
+}
+
+TEST_F(test_sync_thread_pool, NodeSubQueueWithoutWorkers)
+{
+	const auto cpu = worker_placement::all_cpus().front();
+
+	// Only node 0 has a worker, tasks of node 1 are served by it
+	sync_thread_pool pool(1, worker_placement({ { { cpu }, { cpu } } }));
+	ASSERT_EQ(pool.add_pooled_task({ .node = 1 }, []()
+					  {
+						  return 5;
+					  })
+				  .get(),
+		5);
+}
+
+TEST_F(test_sync_thread_pool, NodeIdentifiers)
+{
+	const auto cpu = worker_placement::all_cpus().front();
+
+	// Tasks address the nodes by their identifiers, e.g. NUMA nodes of a restricted cpuset
+	sync_thread_pool pool(2, worker_placement({ { { cpu }, { cpu } }, { 3, 1 } }));
+	ASSERT_EQ(pool.node_count(), 2);
+	ASSERT_THROW(pool.add_task({ .node = 0 }, []()
+					 {
+					 }),
+		std::out_of_range);
+
+	ASSERT_EQ(pool.add_waitable_task({ .node = 3 }, []()
+						  {
+							  return 3;
+						  })
+				  .get(),
+		3);
+	ASSERT_EQ(pool.add_waitable_task({ .node = 1 }, []()
+						  {
+							  return 1;
+						  })
+				  .get(),
+		1);
+	ASSERT_EQ(pool.pinning_failures(), 0);
+}
+
+TEST_F(test_sync_thread_pool, PlacedPoolsConstruction)
+{
+	// Workers start serving the node sub-queues while the constructor still spawns the others
+	for (int i = 0; i < 20; i++)
+	{
+		sync_thread_pool pool(8, worker_placement::cores());
+		pool.add_task({ .node = 0 }, []()
+			{
+			});
+
+		ASSERT_EQ(pool.add_waitable_task([]()
+							  {
+								  return 1;
+							  })
+					  .get(),
+			1);
+	}
+}
+
+#if defined(HAS_PTHREAD_AFFINITY)
+TEST_F(test_sync_thread_pool, NodeCannotBePinned)
+{
+	// The CPU is representable, but the process is not allowed to run on it
+	const auto cpus = worker_placement::all_cpus();
+	if (cpus.back() == CPU_SETSIZE - 1)
+		GTEST_SKIP();
+
+	ASSERT_THROW(sync_thread_pool(1, worker_placement({ { { CPU_SETSIZE - 1 } } })), std::invalid_argument);
+}
+#endif
+
 } // namespace framework_tests
 
 #endif // defined(HAS_JTHREAD)
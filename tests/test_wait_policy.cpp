@@ -0,0 +1,87 @@
+#include "synchronization/wait_policy.h"
+
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+using namespace janecekvit;
+using namespace std::chrono_literals;
+
+namespace framework_tests
+{
+
+class test_wait_policy : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+	}
+
+	void TearDown() override
+	{
+	}
+};
+
+TEST_F(test_wait_policy, Park)
+{
+	synchronization::wait_policy::park policy;
+	ASSERT_FALSE(policy.spin([]()
+		{
+			return true;
+		}));
+}
+
+TEST_F(test_wait_policy, SpinThenPark)
+{
+	synchronization::wait_policy::spin_then_park policy{ .spins = 10, .yields = 2 };
+
+	int polls = 0;
+	ASSERT_FALSE(policy.spin([&polls]()
+		{
+			polls++;
+			return false;
+		}));
+	ASSERT_EQ(polls, 12);
+
+	polls = 0;
+	ASSERT_TRUE(policy.spin([&polls]()
+		{
+			return ++polls == 5;
+		}));
+	ASSERT_EQ(polls, 5);
+}
+
+TEST_F(test_wait_policy, AdaptiveSpinShrinksOnLongWaits)
+{
+	synchronization::wait_policy::adaptive_spin policy(20us);
+	ASSERT_LE(policy.spin_budget(), 20us);
+
+	for (int i = 0; i < 50; i++)
+	{
+		ASSERT_FALSE(policy.spin([]()
+			{
+				return false;
+			}));
+	}
+
+	// Waits longer than the maximum budget leave only a short probe
+	ASSERT_LT(policy.spin_budget(), 20us / 4);
+}
+
+TEST_F(test_wait_policy, AdaptiveSpinFollowsShortWaits)
+{
+	synchronization::wait_policy::adaptive_spin policy(20us);
+	for (int i = 0; i < 50; i++)
+	{
+		ASSERT_TRUE(policy.spin([]()
+			{
+				return true;
+			}));
+	}
+
+	ASSERT_LT(policy.spin_budget(), 20us);
+	ASSERT_THROW(synchronization::wait_policy::adaptive_spin(0ns), std::invalid_argument);
+}
+
+} // namespace framework_tests
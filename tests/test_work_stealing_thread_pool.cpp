@@ -0,0 +1,187 @@
+#include "thread/work_stealing_thread_pool.h"
+
+#include <future>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace janecekvit::thread;
+
+#if defined(HAS_JTHREAD)
+
+namespace framework_tests
+{
+constexpr const size_t thread_size = 4;
+
+class test_work_stealing_thread_pool : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+	}
+
+	void TearDown() override
+	{
+	}
+};
+
+TEST_F(test_work_stealing_thread_pool, PoolSize)
+{
+	work_stealing_thread_pool pool(thread_size);
+	ASSERT_EQ(pool.pool_size(), thread_size);
+}
+
+TEST_F(test_work_stealing_thread_pool, ZeroSize)
+{
+	ASSERT_THROW(work_stealing_thread_pool(0), std::invalid_argument);
+}
+
+TEST_F(test_work_stealing_thread_pool, Size)
+{
+	std::promise<void> promise;
+	auto future = promise.get_future().share();
+
+	work_stealing_thread_pool pool(1);
+	pool.add_task([future]
+		{
+			future.wait();
+		});
+
+	pool.add_task([future]
+		{
+			future.wait();
+		});
+
+	ASSERT_TRUE(pool.size() > 0); // could be 1 or more, because thread can already get the task from the queue
+
+	promise.set_value();
+}
+
+TEST_F(test_work_stealing_thread_pool, AddTask)
+{
+	std::atomic<int> counter = 0;
+	{
+		work_stealing_thread_pool pool(thread_size);
+
+		std::packaged_task<void()> task([&counter]()
+			{
+				counter++;
+			});
+
+		pool.add_task(std::move(task));
+	}
+	ASSERT_EQ(counter, 1);
+}
+
+TEST_F(test_work_stealing_thread_pool, AddWaitableTaskWithResultLambda)
+{
+	work_stealing_thread_pool pool(thread_size);
+	auto result = pool.add_waitable_task([]()
+		{
+			return 5;
+		});
+	ASSERT_EQ(result.get(), 5);
+}
+
+TEST_F(test_work_stealing_thread_pool, AddWaitableTaskException)
+{
+	work_stealing_thread_pool pool(thread_size);
+	std::packaged_task<void()> task([]()
+		{
+			throw std::exception();
+		});
+
+	auto result = pool.add_waitable_task(std::move(task));
+	ASSERT_THROW(result.get(), std::exception);
+}
+
+TEST_F(test_work_stealing_thread_pool, DrainOnDestruction)
+{
+	constexpr int task_count = 1000;
+	std::atomic<int> counter = 0;
+	{
+		work_stealing_thread_pool pool(thread_size);
+		for (size_t i = 0; i < task_count; i++)
+		{
+			pool.add_task([&]()
+				{
+					counter++;
+				});
+		}
+	}
+	ASSERT_EQ(counter, task_count);
+}
+
+TEST_F(test_work_stealing_thread_pool, NestedTasksRunOnSubmittingWorker)
+{
+	work_stealing_thread_pool pool(1);
+	auto result = pool.add_waitable_task([&pool]()
+		{
+			const auto outer = std::this_thread::get_id();
+			auto inner = pool.add_waitable_task([]()
+				{
+					return std::this_thread::get_id();
+				});
+
+			return std::make_pair(outer, std::move(inner));
+		});
+
+	auto [outer, inner] = result.get();
+	ASSERT_EQ(inner.get(), outer);
+}
+
+TEST_F(test_work_stealing_thread_pool, IdleWorkersStealBlockedWorkerTasks)
+{
+	constexpr int task_count = 100;
+	std::promise<void> promise;
+	auto blocker = promise.get_future().share();
+	std::atomic<int> counter = 0;
+
+	work_stealing_thread_pool pool(thread_size);
+
+	// Block one worker and fill its local deque from inside the worker, the others have to steal the tasks
+	auto producer = pool.add_waitable_task([&]()
+		{
+			for (int i = 0; i < task_count; i++)
+			{
+				pool.add_task([&counter]()
+					{
+						counter++;
+					});
+			}
+
+			blocker.wait();
+		});
+
+	while (counter < task_count)
+		std::this_thread::yield();
+
+	promise.set_value();
+	producer.get();
+	ASSERT_EQ(counter, task_count);
+}
+
+TEST_F(test_work_stealing_thread_pool, AddMutipleTasks)
+{
+	constexpr int task_count = 1000;
+	std::atomic<int> counter = 0;
+
+	work_stealing_thread_pool pool(thread_size);
+	std::list<std::future<void>> results;
+
+	for (size_t i = 0; i < task_count; i++)
+	{
+		results.emplace_back(pool.add_waitable_task(([&]()
+			{
+				counter++;
+			})));
+	}
+
+	for (auto& result : results)
+		result.wait();
+	ASSERT_EQ(counter, task_count);
+}
+} // namespace framework_tests
+
+#endif // defined(HAS_JTHREAD)
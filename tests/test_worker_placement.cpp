@@ -0,0 +1,68 @@
+#include "thread/worker_placement.h"
+
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace janecekvit::thread;
+
+namespace framework_tests
+{
+
+class test_worker_placement : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+	}
+
+	void TearDown() override
+	{
+	}
+};
+
+TEST_F(test_worker_placement, ParseCpuList)
+{
+	ASSERT_EQ(details::parse_cpu_list("0-3,8,10-11\n"), std::vector<size_t>({ 0, 1, 2, 3, 8, 10, 11 }));
+	ASSERT_EQ(details::parse_cpu_list("5"), std::vector<size_t>({ 5 }));
+	ASSERT_TRUE(details::parse_cpu_list("").empty());
+	ASSERT_THROW(details::parse_cpu_list("3-1"), std::invalid_argument);
+	ASSERT_THROW(details::parse_cpu_list("a,1"), std::invalid_argument);
+}
+
+TEST_F(test_worker_placement, NumaNodes)
+{
+	const auto placement = worker_placement::numa_nodes();
+	ASSERT_FALSE(placement.nodes.empty());
+	ASSERT_NO_THROW(placement.validate());
+
+	// Nodes keep the NUMA node ids of the system
+	ASSERT_TRUE(placement.node_ids.empty() || placement.node_ids.size() == placement.nodes.size());
+	for (size_t i = 0; i + 1 < placement.node_ids.size(); i++)
+		ASSERT_LT(placement.node_id(i), placement.node_id(i + 1));
+}
+
+TEST_F(test_worker_placement, Cores)
+{
+	const auto cpus = worker_placement::all_cpus();
+	ASSERT_FALSE(cpus.empty());
+
+	const auto placement = worker_placement::cores();
+	ASSERT_EQ(placement.nodes.size(), cpus.size());
+	ASSERT_EQ(placement.nodes.front(), std::vector<size_t>({ cpus.front() }));
+}
+
+TEST_F(test_worker_placement, Validate)
+{
+	ASSERT_THROW(worker_placement().validate(), std::invalid_argument);
+	ASSERT_THROW(worker_placement({ { { 0 }, {} } }).validate(), std::invalid_argument);
+	ASSERT_NO_THROW(worker_placement({ { { 0 }, { 0 } } }).validate());
+	ASSERT_NO_THROW(worker_placement({ { { 0 }, { 0 } }, { 4, 1 } }).validate());
+	ASSERT_THROW(worker_placement({ { { 0 }, { 0 } }, { 1 } }).validate(), std::invalid_argument);
+	ASSERT_THROW(worker_placement({ { { 0 }, { 0 } }, { 1, 1 } }).validate(), std::invalid_argument);
+}
+
+TEST_F(test_worker_placement, SetCurrentThreadAffinity)
+{
+	ASSERT_TRUE(details::set_current_thread_affinity(worker_placement::all_cpus()));
+}
+} // namespace framework_tests